@@ -0,0 +1,114 @@
+#include <batch.h>
+#include <threadpool.h>
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <exception>
+
+namespace {
+	/// records one task handles without splitting further, also the largest group passed to a group handler
+	const size_t grain = 16;
+
+	bool read_record(std::istream & input, bool blocks, std::string & record) {
+		record.clear();
+		std::string line;
+		while (std::getline(input, line)) {
+			if (line.find_first_not_of(" \t\r") == std::string::npos) {
+				if (!record.empty()) return true;
+				continue;
+			}
+			record += line;
+			record += '\n';
+			if (!blocks) return true;
+		}
+		return !record.empty();
+	}
+
+	/// some messages carry their own line break, error line must stay one line
+	std::string one_line(const char * message) {
+		std::string s(message);
+		while (!s.empty() && s.back() == '\n') s.pop_back();
+		return s;
+	}
+
+	/// splits the range in halves, keeps working on the lower one and leaves the upper one to be stolen
+	void process_range(thread_pool::group & tasks, const std::vector<std::string> & records, std::vector<std::string> & outputs,
+			std::vector<std::string> & errors, const Shamir::group_handler & handler, size_t begin, size_t end) {
+		while (end - begin > grain) {
+			const size_t middle = begin + (end - begin) / 2;
+			tasks.run([&tasks, &records, &outputs, &errors, &handler, middle, end] {
+				process_range(tasks, records, outputs, errors, handler, middle, end);
+			});
+			end = middle;
+		}
+		std::string message;
+		for (size_t i = begin; i < end; ++i) errors[i].clear();
+		try {
+			handler(records.data() + begin, end - begin, outputs.data() + begin, errors.data() + begin);
+		} catch (const char * s) {
+			message = one_line(s);
+		} catch (const std::exception & e) {
+			message = one_line(e.what());
+		}
+		for (size_t i = begin; i < end; ++i) {
+			if (!message.empty()) errors[i] = message;
+			else if (!errors[i].empty()) errors[i] = one_line(errors[i].c_str());
+		}
+	}
+}
+
+namespace Shamir {
+	group_handler each_record(const record_handler & handler) {
+		return [handler] (const std::string * records, size_t count, std::string * outputs, std::string * errors) {
+			for (size_t i = 0; i < count; ++i) {
+				try {
+					outputs[i] = handler(records[i]);
+				} catch (const char * s) {
+					errors[i] = s;
+				} catch (const std::exception & e) {
+					errors[i] = e.what();
+				}
+			}
+		};
+	}
+
+	batch_stats run_batch(std::istream & input, std::ostream & output, bool blocks, const std::string & separator,
+			const record_handler & handler, thread_pool & pool, size_t window, size_t skipped) {
+		return run_batch(input, output, blocks, separator, each_record(handler), pool, window, skipped);
+	}
+
+	batch_stats run_batch(std::istream & input, std::ostream & output, bool blocks, const std::string & separator,
+			const group_handler & handler, thread_pool & pool, size_t window, size_t skipped) {
+		auto start = std::chrono::steady_clock::now();
+		const size_t steals = pool.steals();
+		batch_stats stats = batch_stats();
+		if (window == 0) window = 1;
+		std::vector<std::string> records(window);
+		std::vector<std::string> outputs(window), errors(window);
+		while (true) {
+			size_t count = 0;
+			while (count < window && read_record(input, blocks, records[count])) ++count;
+			if (count == 0) break;
+			{
+				thread_pool::group tasks(pool);
+				process_range(tasks, records, outputs, errors, handler, 0, count);
+				tasks.wait();
+			}
+			for (size_t i = 0; i < count; ++i) {
+				if (!errors[i].empty()) {
+					output << "error: record " << skipped + stats.records + i + 1 << ": " << errors[i] << "\n";
+					++stats.failed;
+				} else output << outputs[i];
+				output << separator;
+			}
+			stats.records += count;
+			if (count < window) break;
+		}
+		output.flush();
+		stats.steals = pool.steals() - steals;
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return stats;
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef BATCH
+#define BATCH
+
+#include <threadpool.h>
+
+#include <string>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include <cstddef>
+
+/**
+ * processing of many independent records in one run.
+ * Records are read in windows, every window is split over the thread pool and written
+ * out in input order, so output does not depend on number of threads.
+ */
+namespace Shamir {
+	struct batch_stats {
+		size_t records, failed, steals;
+		double seconds;
+	};
+	/// returns output of one record, throws const char * when record is invalid
+	typedef std::function<std::string(const std::string & record)> record_handler;
+	/**
+	 * handles 'count' consecutive records (at most 16) at once, so work of several records can go side by side,
+	 * e.g. their checksums hashed by SHA256Batch. Fills outputs[i] for record i, or errors[i] with the message
+	 * when record i is invalid; thrown const char * fails the whole group.
+	 */
+	typedef std::function<void(const std::string * records, size_t count, std::string * outputs, std::string * errors)> group_handler;
+	/// group handler calling 'handler' for every record of the group
+	group_handler each_record(const record_handler & handler);
+
+	/**
+	 * reads records from input: single non-empty lines, or when 'blocks' is set, groups of
+	 * non-empty lines ended by an empty line. Writes handler output followed by 'separator' for
+	 * every record; failed record is replaced by line "error: record <n>: <message>" (counting from 1,
+	 * after 'skipped' records of the input processed elsewhere).
+	 */
+	batch_stats run_batch(std::istream & input, std::ostream & output, bool blocks, const std::string & separator,
+			const record_handler & handler, thread_pool & pool, size_t window = 1 << 14, size_t skipped = 0);
+	batch_stats run_batch(std::istream & input, std::ostream & output, bool blocks, const std::string & separator,
+			const group_handler & handler, thread_pool & pool, size_t window = 1 << 14, size_t skipped = 0);
+}
+
+#endif
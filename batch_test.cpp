@@ -0,0 +1,181 @@
+#include <batch.h>
+#include <threadpool.h>
+#include <mnemonic.h>
+#include <shamirmulti.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+namespace {
+	const std::string mnemonic("legal winner thank year wave sausage worth useful legal winner thank yellow");
+
+	std::string distribute_record(const std::string & record) {
+		std::string output;
+		for (auto && line: Shamir::split_mnemonic(Shamir::split_words(record), 3, 5)) output += line + "\n";
+		return output;
+	}
+
+	/// uses only first three shares of the set
+	std::string merge_record(const std::string & record) {
+		std::istringstream lines(record);
+		std::string line;
+		std::vector<std::vector<uint8_t>> shares;
+		while (shares.size() < 3 && std::getline(lines, line)) shares.push_back(Shamir::slip39_to_share(Shamir::split_words(line)));
+		return Shamir::merge_mnemonic(shares) + "\n";
+	}
+
+	void distribute_records(const std::string * records, size_t count, std::string * outputs, std::string * errors) {
+		std::vector<std::vector<std::string>> phrases;
+		for (size_t i = 0; i < count; ++i) phrases.push_back(Shamir::split_words(records[i]));
+		auto results = Shamir::try_split_mnemonics(phrases, 3, 5);
+		for (size_t i = 0; i < count; ++i) {
+			if (!results[i]) errors[i] = Shamir::message(results[i].error());
+			else {
+				outputs[i].clear();
+				for (auto && line: results[i].value()) outputs[i] += line + "\n";
+			}
+		}
+	}
+
+	/// uses only first three shares of every set
+	void merge_records(const std::string * records, size_t count, std::string * outputs, std::string * errors) {
+		std::vector<std::vector<std::vector<uint8_t>>> sets(count);
+		for (size_t i = 0; i < count; ++i) {
+			std::istringstream lines(records[i]);
+			std::string line;
+			while (sets[i].size() < 3 && std::getline(lines, line)) {
+				auto share = Shamir::try_slip39_to_share(Shamir::split_words(line));
+				if (!share) {
+					errors[i] = Shamir::message(share.error());
+					break;
+				}
+				sets[i].push_back(share.value());
+			}
+		}
+		auto results = Shamir::try_merge_mnemonics(sets);
+		for (size_t i = 0; i < count; ++i) {
+			if (!errors[i].empty()) continue;
+			if (!results[i]) errors[i] = Shamir::message(results[i].error());
+			else outputs[i] = results[i].value() + "\n";
+		}
+	}
+}
+
+/// nested tasks are spread over all workers and every one of them runs exactly once
+void test_work_stealing() {
+	thread_pool pool(4);
+	std::atomic<int> done(0);
+	{
+		thread_pool::group outer(pool);
+		for (int i = 0; i < 8; ++i) outer.run([&pool, &done] {
+			thread_pool::group inner(pool);
+			for (int j = 0; j < 100; ++j) inner.run([&done] { ++done; });
+			inner.wait();
+		});
+		outer.wait();
+	}
+	assert(done == 800);
+	thread_pool::group failing(pool);
+	failing.run([] { throw "task failed"; });
+	bool thrown(false);
+	try {
+		failing.wait();
+	} catch (const char *) {
+		thrown = true;
+	}
+	assert(thrown);
+}
+
+/// records come out in input order whatever the window and thread count, bad records are reported in place
+void test_roundtrip(unsigned threads, size_t window) {
+	std::ostringstream input;
+	const size_t records = 300, bad = 123;
+	for (size_t i = 0; i < records; ++i) {
+		if (i == bad) input << "legal winner thank year wave sausage worth useful legal winner thank winner\n";
+		else input << mnemonic << "\n\n";
+	}
+	thread_pool pool(threads);
+	std::istringstream distribute_input(input.str());
+	std::ostringstream shares;
+	auto stats = Shamir::run_batch(distribute_input, shares, false, "\n", distribute_record, pool, window);
+	assert(stats.records == records);
+	assert(stats.failed == 1);
+
+	std::istringstream merge_input(shares.str());
+	std::ostringstream output;
+	stats = Shamir::run_batch(merge_input, output, true, "", merge_record, pool, window);
+	assert(stats.records == records);
+	assert(stats.failed == 1);
+	std::istringstream lines(output.str());
+	std::string line;
+	for (size_t i = 0; i < records; ++i) {
+		assert(std::getline(lines, line));
+		if (i == bad) assert(line == "error: record " + std::to_string(bad + 1) + ": Given word not in SLIP39 dictionary");
+		else assert(line == mnemonic);
+	}
+	assert(!std::getline(lines, line));
+}
+
+/// phrases split and merged a group at a time give the same records as one at a time, failures stay with their record
+void test_groups(unsigned threads, size_t window) {
+	const std::string longer("abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon agent");
+	std::ostringstream input;
+	const size_t records = 100, bad = 37;
+	for (size_t i = 0; i < records; ++i) {
+		if (i == bad) input << "legal winner thank year wave sausage worth useful legal winner thank winner\n";
+		else input << (i % 3 == 0 ? longer : mnemonic) << "\n";
+	}
+	thread_pool pool(threads);
+	std::istringstream distribute_input(input.str());
+	std::ostringstream shares;
+	auto stats = Shamir::run_batch(distribute_input, shares, false, "\n", distribute_records, pool, window);
+	assert(stats.records == records);
+	assert(stats.failed == 1);
+
+	std::istringstream merge_input(shares.str());
+	std::ostringstream output;
+	stats = Shamir::run_batch(merge_input, output, true, "", merge_records, pool, window);
+	assert(stats.records == records);
+	assert(stats.failed == 1);
+	std::istringstream lines(output.str());
+	std::string line;
+	for (size_t i = 0; i < records; ++i) {
+		assert(std::getline(lines, line));
+		if (i == bad) assert(line == "error: record " + std::to_string(bad + 1) + ": Given word not in SLIP39 dictionary");
+		else assert(line == (i % 3 == 0 ? longer : mnemonic));
+	}
+	assert(!std::getline(lines, line));
+
+	auto phrases = Shamir::try_split_mnemonics({Shamir::split_words(mnemonic), Shamir::split_words("legal winner thank year wave sausage worth useful legal winner thank winner")}, 2, 3);
+	assert(phrases[0] && phrases[0].value().size() == 3);
+	assert(phrases[1].error() == Shamir::status::bip39_checksum);
+	std::vector<std::vector<uint8_t>> set;
+	for (auto && phrase: phrases[0].value()) set.push_back(Shamir::slip39_to_share(Shamir::split_words(phrase)));
+	std::vector<std::vector<uint8_t>> damaged(set.begin(), set.begin() + 2);
+	damaged[1][5] ^= 1;
+	auto merged = Shamir::try_merge_mnemonics({set, damaged, {}, std::vector<std::vector<uint8_t>>(1, set[0])});
+	assert(merged[0].value() == mnemonic);
+	assert(merged[1].error() == Shamir::try_merge_mnemonic(damaged).error());
+	assert(merged[2].error() == Shamir::status::not_enough_shares);
+	assert(merged[3].error() == Shamir::try_merge_mnemonic(std::vector<std::vector<uint8_t>>(1, set[0])).error());
+	std::cout << "groups of " << threads << " threads, window " << window << ": passed" << std::endl;
+}
+
+int main() {
+	try {
+		test_work_stealing();
+		test_roundtrip(1, 1 << 14);
+		test_roundtrip(4, 7);
+		test_roundtrip(3, 64);
+		test_groups(1, 1 << 14);
+		test_groups(4, 7);
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
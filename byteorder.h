@@ -0,0 +1,20 @@
+#ifndef BYTEORDER_H
+#define BYTEORDER_H
+
+#include <cstdint>
+#include <cstring>
+#include <endian.h>
+
+/// unaligned big-endian 64 bit words, for code moving bit fields which are not byte aligned
+inline uint64_t load64be(const uint8_t * p) {
+	uint64_t x;
+	std::memcpy(&x, p, 8);
+	return be64toh(x);
+}
+
+inline void store64be(uint8_t * p, uint64_t x) {
+	x = htobe64(x);
+	std::memcpy(p, &x, 8);
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/**
+ * Instruction set extensions read from cpuid, shared by the units dispatching to kernels compiled for them.
+ * Vector extensions count only when xgetbv reports the OS saves their registers as well.
+ */
+namespace cpu_features {
+#if defined(__x86_64__) || defined(__i386__)
+	/// XCR0: bit 1 xmm, bit 2 ymm, bits 5 to 7 opmask and zmm registers saved by the OS
+	inline uint64_t enabled_states() {
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !((ecx >> 27) & 1)) return 0;
+		uint32_t lo, hi;
+		__asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		return (uint64_t(hi) << 32) | lo;
+	}
+
+	inline bool have_sse2() {
+		unsigned int eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && ((edx >> 26) & 1);
+	}
+
+	/// SHA extensions need SSSE3 and SSE4.1 for the shuffles around them as well
+	inline bool have_shani() {
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+		const bool sse41 = (ecx >> 19) & 1, ssse3 = (ecx >> 9) & 1;
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+		return sse41 && ssse3 && ((ebx >> 29) & 1);
+	}
+
+	inline bool have_avx2() {
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+		return ((ebx >> 5) & 1) && (enabled_states() & 0x6) == 0x6;
+	}
+
+	inline bool have_avx512() {
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+		return ((ebx >> 16) & 1) && (enabled_states() & 0xe6) == 0xe6;
+	}
+
+	/// general purpose registers only, no OS state involved
+	inline bool have_bmi2() {
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+		return (ebx >> 8) & 1;
+	}
+#endif
+}
+
+#endif
@@ -0,0 +1,470 @@
+#include <daemon.h>
+#include <shamirmulti.h>
+#include <mnemonic.h>
+#include <threadpool.h>
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace {
+	/// recent latencies kept for percentiles
+	const size_t latency_window = 4096;
+	/// requests one task handles
+	const size_t grain = 4;
+
+	void put_u32(std::vector<uint8_t> & out, uint32_t v) {
+		for (int i = 0; i < 4; ++i) out.push_back((uint8_t) (v >> (8 * i)));
+	}
+
+	uint32_t get_u32(const uint8_t * p) {
+		return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+	}
+
+	/// clients with more unsent output than this are not read from until they take some of it
+	const size_t output_backlog = 4 * daemon_protocol::max_frame;
+
+	void check_counts(unsigned threshold, unsigned count) {
+		if (threshold == 0) throw "threshold must be greater than zero";
+		if (count < threshold) throw "share threshold must be equal or greater than total share count";
+		if (count > 32) throw "share count must be at most 32";
+	}
+
+	bool write_all(int fd, const uint8_t * data, size_t length) {
+		while (length > 0) {
+			ssize_t ret = ::send(fd, data, length, MSG_NOSIGNAL);
+			if (ret < 0 && errno == EINTR) continue;
+			if (ret <= 0) return false;
+			data += ret;
+			length -= ret;
+		}
+		return true;
+	}
+
+	bool read_all(int fd, uint8_t * data, size_t length) {
+		while (length > 0) {
+			ssize_t ret = ::read(fd, data, length);
+			if (ret < 0 && errno == EINTR) continue;
+			if (ret <= 0) return false;
+			data += ret;
+			length -= ret;
+		}
+		return true;
+	}
+
+	sockaddr_un socket_address(const std::string & path) {
+		sockaddr_un addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(addr.sun_path)) throw "Socket path too long";
+		std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+		return addr;
+	}
+
+	void frame_header(uint8_t * out, uint8_t status, uint32_t tag, size_t payload_length) {
+		const uint32_t length = 1 + 4 + payload_length;
+		for (int i = 0; i < 4; ++i) {
+			out[i] = (uint8_t) (length >> (8 * i));
+			out[5 + i] = (uint8_t) (tag >> (8 * i));
+		}
+		out[4] = status;
+	}
+
+	std::vector<uint8_t> response(uint8_t status, uint32_t tag, const uint8_t * payload, size_t length) {
+		std::vector<uint8_t> out(daemon_protocol::header_size + length);
+		frame_header(out.data(), status, tag, length);
+		if (length > 0) std::memcpy(out.data() + daemon_protocol::header_size, payload, length);
+		return out;
+	}
+
+	std::vector<std::string> split_lines(const std::string & text) {
+		std::vector<std::string> lines;
+		std::istringstream ss(text);
+		std::string line;
+		while (std::getline(ss, line)) {
+			if (line.find_first_not_of(" \t\r") != std::string::npos) lines.push_back(line);
+		}
+		return lines;
+	}
+}
+
+/// connection stays open while the reader or any queued request refers to it
+struct share_daemon::client {
+	int fd;
+	std::vector<uint8_t> input;
+	std::mutex output_mutex; /// output is filled by the dispatcher and drained by the reader
+	std::vector<uint8_t> output;
+	size_t sent;
+	bool broken;
+	explicit client(int f) : fd(f), sent(0), broken(false) {}
+	~client() { close(fd); }
+
+	/// sends as much of the output as the socket takes without blocking, caller holds output_mutex
+	void flush() {
+		while (!broken && sent < output.size()) {
+			ssize_t ret = ::send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if (ret < 0 && errno == EINTR) continue;
+			if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+			if (ret <= 0) broken = true; /// client which went away just misses its responses
+			else sent += ret;
+		}
+		if (broken || sent == output.size()) {
+			output.clear();
+			sent = 0;
+		} else if (sent >= output.size() / 2) {
+			output.erase(output.begin(), output.begin() + sent);
+			sent = 0;
+		}
+	}
+
+	size_t pending() {
+		std::lock_guard<std::mutex> lock(output_mutex);
+		return output.size() - sent;
+	}
+};
+
+share_daemon::share_daemon(const std::string & socket_path, unsigned threads, size_t max_batch) :
+		m_listen(-1), m_path(socket_path), m_max_batch(max_batch == 0 ? 1 : max_batch), m_pool(threads),
+		m_latencies(latency_window, 0.0), m_latency_next(0), m_clients(0), m_requests(0), m_batches(0), m_errors(0), m_stop(false), m_stopping(false) {
+	sockaddr_un addr = socket_address(m_path);
+	if (pipe2(m_wake, O_CLOEXEC | O_NONBLOCK) != 0) throw "Cannot create daemon socket";
+	m_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (m_listen < 0) {
+		close(m_wake[0]);
+		close(m_wake[1]);
+		throw "Cannot create daemon socket";
+	}
+	/// stale socket of previous run is replaced, anything else at the path is left alone
+	struct stat existing;
+	const bool occupied = lstat(m_path.c_str(), &existing) == 0, foreign = occupied && !S_ISSOCK(existing.st_mode);
+	if (occupied && !foreign) unlink(m_path.c_str());
+	if (foreign || bind(m_listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || chmod(m_path.c_str(), 0600) != 0 || listen(m_listen, 128) != 0) {
+		close(m_listen);
+		close(m_wake[0]);
+		close(m_wake[1]);
+		throw "Cannot listen on daemon socket";
+	}
+	/// every record is split sequentially, batches are spread over the pool
+	Shamir::set_thread_count(1);
+	/// touch tables, word lists and allocator before the first client comes
+	std::vector<uint8_t> secret(32, 0x5a);
+	auto shares = Shamir::distribute(secret, 2, 3);
+	Shamir::merge_mnemonic(std::vector< std::vector<uint8_t> >(shares.begin(), shares.begin() + 2));
+}
+
+share_daemon::~share_daemon() {
+	close(m_listen);
+	close(m_wake[0]);
+	close(m_wake[1]);
+	unlink(m_path.c_str());
+}
+
+void share_daemon::stop() {
+	m_stopping = true;
+	const char c = 0;
+	ssize_t ret = write(m_wake[1], &c, 1);
+	(void) ret;
+}
+
+void share_daemon::run() {
+	std::thread dispatcher(&share_daemon::dispatch, this);
+	std::vector< std::shared_ptr<client> > clients;
+	std::vector<pollfd> fds;
+	while (true) {
+		fds.clear();
+		fds.push_back(pollfd{m_wake[0], POLLIN, 0});
+		fds.push_back(pollfd{m_listen, POLLIN, 0});
+		for (auto && c: clients) {
+			const size_t pending = c->pending();
+			fds.push_back(pollfd{c->fd, static_cast<short>((pending < output_backlog ? POLLIN : 0) | (pending > 0 ? POLLOUT : 0)), 0});
+		}
+		if (poll(fds.data(), fds.size(), -1) < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+		if (fds[0].revents) {
+			char drained[64];
+			while (read(m_wake[0], drained, sizeof(drained)) > 0) {}
+			if (m_stopping) break;
+		}
+		for (size_t i = fds.size() - 2; i-- > 0; ) {
+			const short revents = fds[i + 2].revents;
+			if (revents == 0) continue;
+			bool keep = true;
+			if (revents & (POLLOUT | POLLERR)) {
+				std::lock_guard<std::mutex> lock(clients[i]->output_mutex);
+				clients[i]->flush();
+				keep = !clients[i]->broken;
+			}
+			if (keep && (revents & (POLLIN | POLLHUP | POLLERR))) keep = read_requests(clients[i]);
+			if (!keep) clients.erase(clients.begin() + i);
+		}
+		if (fds[1].revents & POLLIN) {
+			int fd = accept4(m_listen, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+			if (fd >= 0) clients.push_back(std::make_shared<client>(fd));
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_clients = clients.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_ready.notify_all();
+	dispatcher.join();
+}
+
+/// reads whatever arrived and queues complete frames, false when connection is to be dropped
+bool share_daemon::read_requests(const std::shared_ptr<client> & c) {
+	uint8_t buffer[1 << 16];
+	ssize_t ret = read(c->fd, buffer, sizeof(buffer));
+	if (ret < 0 && (errno == EINTR || errno == EAGAIN)) return true;
+	if (ret <= 0) return false;
+	c->input.insert(c->input.end(), buffer, buffer + ret);
+	const auto now = std::chrono::steady_clock::now();
+	std::vector<request> complete;
+	size_t offset = 0;
+	while (c->input.size() - offset >= 4) {
+		const uint32_t length = get_u32(c->input.data() + offset);
+		if (length < daemon_protocol::header_size - 4 || length > daemon_protocol::max_frame) return false;
+		if (c->input.size() - offset - 4 < length) break;
+		const uint8_t * body = c->input.data() + offset + 4;
+		complete.push_back(request{c, std::vector<uint8_t>(body, body + length), now});
+		offset += 4 + length;
+	}
+	c->input.erase(c->input.begin(), c->input.begin() + offset);
+	if (complete.empty()) return true;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto && r: complete) m_queue.push_back(std::move(r));
+	}
+	m_ready.notify_one();
+	return true;
+}
+
+std::vector<uint8_t> share_daemon::handle(const std::vector<uint8_t> & body) {
+	const uint8_t op = body[0];
+	const uint32_t tag = get_u32(body.data() + 1);
+	const uint8_t * args = body.data() + 5;
+	const size_t length = body.size() - 5;
+	try {
+		switch (op) {
+			case daemon_protocol::distribute: {
+				if (length < 3) throw "secret must not be empty";
+				const unsigned threshold = args[0], count = args[1];
+				check_counts(threshold, count);
+				const size_t share_length = Shamir::share_size(length - 2);
+				std::vector<uint8_t> out(daemon_protocol::header_size + count * share_length);
+				std::vector<uint8_t *> outputs;
+				for (unsigned i = 0; i < count; ++i) outputs.push_back(out.data() + daemon_protocol::header_size + i * share_length);
+				/// shares are framed straight into the response
+				Shamir::distribute(args + 2, length - 2, threshold, outputs);
+				frame_header(out.data(), daemon_protocol::ok, tag, count * share_length);
+				return out;
+			}
+			case daemon_protocol::reconstruct: {
+				if (length < 1 || args[0] == 0 || (length - 1) % args[0] != 0) throw "invalid share packet";
+				const size_t share_length = (length - 1) / args[0];
+				std::vector<const uint8_t *> shares;
+				for (unsigned i = 0; i < args[0]; ++i) shares.push_back(args + 1 + i * share_length);
+				auto secret = Shamir::reconstruct(shares, share_length);
+				return response(daemon_protocol::ok, tag, secret.data(), secret.size());
+			}
+			case daemon_protocol::distribute_mnemonic: {
+				if (length < 2) throw "Problem with reading BIP mnemonic";
+				check_counts(args[0], args[1]);
+				std::string words(reinterpret_cast<const char *>(args + 2), length - 2), out;
+				for (auto && line: Shamir::split_mnemonic(Shamir::normalize_mnemonic(Shamir::word_list::bip39, Shamir::split_words(words)), args[0], args[1])) out += line + "\n";
+				return response(daemon_protocol::ok, tag, reinterpret_cast<const uint8_t *>(out.data()), out.size());
+			}
+			case daemon_protocol::merge_mnemonic: {
+				std::vector< std::vector<uint8_t> > shares;
+				for (auto && line: split_lines(std::string(reinterpret_cast<const char *>(args), length))) {
+					shares.push_back(Shamir::slip39_to_share(Shamir::normalize_mnemonic(Shamir::word_list::slip39, Shamir::split_words(line))));
+				}
+				std::string out(Shamir::merge_mnemonic(shares));
+				return response(daemon_protocol::ok, tag, reinterpret_cast<const uint8_t *>(out.data()), out.size());
+			}
+			case daemon_protocol::stats: {
+				daemon_stats s = stats();
+				std::ostringstream out;
+				out << "queue_depth " << s.queue_depth << "\nclients " << s.clients << "\nrequests " << s.requests
+					<< "\nbatches " << s.batches << "\nerrors " << s.errors << "\nmean_batch " << s.mean_batch
+					<< "\np50_us " << s.p50_us << "\np99_us " << s.p99_us << "\nmax_us " << s.max_us << "\n";
+				const std::string text(out.str());
+				return response(daemon_protocol::ok, tag, reinterpret_cast<const uint8_t *>(text.data()), text.size());
+			}
+			default:
+				throw "Unsupported request";
+		}
+	} catch (const char * s) {
+		return response(daemon_protocol::error, tag, reinterpret_cast<const uint8_t *>(s), std::strlen(s));
+	} catch (const std::exception & e) {
+		return response(daemon_protocol::error, tag, reinterpret_cast<const uint8_t *>(e.what()), std::strlen(e.what()));
+	}
+}
+
+void share_daemon::dispatch() {
+	std::vector<request> batch;
+	std::vector< std::vector<uint8_t> > responses;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_ready.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+		if (m_stop) return;
+		/// everything that arrived while previous batch was being processed goes together
+		const size_t count = std::min(m_queue.size(), m_max_batch);
+		batch.clear();
+		std::move(m_queue.begin(), m_queue.begin() + count, std::back_inserter(batch));
+		m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+		lock.unlock();
+
+		responses.assign(count, std::vector<uint8_t>());
+		m_pool.parallel_for(0, count, grain, [&] (size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) responses[i] = handle(batch[i].body);
+		});
+		size_t errors = 0;
+		bool backlog(false);
+		std::vector<double> latencies(count);
+		for (size_t i = 0; i < count; ++i) {
+			if (responses[i][4] != daemon_protocol::ok) ++errors;
+			client & c = *batch[i].from;
+			{
+				std::lock_guard<std::mutex> output(c.output_mutex);
+				if (!c.broken) {
+					c.output.insert(c.output.end(), responses[i].begin(), responses[i].end());
+					c.flush();
+					backlog = backlog || c.sent < c.output.size();
+				}
+			}
+			latencies[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - batch[i].received).count();
+		}
+		if (backlog) {
+			/// reader polls for writability of the clients left with output
+			const char c = 1;
+			ssize_t ret = write(m_wake[1], &c, 1);
+			(void) ret;
+		}
+		batch.clear(); /// drop references to connections before waiting again
+
+		lock.lock();
+		for (auto && l: latencies) {
+			m_latencies[m_latency_next % latency_window] = l;
+			++m_latency_next;
+		}
+		m_requests += count;
+		m_errors += errors;
+		++m_batches;
+	}
+}
+
+daemon_stats share_daemon::stats() {
+	daemon_stats s;
+	std::vector<double> recent;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		s.queue_depth = m_queue.size();
+		s.clients = m_clients;
+		s.requests = m_requests;
+		s.batches = m_batches;
+		s.errors = m_errors;
+		recent.assign(m_latencies.begin(), m_latencies.begin() + std::min(m_latency_next, latency_window));
+	}
+	s.mean_batch = s.batches ? (double) s.requests / s.batches : 0.0;
+	s.p50_us = s.p99_us = s.max_us = 0.0;
+	if (!recent.empty()) {
+		std::sort(recent.begin(), recent.end());
+		s.p50_us = recent[recent.size() / 2];
+		s.p99_us = recent[std::min(recent.size() - 1, recent.size() * 99 / 100)];
+		s.max_us = recent.back();
+	}
+	return s;
+}
+
+daemon_client::daemon_client(const std::string & socket_path) : m_fd(-1), m_tag(0) {
+	sockaddr_un addr = socket_address(socket_path);
+	m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (m_fd < 0) throw "Cannot connect to daemon";
+	if (connect(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+		close(m_fd);
+		throw "Cannot connect to daemon";
+	}
+}
+
+daemon_client::~daemon_client() {
+	close(m_fd);
+}
+
+std::vector<uint8_t> daemon_client::call(daemon_protocol::opcode op, const std::vector<uint8_t> & arguments) {
+	std::vector<uint8_t> frame;
+	frame.reserve(daemon_protocol::header_size + arguments.size());
+	put_u32(frame, 1 + 4 + arguments.size());
+	frame.push_back(op);
+	put_u32(frame, ++m_tag);
+	frame.insert(frame.end(), arguments.begin(), arguments.end());
+	if (!write_all(m_fd, frame.data(), frame.size())) throw "Connection to daemon lost";
+	uint8_t header[daemon_protocol::header_size];
+	if (!read_all(m_fd, header, sizeof(header))) throw "Connection to daemon lost";
+	const uint32_t length = get_u32(header);
+	if (length < 5 || length > (1u << 30) || get_u32(header + 5) != m_tag) throw "Invalid response from daemon";
+	std::vector<uint8_t> payload(length - 5);
+	if (!read_all(m_fd, payload.data(), payload.size())) throw "Connection to daemon lost";
+	if (header[4] != daemon_protocol::ok) {
+		m_error.assign(payload.begin(), payload.end());
+		throw m_error.c_str();
+	}
+	return payload;
+}
+
+std::vector< std::vector<uint8_t> > daemon_client::distribute(const uint8_t * secret, size_t length, unsigned threshold, unsigned count) {
+	if (threshold > 255 || count > 255) throw "share threshold must be equal or greater than total share count";
+	std::vector<uint8_t> arguments{(uint8_t) threshold, (uint8_t) count};
+	arguments.insert(arguments.end(), secret, secret + length);
+	auto payload = call(daemon_protocol::distribute, arguments);
+	const size_t share_length = Shamir::share_size(length);
+	if (payload.size() != share_length * count) throw "Invalid response from daemon";
+	std::vector< std::vector<uint8_t> > shares;
+	for (unsigned i = 0; i < count; ++i) shares.push_back(std::vector<uint8_t>(payload.begin() + i * share_length, payload.begin() + (i + 1) * share_length));
+	return shares;
+}
+
+std::vector<uint8_t> daemon_client::reconstruct(const std::vector< std::vector<uint8_t> > & shares) {
+	if (shares.empty()) throw "Not enough shares supplied";
+	if (shares.size() > 255) throw "invalid share packet";
+	std::vector<uint8_t> arguments{(uint8_t) shares.size()};
+	for (auto && s: shares) {
+		if (s.size() != shares[0].size()) throw "Shares do not have same length";
+		arguments.insert(arguments.end(), s.begin(), s.end());
+	}
+	return call(daemon_protocol::reconstruct, arguments);
+}
+
+std::vector<std::string> daemon_client::distribute_mnemonic(const std::string & mnemonic, unsigned threshold, unsigned count) {
+	if (threshold > 255 || count > 255) throw "share threshold must be equal or greater than total share count";
+	std::vector<uint8_t> arguments{(uint8_t) threshold, (uint8_t) count};
+	arguments.insert(arguments.end(), mnemonic.begin(), mnemonic.end());
+	auto payload = call(daemon_protocol::distribute_mnemonic, arguments);
+	return split_lines(std::string(payload.begin(), payload.end()));
+}
+
+std::string daemon_client::merge_mnemonic(const std::vector<std::string> & shares) {
+	std::string text;
+	for (auto && s: shares) text += s + "\n";
+	auto payload = call(daemon_protocol::merge_mnemonic, std::vector<uint8_t>(text.begin(), text.end()));
+	return std::string(payload.begin(), payload.end());
+}
+
+std::string daemon_client::stats() {
+	auto payload = call(daemon_protocol::stats, std::vector<uint8_t>());
+	return std::string(payload.begin(), payload.end());
+}
@@ -0,0 +1,105 @@
+#ifndef DAEMON
+#define DAEMON
+
+#include <threadpool.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * request protocol of the share daemon, all integers little endian.
+ * Request frame:  u32 body length, u8 opcode, u32 tag, arguments
+ * Response frame: u32 body length, u8 status, u32 tag of the request, payload (error message when status is error)
+ * Responses on one connection come in order of the requests, tag only helps clients pipelining them.
+ */
+namespace daemon_protocol {
+	enum opcode : uint8_t {
+		distribute = 'D',          // u8 threshold, u8 count, secret -> count shares of share_size(secret length) bytes
+		reconstruct = 'R',         // u8 share count, shares of equal length -> secret
+		distribute_mnemonic = 'd', // u8 threshold, u8 count, BIP39 words -> SLIP39 share lines separated by '\n'
+		merge_mnemonic = 'm',      // SLIP39 share lines separated by '\n' -> BIP39 words
+		stats = 'S'                // -> "name value" lines
+	};
+	enum status : uint8_t { ok = 0, error = 1 };
+	const size_t header_size = 4 + 1 + 4;
+	const size_t max_frame = 1 << 20; // longer frames close the connection
+}
+
+/// latencies count from the request being read to its response being queued for the client, in microseconds, over recent requests
+struct daemon_stats {
+	size_t queue_depth, clients;
+	uint64_t requests, batches, errors;
+	double mean_batch, p50_us, p99_us, max_us;
+};
+
+/**
+ * long-running service splitting and merging secrets for local clients.
+ * One thread reads requests from all connections of the Unix socket, dispatcher takes every
+ * request queued meanwhile (at most 'max_batch') as one batch, spreads it over the thread pool
+ * and queues the responses. Sockets are non-blocking, responses a client does not take right away
+ * stay in its output buffer, drained by the reading thread when the socket becomes writable, so a
+ * client which stops reading delays nobody else; its further requests are not read until it catches up.
+ * Tables and word lists stay initialized for the whole run.
+ */
+class share_daemon {
+	private:
+		struct client;
+		struct request {
+			std::shared_ptr<client> from;
+			std::vector<uint8_t> body;
+			std::chrono::steady_clock::time_point received;
+		};
+		int m_listen, m_wake[2];
+		std::string m_path;
+		size_t m_max_batch;
+		thread_pool m_pool;
+		std::deque<request> m_queue;
+		std::vector<double> m_latencies; // ring of recent latencies
+		size_t m_latency_next, m_clients;
+		uint64_t m_requests, m_batches, m_errors;
+		bool m_stop;
+		std::atomic<bool> m_stopping; // set by stop(), m_wake also signals output waiting to be drained
+		std::mutex m_mutex;
+		std::condition_variable m_ready;
+
+		bool read_requests(const std::shared_ptr<client> & c);
+		void dispatch();
+		std::vector<uint8_t> handle(const std::vector<uint8_t> & body);
+	public:
+		share_daemon(const std::string & socket_path, unsigned threads = 0, size_t max_batch = 1024);
+		share_daemon(const share_daemon &) = delete;
+		share_daemon & operator = (const share_daemon &) = delete;
+		~share_daemon(); // removes the socket
+		void run(); // serves until stop() is called
+		void stop(); // async signal safe
+		daemon_stats stats();
+};
+
+/// blocking client of share_daemon, error messages of the daemon are thrown and stay valid until next call
+class daemon_client {
+	private:
+		int m_fd;
+		uint32_t m_tag;
+		std::string m_error;
+		std::vector<uint8_t> call(daemon_protocol::opcode op, const std::vector<uint8_t> & arguments);
+	public:
+		explicit daemon_client(const std::string & socket_path);
+		daemon_client(const daemon_client &) = delete;
+		daemon_client & operator = (const daemon_client &) = delete;
+		~daemon_client();
+		std::vector< std::vector<uint8_t> > distribute(const uint8_t * secret, size_t length, unsigned threshold, unsigned count);
+		std::vector<uint8_t> reconstruct(const std::vector< std::vector<uint8_t> > & shares);
+		std::vector<std::string> distribute_mnemonic(const std::string & mnemonic, unsigned threshold, unsigned count);
+		std::string merge_mnemonic(const std::vector<std::string> & shares);
+		std::string stats();
+};
+
+#endif
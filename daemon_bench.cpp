@@ -0,0 +1,52 @@
+#include <daemon.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+/**
+ * measures latency of splitting 256 bit secret through the daemon.
+ * Usage: daemon_bench [clients] [requests per client] [daemon threads]
+ */
+int main(int argc, const char * argv[]) {
+	const unsigned clients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+	const unsigned requests = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+	const unsigned threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+	const std::string path("/tmp/daemon_bench." + std::to_string(getpid()) + ".sock");
+	try {
+		share_daemon daemon(path, threads);
+		std::thread server(&share_daemon::run, &daemon);
+		std::vector< std::vector<double> > latencies(clients);
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> workers;
+		for (unsigned c = 0; c < clients; ++c) workers.push_back(std::thread([&, c] {
+			daemon_client client(path);
+			std::vector<uint8_t> secret(32, (uint8_t) c);
+			for (unsigned r = 0; r < requests; ++r) {
+				auto t = std::chrono::steady_clock::now();
+				client.distribute(secret.data(), secret.size(), 3, 5);
+				latencies[c].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count());
+			}
+		}));
+		for (auto && w: workers) w.join();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::vector<double> all;
+		for (auto && l: latencies) all.insert(all.end(), l.begin(), l.end());
+		std::sort(all.begin(), all.end());
+		auto s = daemon.stats();
+		daemon.stop();
+		server.join();
+		std::cout << std::fixed << std::setprecision(1) << all.size() / elapsed.count() << " requests/s, client p50 " << all[all.size() / 2]
+			<< " us, p99 " << all[all.size() * 99 / 100] << " us, max " << all.back() << " us, mean batch " << s.mean_batch << std::endl;
+	} catch (const char * s) {
+		std::cerr << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include <daemon.h>
+#include <mnemonic.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+	const std::string mnemonic("legal winner thank year wave sausage worth useful legal winner thank yellow");
+}
+
+/// requests of one client, binary and mnemonic, including failing ones
+void test_requests(const std::string & path) {
+	daemon_client client(path);
+	std::vector<uint8_t> secret(32);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 7 + 3);
+	auto shares = client.distribute(secret.data(), secret.size(), 3, 5);
+	assert(shares.size() == 5);
+	assert(shares[0].size() == 38);
+	assert(client.reconstruct(std::vector< std::vector<uint8_t> >{shares[4], shares[0], shares[2]}) == secret);
+
+	bool thrown(false);
+	try {
+		client.reconstruct(std::vector< std::vector<uint8_t> >{shares[4], shares[0]});
+	} catch (const char * s) {
+		thrown = std::strcmp(s, "Not enough shares supplied") == 0;
+	}
+	assert(thrown);
+
+	auto lines = client.distribute_mnemonic(mnemonic, 2, 3);
+	assert(lines.size() == 3);
+	assert(client.merge_mnemonic(std::vector<std::string>{lines[2], lines[1]}) == mnemonic);
+	/// words cut to their first four letters stand for the whole ones, in secrets and in shares alike
+	std::vector<std::string> abbreviated;
+	for (auto && line: {std::string("lega winn than year wave saus wort usef lega winn than yell"), lines[0], lines[2]}) {
+		std::string cut;
+		for (auto && word: Shamir::split_words(line)) cut += (cut.empty() ? "" : " ") + word.substr(0, 4);
+		abbreviated.push_back(cut);
+	}
+	assert(client.merge_mnemonic(client.distribute_mnemonic(abbreviated[0], 2, 3)) == mnemonic);
+	assert(client.merge_mnemonic(std::vector<std::string>{abbreviated[1], abbreviated[2]}) == mnemonic);
+	thrown = false;
+	try {
+		client.distribute_mnemonic("legal winner", 2, 3);
+	} catch (const char *) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	/// share indices have 5 bits, so counts are checked before anything is split
+	const unsigned counts[][3] = {{2, 33, 0}, {0, 3, 1}, {4, 3, 2}};
+	const char * messages[] = {"share count must be at most 32", "threshold must be greater than zero", "share threshold must be equal or greater than total share count"};
+	for (auto && c: counts) {
+		thrown = false;
+		try {
+			client.distribute(secret.data(), secret.size(), c[0], c[1]);
+		} catch (const char * s) {
+			thrown = std::strcmp(s, messages[c[2]]) == 0;
+		}
+		assert(thrown);
+	}
+	assert(client.distribute(secret.data(), secret.size(), 32, 32).size() == 32);
+	std::cout << "daemon requests and errors: passed" << std::endl;
+}
+
+/// concurrent clients are served from shared batches, stats count all of them
+void test_concurrent(const std::string & path, share_daemon & daemon) {
+	const int clients = 8, requests = 200;
+	std::vector<std::thread> threads;
+	for (int c = 0; c < clients; ++c) threads.push_back(std::thread([&path, c] {
+		daemon_client client(path);
+		std::vector<uint8_t> secret(16, (uint8_t) c);
+		for (int r = 0; r < requests; ++r) {
+			secret[0] = (uint8_t) r;
+			auto shares = client.distribute(secret.data(), secret.size(), 2, 3);
+			assert(client.reconstruct(std::vector< std::vector<uint8_t> >{shares[1], shares[2]}) == secret);
+		}
+	}));
+	for (auto && t: threads) t.join();
+	auto s = daemon.stats();
+	assert(s.requests >= clients * requests * 2);
+	assert(s.batches <= s.requests);
+	assert(s.errors == 5);
+	assert(s.p99_us >= s.p50_us);
+	daemon_client client(path);
+	assert(client.stats().find("requests ") != std::string::npos);
+	std::cout << "concurrent daemon clients: passed" << std::endl;
+}
+
+/// client sending requests but never reading the responses does not hold up other clients
+void test_slow_reader(const std::string & path) {
+	const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+	assert(fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+	/// each response is 32 shares of the secret, far more than the socket buffers
+	const size_t secret_length = 60000;
+	std::vector<uint8_t> frame;
+	const uint32_t body = 1 + 4 + 2 + secret_length;
+	for (int i = 0; i < 4; ++i) frame.push_back((uint8_t) (body >> (8 * i)));
+	frame.push_back(daemon_protocol::distribute);
+	for (int i = 0; i < 4; ++i) frame.push_back(0);
+	frame.push_back(2);
+	frame.push_back(32);
+	frame.resize(frame.size() + secret_length, 0x33);
+	for (int r = 0; r < 8; ++r) assert(send(fd, frame.data(), frame.size(), MSG_NOSIGNAL) == (ssize_t) frame.size());
+	usleep(100000);
+	daemon_client client(path);
+	std::vector<uint8_t> secret(16, 0x44);
+	for (int r = 0; r < 50; ++r) {
+		auto shares = client.distribute(secret.data(), secret.size(), 2, 3);
+		assert(client.reconstruct(std::vector< std::vector<uint8_t> >{shares[0], shares[2]}) == secret);
+	}
+	close(fd);
+	std::cout << "client not reading its responses: passed" << std::endl;
+}
+
+/// a file which is not a socket is never removed to make place for the daemon
+void test_occupied_path(const std::string & path) {
+	const std::string file(path + ".file");
+	std::ofstream(file) << "keep";
+	try {
+		share_daemon daemon(file, 1, 1);
+		assert(false);
+	} catch (const char * s) {
+		assert(std::string(s) == "Cannot listen on daemon socket");
+	}
+	std::string content;
+	std::ifstream(file) >> content;
+	assert(content == "keep");
+	unlink(file.c_str());
+	std::cout << "existing file at socket path kept: passed" << std::endl;
+}
+
+int main() {
+	alarm(60); /// a stalled daemon fails the test instead of hanging it
+	const std::string path("/tmp/daemon_test." + std::to_string(getpid()) + ".sock");
+	try {
+		share_daemon daemon(path, 4, 64);
+		std::thread server(&share_daemon::run, &daemon);
+		test_requests(path);
+		test_concurrent(path, daemon);
+		test_slow_reader(path);
+		daemon.stop();
+		server.join();
+		test_occupied_path(path);
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	assert(access(path.c_str(), F_OK) != 0);
+	return 0;
+}
@@ -1,14 +1,235 @@
 #include <get_insecure_randomness.h>
-#include <chrono>
-#include <random>
+
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <sys/random.h>
+
+namespace {
+	const size_t lanes = 8; /// blocks computed together, a word of all lanes fills one AVX2 or two SSE2 registers
+
+	inline uint32_t load32(const uint8_t * p) {
+		return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+	}
+
+	inline void store32(uint8_t * p, uint32_t v) {
+		p[0] = static_cast<uint8_t>(v);
+		p[1] = static_cast<uint8_t>(v >> 8);
+		p[2] = static_cast<uint8_t>(v >> 16);
+		p[3] = static_cast<uint8_t>(v >> 24);
+	}
+
+	inline uint32_t rotl(uint32_t v, int n) {
+		return v << n | v >> (32 - n);
+	}
+
+	typedef uint32_t lane_state[16][lanes];
+
+	inline void quarter_round(lane_state & x, int a, int b, int c, int d) {
+		for (size_t l = 0; l < lanes; ++l) {
+			x[a][l] += x[b][l]; x[d][l] = rotl(x[d][l] ^ x[a][l], 16);
+			x[c][l] += x[d][l]; x[b][l] = rotl(x[b][l] ^ x[c][l], 12);
+			x[a][l] += x[b][l]; x[d][l] = rotl(x[d][l] ^ x[a][l], 8);
+			x[c][l] += x[d][l]; x[b][l] = rotl(x[b][l] ^ x[c][l], 7);
+		}
+	}
+
+	/// 'lanes' consecutive blocks starting at 'counter', words of all blocks are processed together
+	void chacha_lanes(const uint32_t * input, uint64_t counter, uint8_t * out) {
+		lane_state x;
+		for (int i = 0; i < 16; ++i) {
+			for (size_t l = 0; l < lanes; ++l) x[i][l] = input[i];
+		}
+		for (size_t l = 0; l < lanes; ++l) {
+			x[12][l] = static_cast<uint32_t>(counter + l);
+			x[13][l] = static_cast<uint32_t>((counter + l) >> 32);
+		}
+		for (int round = 0; round < 10; ++round) {
+			quarter_round(x, 0, 4, 8, 12);
+			quarter_round(x, 1, 5, 9, 13);
+			quarter_round(x, 2, 6, 10, 14);
+			quarter_round(x, 3, 7, 11, 15);
+			quarter_round(x, 0, 5, 10, 15);
+			quarter_round(x, 1, 6, 11, 12);
+			quarter_round(x, 2, 7, 8, 13);
+			quarter_round(x, 3, 4, 9, 14);
+		}
+		for (size_t l = 0; l < lanes; ++l) {
+			const uint64_t block = counter + l;
+			for (int i = 0; i < 16; ++i) {
+				uint32_t word = input[i];
+				if (i == 12) word = static_cast<uint32_t>(block);
+				if (i == 13) word = static_cast<uint32_t>(block >> 32);
+				store32(out + l * chacha20::block_size + 4 * i, x[i][l] + word);
+			}
+		}
+		std::memset(&x, 0, sizeof(x));
+	}
+
+	/// replaced only while nothing is being distributed, see set_random_source
+	std::atomic<const random_source *> default_source(nullptr);
+
+	/// bumped in forked children, so generators inherited from the parent get new keys
+	std::atomic<unsigned> fork_generation(0);
+
+	void after_fork() {
+		++fork_generation;
+	}
+
+	void system_random(uint8_t * out, size_t length) {
+		while (length > 0) {
+			const ssize_t r = getrandom(out, length, 0);
+			if (r < 0) {
+				if (errno == EINTR) continue;
+				throw "Cannot read system randomness";
+			}
+			out += r;
+			length -= r;
+		}
+	}
+
+	/// placeholder key of a generator not keyed yet, never used for output
+	const uint8_t unkeyed[32] = {};
+
+	class thread_generator {
+		private:
+			static const size_t buffer_size = 4096;
+			/// kept in place, the first draw of a thread must not allocate
+			chacha20 m_cipher;
+			bool m_keyed;
+			uint64_t m_counter;
+			unsigned m_generation;
+			uint8_t m_buffer[buffer_size];
+			size_t m_position;
+
+			void rekey() {
+				static pthread_once_t registered = PTHREAD_ONCE_INIT;
+				pthread_once(&registered, [] { pthread_atfork(nullptr, nullptr, after_fork); });
+				uint8_t seed[40];
+				system_random(seed, sizeof(seed));
+				m_cipher = chacha20(seed, seed + 32);
+				m_keyed = true;
+				std::memset(seed, 0, sizeof(seed));
+				m_counter = 0;
+				m_generation = fork_generation;
+				m_position = buffer_size;
+			}
+
+			/// whole blocks straight from the cipher, 'count' is a multiple of lanes except at the end
+			void generate(uint8_t * out, size_t count) {
+				m_cipher.blocks(m_counter, count, out);
+				m_counter += count;
+			}
+		public:
+			thread_generator() : m_cipher(unkeyed, unkeyed), m_keyed(false), m_counter(0), m_generation(0), m_position(buffer_size) {}
+			~thread_generator() {
+				std::memset(m_buffer, 0, sizeof(m_buffer));
+			}
+
+			void fill(uint8_t * out, size_t length) {
+				if (!m_keyed || m_generation != fork_generation) rekey();
+				while (length > 0) {
+					if (m_position == buffer_size) {
+						const size_t direct = length / buffer_size * buffer_size;
+						if (direct > 0) {
+							generate(out, direct / chacha20::block_size);
+							out += direct;
+							length -= direct;
+							continue;
+						}
+						generate(m_buffer, buffer_size / chacha20::block_size);
+						m_position = 0;
+					}
+					const size_t n = std::min(length, buffer_size - m_position);
+					std::memcpy(out, m_buffer + m_position, n);
+					/// handed out keystream does not stay around
+					std::memset(m_buffer + m_position, 0, n);
+					m_position += n;
+					out += n;
+					length -= n;
+				}
+			}
+	};
+}
+
+chacha20::chacha20(const uint8_t * key, const uint8_t * nonce) {
+	m_input[0] = 0x61707865;
+	m_input[1] = 0x3320646e;
+	m_input[2] = 0x79622d32;
+	m_input[3] = 0x6b206574;
+	for (int i = 0; i < 8; ++i) m_input[4 + i] = load32(key + 4 * i);
+	m_input[12] = 0;
+	m_input[13] = 0;
+	m_input[14] = load32(nonce);
+	m_input[15] = load32(nonce + 4);
+}
+
+chacha20::~chacha20() {
+	std::memset(m_input, 0, sizeof(m_input));
+}
+
+void chacha20::blocks(uint64_t counter, size_t count, uint8_t * out) const {
+	for (; count >= lanes; count -= lanes, counter += lanes, out += lanes * block_size) chacha_lanes(m_input, counter, out);
+	if (count > 0) {
+		uint8_t tail[lanes * block_size];
+		chacha_lanes(m_input, counter, tail);
+		std::memcpy(out, tail, count * block_size);
+		std::memset(tail, 0, sizeof(tail));
+	}
+}
+
+void chacha20::stream(uint64_t offset, uint8_t * out, size_t length) const {
+	uint8_t partial[block_size];
+	uint64_t counter = offset / block_size;
+	const size_t skip = offset % block_size;
+	if (skip > 0 && length > 0) {
+		blocks(counter++, 1, partial);
+		const size_t n = std::min(length, block_size - skip);
+		std::memcpy(out, partial + skip, n);
+		out += n;
+		length -= n;
+	}
+	blocks(counter, length / block_size, out);
+	counter += length / block_size;
+	out += length / block_size * block_size;
+	if (length % block_size > 0) {
+		blocks(counter, 1, partial);
+		std::memcpy(out, partial, length % block_size);
+	}
+	std::memset(partial, 0, sizeof(partial));
+}
 
 void pseudo_random_fill(std::vector<uint8_t> & chunk)
 {
-	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::default_random_engine generator(seed);
-	std::uniform_int_distribution<uint8_t> distribution(0, 255);
-	for (auto && i : chunk)
-	{
-		i = distribution(generator);
+	pseudo_random_fill(chunk.data(), chunk.size());
+}
+
+void pseudo_random_fill(uint8_t * chunk, size_t length)
+{
+	thread_local thread_generator generator;
+	generator.fill(chunk, length);
+}
+
+random_source seeded_random_source(uint64_t seed) {
+	uint8_t key[32] = {0}, nonce[8] = {'s', 'e', 'e', 'd', 'e', 'd', 0, 0};
+	for (int i = 0; i < 8; ++i) key[i] = static_cast<uint8_t>(seed >> (8 * i));
+	std::shared_ptr<chacha20> cipher(new chacha20(key, nonce));
+	return [cipher] (uint64_t offset, uint8_t * out, size_t length) { cipher->stream(offset, out, length); };
+}
+
+void set_random_source(const random_source & source) {
+	delete default_source.exchange(source ? new random_source(source) : nullptr);
+}
+
+void random_fill(const random_source & source, uint64_t offset, uint8_t * out, size_t length) {
+	if (source) {
+		source(offset, out, length);
+		return;
 	}
+	const random_source * fallback = default_source.load();
+	if (fallback != nullptr) (*fallback)(offset, out, length);
+	else pseudo_random_fill(out, length);
 }
@@ -2,10 +2,46 @@
 #define GET_INSECURE_RANDOMNESS
 
 #include <vector>
+#include <functional>
 #include <cstdint>
+#include <cstddef>
 
-void pseudo_random_fill(std::vector<uint8_t> & chunk);
+/**
+ * ChaCha20 keystream (64 bit block counter, 64 bit nonce). Blocks are addressed by their counter,
+ * so any range of the stream can be produced independently; several blocks are computed side by side
+ * in lanes the compiler vectorizes.
+ */
+class chacha20 {
+	private:
+		uint32_t m_input[16];
+	public:
+		static const size_t block_size = 64;
+		chacha20(const uint8_t * key, const uint8_t * nonce); // 32 bytes key, 8 bytes nonce
+		~chacha20(); // wipes key
+		void blocks(uint64_t counter, size_t count, uint8_t * out) const; // writes keystream blocks counter .. counter + count - 1
+		void stream(uint64_t offset, uint8_t * out, size_t length) const; // writes keystream bytes offset .. offset + length - 1
+};
 
+/**
+ * random coefficients for polynomials: ChaCha20 generator of the calling thread keyed once from getrandom,
+ * rekeyed in forked children. Small requests are served from a buffer of keystream, large ones are
+ * generated straight into 'chunk', so a whole coefficient matrix is best filled by a single call.
+ */
+void pseudo_random_fill(std::vector<uint8_t> & chunk);
+void pseudo_random_fill(uint8_t * chunk, size_t length);
 
+/**
+ * source of polynomial coefficients, fills 'length' bytes starting at byte 'offset' of its stream.
+ * Distribution asks for bytes column * threshold ... (column + 1) * threshold - 1 for coefficients
+ * of a column, so a source returning the same stream gives the same shares whatever the thread count
+ * or chunking. Empty source stands for the default one.
+ */
+typedef std::function<void(uint64_t offset, uint8_t * out, size_t length)> random_source;
+/// ChaCha20 stream keyed by 'seed', reproducible coefficients for benchmarks and differential tests, never for real secrets
+random_source seeded_random_source(uint64_t seed);
+/// replaces default source of the whole process, empty source restores pseudo_random_fill; not to be called while distributing
+void set_random_source(const random_source & source);
+/// fills from 'source' or from the default source if it is empty
+void random_fill(const random_source & source, uint64_t offset, uint8_t * out, size_t length);
 
 #endif
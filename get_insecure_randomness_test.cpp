@@ -0,0 +1,77 @@
+#include <get_insecure_randomness.h>
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <thread>
+#include <cassert>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/// RFC 8439 section 2.3.2 block, its 32 bit counter and first nonce word are our 64 bit counter
+void test_vector() {
+	uint8_t key[32], nonce[8] = {0, 0, 0, 0x4a, 0, 0, 0, 0};
+	for (int i = 0; i < 32; ++i) key[i] = i;
+	const uint8_t expected[64] = {
+		0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f, 0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4,
+		0xc7, 0xd1, 0xf4, 0xc7, 0x33, 0xc0, 0x68, 0x03, 0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4, 0x6c, 0x4e,
+		0xd2, 0x82, 0x64, 0x46, 0x07, 0x9f, 0xaa, 0x09, 0x14, 0xc2, 0xd7, 0x05, 0xd9, 0x8b, 0x02, 0xa2,
+		0xb5, 0x12, 0x9c, 0xd1, 0xde, 0x16, 0x4e, 0xb9, 0xcb, 0xd0, 0x83, 0xe8, 0xa2, 0x50, 0x3c, 0x4e};
+	chacha20 cipher(key, nonce);
+	const uint64_t counter = uint64_t(0x09000000) << 32 | 1;
+	uint8_t block[64];
+	cipher.blocks(counter, 1, block);
+	assert(std::memcmp(block, expected, 64) == 0);
+	/// block inside a batch of lanes is the same as computed alone
+	std::vector<uint8_t> run(13 * 64);
+	cipher.blocks(counter - 5, 13, run.data());
+	assert(std::memcmp(run.data() + 5 * 64, expected, 64) == 0);
+	std::cout << "ChaCha20 test vector: passed" << std::endl;
+}
+
+/// buffered and direct requests, threads and forked children all get different bytes
+void test_streams() {
+	std::set<std::vector<uint8_t>> seen;
+	for (size_t length: {1ul, 7ul, 64ul, 4000ul, 4096ul, 10000ul, 100000ul}) {
+		std::vector<uint8_t> chunk(length);
+		pseudo_random_fill(chunk);
+		if (length >= 64) assert(seen.insert(std::vector<uint8_t>(chunk.begin(), chunk.begin() + 64)).second);
+		if (length >= 4096) assert(std::count(chunk.begin(), chunk.end(), 0) < static_cast<long>(length / 64));
+	}
+	std::vector<std::vector<uint8_t>> from_threads(4, std::vector<uint8_t>(64));
+	std::vector<std::thread> threads;
+	for (auto && chunk: from_threads) threads.push_back(std::thread([&chunk] { pseudo_random_fill(chunk); }));
+	for (auto && t: threads) t.join();
+	for (auto && chunk: from_threads) assert(seen.insert(chunk).second);
+
+	int pipefd[2];
+	assert(pipe(pipefd) == 0);
+	const pid_t child = fork();
+	if (child == 0) {
+		std::vector<uint8_t> chunk(64);
+		pseudo_random_fill(chunk);
+		_exit(write(pipefd[1], chunk.data(), chunk.size()) == 64 ? 0 : 1);
+	}
+	std::vector<uint8_t> parent(64), forked(64);
+	pseudo_random_fill(parent);
+	assert(read(pipefd[0], forked.data(), forked.size()) == 64);
+	int status;
+	waitpid(child, &status, 0);
+	close(pipefd[0]);
+	close(pipefd[1]);
+	assert(parent != forked);
+	std::cout << "independent random streams: passed" << std::endl;
+}
+
+int main() {
+	try {
+		test_vector();
+		test_streams();
+	} catch (const char * s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,243 @@
+#include <libshamir.h>
+#include <multiblock.h>
+#include <wordlist.h>
+#include <sha256.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace {
+	const unsigned max_shares = 32;
+
+	bool valid_parameters(unsigned threshold, unsigned count) {
+		return threshold >= 1 && count >= 1 && threshold <= count && count <= max_shares;
+	}
+
+	int distribute_one(const uint8_t * secret, size_t length, unsigned threshold, unsigned count, uint8_t * shares) {
+		if (secret == nullptr || shares == nullptr || length == 0) return SHAMIR_ERROR_ARGUMENT;
+		if (!valid_parameters(threshold, count)) return SHAMIR_ERROR_ARGUMENT;
+		Shamir::distribute_packets(secret, length, threshold, count, shares, shamir_share_size(length));
+		return SHAMIR_OK;
+	}
+
+	int packet_error(Shamir::status status) {
+		switch (status) {
+			case Shamir::status::ok: return SHAMIR_OK;
+			case Shamir::status::invalid_share:
+			case Shamir::status::share_checksum: return SHAMIR_ERROR_SHARE;
+			case Shamir::status::different_lengths:
+			case Shamir::status::different_thresholds:
+			case Shamir::status::not_enough_shares:
+			case Shamir::status::duplicate_indices: return SHAMIR_ERROR_SHARE_SET;
+			case Shamir::status::secret_checksum: return SHAMIR_ERROR_CHECKSUM;
+			default: return SHAMIR_ERROR_ARGUMENT;
+		}
+	}
+
+	int reconstruct_one(const uint8_t * shares, size_t share_count, size_t share_length, uint8_t * secret) {
+		if (shares == nullptr || secret == nullptr || share_count == 0) return SHAMIR_ERROR_ARGUMENT;
+		return packet_error(Shamir::reconstruct_packets(shares, share_count, share_length, share_length, secret));
+	}
+
+	bool is_space(char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	/// calls consumer(value) for every word, SHAMIR_ERROR_WORD for unknown one
+	template <typename Consumer>
+	int for_each_word(int (*index)(const char *, size_t), const char * words, Consumer consumer) {
+		const char * p = words;
+		while (true) {
+			while (is_space(*p)) ++p;
+			if (*p == 0) return SHAMIR_OK;
+			const char * begin = p;
+			while (*p != 0 && !is_space(*p)) ++p;
+			const int value = index(begin, p - begin);
+			if (value < 0) return SHAMIR_ERROR_WORD;
+			consumer(static_cast<unsigned>(value));
+		}
+	}
+
+	void set_bit(uint8_t * data, size_t bit) {
+		data[bit / 8] |= static_cast<uint8_t>(0x80 >> (bit % 8));
+	}
+
+	bool get_bit(const uint8_t * data, size_t bit) {
+		return (data[bit / 8] >> (7 - bit % 8)) & 1;
+	}
+
+	/// writes words of 'bits' bits each, separated by single space and terminated by NUL
+	template <size_t N, typename Bits>
+	int write_words(const std::array<word_view, N> & dictionary, unsigned bits, size_t count, Bits bit, char * words, size_t capacity) {
+		size_t written = 0;
+		for (size_t w = 0; w < count; ++w) {
+			unsigned value = 0;
+			for (unsigned b = 0; b < bits; ++b) value = value << 1 | (bit(w * bits + b) ? 1 : 0);
+			const word_view & word = dictionary[value];
+			if (written + (w > 0) + word.size() + 1 > capacity) {
+				if (capacity > 0) words[0] = 0;
+				return SHAMIR_ERROR_BUFFER;
+			}
+			if (w > 0) words[written++] = ' ';
+			std::memcpy(words + written, word.data(), word.size());
+			written += word.size();
+		}
+		if (capacity == 0) return SHAMIR_ERROR_BUFFER;
+		words[written] = 0;
+		return SHAMIR_OK;
+	}
+}
+
+extern "C" {
+
+unsigned shamir_abi_version(void) {
+	return SHAMIR_ABI_VERSION;
+}
+
+const char * shamir_strerror(int status) {
+	switch (status) {
+		case SHAMIR_OK: return "Success";
+		case SHAMIR_ERROR_ARGUMENT: return "Invalid argument";
+		case SHAMIR_ERROR_BUFFER: return "Output buffer too small";
+		case SHAMIR_ERROR_SHARE: return "invalid share packet";
+		case SHAMIR_ERROR_SHARE_SET: return "Shares do not form a valid set";
+		case SHAMIR_ERROR_CHECKSUM: return "Secret message checksum verification failed. Message possibly corrupted.";
+		case SHAMIR_ERROR_WORD: return "Given word not in dictionary";
+		case SHAMIR_ERROR_MNEMONIC: return "Invalid mnemonic";
+	}
+	return "Unknown error";
+}
+
+size_t shamir_share_size(size_t secret_length) {
+	return secret_length + 6;
+}
+
+int shamir_distribute(const uint8_t * secret, size_t secret_length, unsigned threshold, unsigned count, uint8_t * shares) {
+	return distribute_one(secret, secret_length, threshold, count, shares);
+}
+
+int shamir_reconstruct(const uint8_t * shares, size_t share_count, size_t share_length, uint8_t * secret) {
+	return reconstruct_one(shares, share_count, share_length, secret);
+}
+
+int shamir_distribute_batch(const uint8_t * secrets, size_t batch, size_t secret_length, unsigned threshold, unsigned count,
+		uint8_t * shares, int * statuses) {
+	if (batch > 0 && (secrets == nullptr || shares == nullptr)) return SHAMIR_ERROR_ARGUMENT;
+	/// all secrets share parameters, so they are either all valid or all rejected
+	const int status = secret_length == 0 || !valid_parameters(threshold, count) ? SHAMIR_ERROR_ARGUMENT : SHAMIR_OK;
+	if (status == SHAMIR_OK) {
+		Shamir::distribute_packets_batch(secrets, batch, secret_length, threshold, count, shares, shamir_share_size(secret_length));
+	}
+	if (statuses != nullptr) std::fill(statuses, statuses + batch, status);
+	return batch > 0 ? status : SHAMIR_OK;
+}
+
+int shamir_reconstruct_batch(const uint8_t * shares, size_t batch, size_t share_count, size_t share_length,
+		uint8_t * secrets, int * statuses) {
+	if (batch > 0 && (shares == nullptr || secrets == nullptr)) return SHAMIR_ERROR_ARGUMENT;
+	if (share_length < 7) {
+		/// no record can be read, each of them fails the same way
+		if (statuses != nullptr) std::fill(statuses, statuses + batch, SHAMIR_ERROR_SHARE);
+		return SHAMIR_ERROR_SHARE;
+	}
+	if (share_count == 0) {
+		if (statuses != nullptr) std::fill(statuses, statuses + batch, SHAMIR_ERROR_ARGUMENT);
+		return batch > 0 ? SHAMIR_ERROR_ARGUMENT : SHAMIR_OK;
+	}
+	/// sets are reconstructed in chunks whose statuses fit on the stack
+	const size_t chunk = 256;
+	Shamir::status results[chunk];
+	int first = SHAMIR_OK;
+	for (size_t begin = 0; begin < batch; begin += chunk) {
+		const size_t n = std::min(chunk, batch - begin);
+		Shamir::reconstruct_packets_batch(shares + begin * share_count * share_length, n, share_count, share_length, share_length,
+				secrets + begin * (share_length - 6), results);
+		for (size_t b = 0; b < n; ++b) {
+			const int status = packet_error(results[b]);
+			if (statuses != nullptr) statuses[begin + b] = status;
+			if (first == SHAMIR_OK) first = status;
+		}
+	}
+	return first;
+}
+
+int shamir_bip39_decode(const char * words, uint8_t * entropy, size_t capacity, size_t * entropy_length) {
+	if (words == nullptr || entropy_length == nullptr || (entropy == nullptr && capacity > 0)) return SHAMIR_ERROR_ARGUMENT;
+	/// first pass counts and validates words, second one writes bits
+	size_t count = 0;
+	int status = for_each_word(Shamir::bip39_index, words, [&count] (unsigned) { ++count; });
+	if (status != SHAMIR_OK) return status;
+	if (count == 0 || count % 3 != 0 || count * 11 / 33 > 8 * CSHA256::OUTPUT_SIZE) return SHAMIR_ERROR_MNEMONIC;
+	const size_t length = count * 4 / 3, checksum_bits = count / 3;
+	if (length > capacity) return SHAMIR_ERROR_BUFFER;
+	std::memset(entropy, 0, length);
+	uint8_t checksum[CSHA256::OUTPUT_SIZE];
+	std::memset(checksum, 0, sizeof(checksum));
+	size_t bit = 0;
+	for_each_word(Shamir::bip39_index, words, [&] (unsigned value) {
+		for (int b = 10; b >= 0; --b, ++bit) {
+			if (((value >> b) & 1) == 0) continue;
+			if (bit < length * 8) set_bit(entropy, bit);
+			else set_bit(checksum, bit - length * 8);
+		}
+	});
+	uint8_t hash[CSHA256::OUTPUT_SIZE];
+	CSHA256 h;
+	h.Write(entropy, length);
+	h.Finalize(hash);
+	for (size_t b = 0; b < checksum_bits; ++b) {
+		if (get_bit(hash, b) != get_bit(checksum, b)) {
+			std::memset(entropy, 0, length);
+			return SHAMIR_ERROR_MNEMONIC;
+		}
+	}
+	*entropy_length = length;
+	return SHAMIR_OK;
+}
+
+int shamir_bip39_encode(const uint8_t * entropy, size_t entropy_length, char * words, size_t capacity) {
+	if (entropy == nullptr || words == nullptr) return SHAMIR_ERROR_ARGUMENT;
+	if (entropy_length == 0 || entropy_length % 4 != 0 || entropy_length / 4 > 8 * CSHA256::OUTPUT_SIZE) return SHAMIR_ERROR_ARGUMENT;
+	uint8_t hash[CSHA256::OUTPUT_SIZE];
+	CSHA256 h;
+	h.Write(entropy, entropy_length);
+	h.Finalize(hash);
+	const size_t entropy_bits = entropy_length * 8;
+	return write_words(bip_words, 11, (entropy_bits + entropy_length / 4) / 11, [&] (size_t bit) {
+		return bit < entropy_bits ? get_bit(entropy, bit) : get_bit(hash, bit - entropy_bits);
+	}, words, capacity);
+}
+
+int shamir_slip39_decode(const char * words, uint8_t * share, size_t capacity, size_t * share_length) {
+	if (words == nullptr || share_length == nullptr || (share == nullptr && capacity > 0)) return SHAMIR_ERROR_ARGUMENT;
+	size_t count = 0;
+	int status = for_each_word(Shamir::slip39_index, words, [&count] (unsigned) { ++count; });
+	if (status != SHAMIR_OK) return status;
+	if (count * 10 < 42 + 32) return SHAMIR_ERROR_MNEMONIC;
+	/// same rounding as the tool: secret of whole 32 bit blocks, words beyond the packet are padding
+	const size_t length = shamir_share_size(((count * 10 - 42) / 32) * 4);
+	if (length > capacity) return SHAMIR_ERROR_BUFFER;
+	std::memset(share, 0, length);
+	size_t bit = 0;
+	for_each_word(Shamir::slip39_index, words, [&] (unsigned value) {
+		for (int b = 9; b >= 0; --b, ++bit) {
+			if (bit < length * 8 && ((value >> b) & 1)) set_bit(share, bit);
+		}
+	});
+	*share_length = length;
+	return SHAMIR_OK;
+}
+
+int shamir_slip39_encode(const uint8_t * share, size_t share_length, char * words, size_t capacity) {
+	if (share == nullptr || words == nullptr || share_length < 7) return SHAMIR_ERROR_ARGUMENT;
+	const size_t bits = share_length * 8 - 6; /// trailing padding of the packet is not encoded
+	return write_words(slip_words, 10, (bits + 9) / 10, [&] (size_t bit) {
+		return bit < share_length * 8 && get_bit(share, bit);
+	}, words, capacity);
+}
+
+} // extern "C"
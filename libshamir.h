@@ -0,0 +1,73 @@
+#ifndef LIBSHAMIR
+#define LIBSHAMIR
+
+/**
+ * C interface of libshamir.so.
+ *
+ * Every function returns SHAMIR_OK or one of the error codes below, never throws and never
+ * allocates: all output goes to buffers owned by the caller. Functions are thread safe,
+ * batch functions process their records sequentially in the calling thread.
+ * Shares are binary packets of shamir_share_size(secret_length) bytes, as produced by the tool.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHAMIR_ABI_VERSION 1
+
+/* library is built with hidden visibility, only the functions below are exported */
+#if defined(__GNUC__)
+#define SHAMIR_API __attribute__((visibility("default")))
+#else
+#define SHAMIR_API
+#endif
+
+enum shamir_status {
+	SHAMIR_OK = 0,
+	SHAMIR_ERROR_ARGUMENT = 1,  /* null pointer, empty secret, threshold or count not in 1..32, threshold above count */
+	SHAMIR_ERROR_BUFFER = 2,    /* output buffer too small */
+	SHAMIR_ERROR_SHARE = 3,     /* share packet too short or its checksum does not match */
+	SHAMIR_ERROR_SHARE_SET = 4, /* shares differ in threshold, repeat index or there are fewer of them than threshold */
+	SHAMIR_ERROR_CHECKSUM = 5,  /* reconstructed secret does not match its checksum */
+	SHAMIR_ERROR_WORD = 6,      /* word not in dictionary */
+	SHAMIR_ERROR_MNEMONIC = 7   /* wrong number of words or BIP39 checksum mismatch */
+};
+
+/* SHAMIR_ABI_VERSION the library was built with */
+SHAMIR_API unsigned shamir_abi_version(void);
+/* static description of status code */
+SHAMIR_API const char * shamir_strerror(int status);
+SHAMIR_API size_t shamir_share_size(size_t secret_length);
+
+/* shares: count * shamir_share_size(secret_length) bytes, share with index i + 1 at offset i * shamir_share_size(secret_length) */
+SHAMIR_API int shamir_distribute(const uint8_t * secret, size_t secret_length, unsigned threshold, unsigned count, uint8_t * shares);
+/* shares: share_count packets of share_length bytes one after another; secret: share_length - 6 bytes */
+SHAMIR_API int shamir_reconstruct(const uint8_t * shares, size_t share_count, size_t share_length, uint8_t * secret);
+
+/*
+ * batch of secrets of equal length stored one after another, shares of secret b start at
+ * b * count * shamir_share_size(secret_length). statuses (may be NULL) receive status of every
+ * secret, return value is SHAMIR_OK or status of the first failed one; other secrets are processed anyway.
+ */
+SHAMIR_API int shamir_distribute_batch(const uint8_t * secrets, size_t batch, size_t secret_length, unsigned threshold, unsigned count,
+		uint8_t * shares, int * statuses);
+/* share set of secret b starts at b * share_count * share_length, secret b at b * (share_length - 6) */
+SHAMIR_API int shamir_reconstruct_batch(const uint8_t * shares, size_t batch, size_t share_count, size_t share_length,
+		uint8_t * secrets, int * statuses);
+
+/* words separated by white space; entropy_length receives number of bytes written */
+SHAMIR_API int shamir_bip39_decode(const char * words, uint8_t * entropy, size_t capacity, size_t * entropy_length);
+/* entropy length must be multiple of 4; words are separated by single space and terminated by NUL */
+SHAMIR_API int shamir_bip39_encode(const uint8_t * entropy, size_t entropy_length, char * words, size_t capacity);
+SHAMIR_API int shamir_slip39_decode(const char * words, uint8_t * share, size_t capacity, size_t * share_length);
+SHAMIR_API int shamir_slip39_encode(const uint8_t * share, size_t share_length, char * words, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
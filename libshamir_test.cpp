@@ -0,0 +1,162 @@
+#include <libshamir.h>
+#include <shamirmulti.h>
+#include <mnemonic.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace {
+	const std::string mnemonic("legal winner thank year wave sausage worth useful legal winner thank yellow");
+}
+
+/// shares of C interface are accepted by the tool and vice versa
+void test_compatibility() {
+	std::vector<uint8_t> secret(37);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 11 + 5);
+	const size_t share_length = shamir_share_size(secret.size());
+	assert(share_length == Shamir::share_size(secret.size()));
+
+	std::vector<uint8_t> shares(5 * share_length);
+	assert(shamir_distribute(secret.data(), secret.size(), 3, 5, shares.data()) == SHAMIR_OK);
+	std::vector<std::vector<uint8_t>> picked;
+	for (unsigned i: {4, 0, 2}) picked.emplace_back(shares.begin() + i * share_length, shares.begin() + (i + 1) * share_length);
+	assert(Shamir::reconstruct(picked) == secret);
+
+	auto tool_shares = Shamir::distribute(secret, 2, 4);
+	std::vector<uint8_t> flat;
+	flat.insert(flat.end(), tool_shares[3].begin(), tool_shares[3].end());
+	flat.insert(flat.end(), tool_shares[1].begin(), tool_shares[1].end());
+	std::vector<uint8_t> restored(secret.size());
+	assert(shamir_reconstruct(flat.data(), 2, share_length, restored.data()) == SHAMIR_OK);
+	assert(restored == secret);
+	std::cout << "C interface shares compatible with the tool: passed" << std::endl;
+}
+
+void test_errors() {
+	uint8_t secret[16] = {1, 2, 3};
+	std::vector<uint8_t> shares(4 * shamir_share_size(sizeof(secret)));
+	const size_t share_length = shamir_share_size(sizeof(secret));
+	assert(shamir_distribute(secret, sizeof(secret), 4, 3, shares.data()) == SHAMIR_ERROR_ARGUMENT);
+	assert(shamir_distribute(secret, sizeof(secret), 0, 3, shares.data()) == SHAMIR_ERROR_ARGUMENT);
+	assert(shamir_distribute(secret, 0, 1, 1, shares.data()) == SHAMIR_ERROR_ARGUMENT);
+	assert(shamir_distribute(secret, sizeof(secret), 3, 4, shares.data()) == SHAMIR_OK);
+
+	uint8_t restored[sizeof(secret)];
+	assert(shamir_reconstruct(shares.data(), 2, share_length, restored) == SHAMIR_ERROR_SHARE_SET); /// below threshold
+	std::vector<uint8_t> repeated(shares.begin(), shares.begin() + share_length);
+	repeated.insert(repeated.end(), shares.begin(), shares.begin() + 2 * share_length);
+	assert(shamir_reconstruct(repeated.data(), 3, share_length, restored) == SHAMIR_ERROR_SHARE_SET);
+	shares[share_length + 5] ^= 1;
+	assert(shamir_reconstruct(shares.data(), 3, share_length, restored) == SHAMIR_ERROR_SHARE);
+	assert(std::string(shamir_strerror(SHAMIR_ERROR_CHECKSUM)) == "Secret message checksum verification failed. Message possibly corrupted.");
+	std::cout << "C interface error codes: passed" << std::endl;
+}
+
+/// failed record of a batch does not stop the others
+void test_batch() {
+	const size_t batch = 6, length = 32, count = 5, threshold = 3;
+	const size_t share_length = shamir_share_size(length);
+	std::vector<uint8_t> secrets(batch * length), shares(batch * count * share_length), restored(batch * length);
+	for (size_t i = 0; i < secrets.size(); ++i) secrets[i] = (uint8_t) (i * 13 + i / 7);
+	std::vector<int> statuses(batch, -1);
+	assert(shamir_distribute_batch(secrets.data(), batch, length, threshold, count, shares.data(), statuses.data()) == SHAMIR_OK);
+	for (auto s: statuses) assert(s == SHAMIR_OK);
+
+	/// first 'threshold' shares of every set are used in place, stride stays 'count' shares
+	std::vector<uint8_t> sets(batch * threshold * share_length);
+	for (size_t b = 0; b < batch; ++b) {
+		std::memcpy(sets.data() + b * threshold * share_length, shares.data() + b * count * share_length, threshold * share_length);
+	}
+	sets[2 * threshold * share_length + 9] ^= 0x10;
+	assert(shamir_reconstruct_batch(sets.data(), batch, threshold, share_length, restored.data(), statuses.data()) == SHAMIR_ERROR_SHARE);
+	for (size_t b = 0; b < batch; ++b) {
+		if (b == 2) {
+			assert(statuses[b] == SHAMIR_ERROR_SHARE);
+			continue;
+		}
+		assert(statuses[b] == SHAMIR_OK);
+		assert(std::memcmp(restored.data() + b * length, secrets.data() + b * length, length) == 0);
+	}
+
+	/// shares too short to hold a packet, every status is written before returning
+	std::fill(statuses.begin(), statuses.end(), -1);
+	assert(shamir_reconstruct_batch(sets.data(), batch, threshold, 6, restored.data(), statuses.data()) == SHAMIR_ERROR_SHARE);
+	for (auto s: statuses) assert(s == SHAMIR_ERROR_SHARE);
+	std::cout << "C interface batch with failed record: passed" << std::endl;
+}
+
+/// batches hashed in lanes give the results of records processed one by one, short and long packets
+void test_batch_lanes() {
+	for (size_t length: {16, 32, 100}) {
+		const size_t batch = 50, count = 3, threshold = 2;
+		const size_t share_length = shamir_share_size(length);
+		std::vector<uint8_t> secrets(batch * length), shares(batch * count * share_length), restored(batch * length), single(length);
+		for (size_t i = 0; i < secrets.size(); ++i) secrets[i] = (uint8_t) (i * 29 + i / 5);
+		assert(shamir_distribute_batch(secrets.data(), batch, length, threshold, count, shares.data(), nullptr) == SHAMIR_OK);
+		for (size_t b = 7; b < batch; b += 11) shares[b * count * share_length + share_length + 3] ^= 0x04;
+		for (size_t b = 9; b < batch; b += 13) std::memcpy(shares.data() + b * count * share_length, shares.data() + (b * count + 1) * share_length, share_length);
+		std::vector<int> statuses(batch, -1);
+		shamir_reconstruct_batch(shares.data(), batch, count, share_length, restored.data(), statuses.data());
+		for (size_t b = 0; b < batch; ++b) {
+			const int status = shamir_reconstruct(shares.data() + b * count * share_length, count, share_length, single.data());
+			assert(statuses[b] == status);
+			if (status != SHAMIR_OK) continue;
+			assert(std::memcmp(restored.data() + b * length, secrets.data() + b * length, length) == 0);
+			assert(std::memcmp(single.data(), secrets.data() + b * length, length) == 0);
+		}
+		assert(statuses[7] == SHAMIR_ERROR_SHARE && statuses[9] == SHAMIR_ERROR_SHARE_SET && statuses[0] == SHAMIR_OK);
+	}
+	std::cout << "C interface batches hashed in lanes: passed" << std::endl;
+}
+
+/// phrases of C interface match the ones of the tool
+void test_mnemonics() {
+	uint8_t entropy[32];
+	size_t entropy_length(0);
+	assert(shamir_bip39_decode(mnemonic.c_str(), entropy, sizeof(entropy), &entropy_length) == SHAMIR_OK);
+	assert(entropy_length == 16);
+	for (size_t i = 0; i < entropy_length; ++i) assert(entropy[i] == 0x7f);
+	char words[1024];
+	assert(shamir_bip39_encode(entropy, entropy_length, words, sizeof(words)) == SHAMIR_OK);
+	assert(mnemonic == words);
+	assert(shamir_bip39_encode(entropy, entropy_length, words, 10) == SHAMIR_ERROR_BUFFER);
+	assert(shamir_bip39_decode("legal winner thank year wave sausage worth useful legal winner thank thank", entropy, sizeof(entropy), &entropy_length) == SHAMIR_ERROR_MNEMONIC);
+	assert(shamir_bip39_decode("legal winner notaword", entropy, sizeof(entropy), &entropy_length) == SHAMIR_ERROR_WORD);
+
+	auto slip = Shamir::split_mnemonic(Shamir::split_words(mnemonic), 2, 3);
+	std::vector<std::vector<uint8_t>> packets;
+	for (auto && phrase: slip) {
+		uint8_t packet[64];
+		size_t packet_length(0);
+		assert(shamir_slip39_decode(phrase.c_str(), packet, sizeof(packet), &packet_length) == SHAMIR_OK);
+		assert(std::vector<uint8_t>(packet, packet + packet_length) == Shamir::slip39_to_share(Shamir::split_words(phrase)));
+		assert(shamir_slip39_encode(packet, packet_length, words, sizeof(words)) == SHAMIR_OK);
+		assert(phrase == words);
+		packets.emplace_back(packet, packet + packet_length);
+	}
+	std::vector<uint8_t> flat;
+	for (size_t i = 1; i < packets.size(); ++i) flat.insert(flat.end(), packets[i].begin(), packets[i].end());
+	assert(shamir_reconstruct(flat.data(), 2, packets[0].size(), entropy) == SHAMIR_OK);
+	assert(shamir_bip39_encode(entropy, 16, words, sizeof(words)) == SHAMIR_OK);
+	assert(mnemonic == words);
+	std::cout << "C interface mnemonics: passed" << std::endl;
+}
+
+int main() {
+	try {
+		assert(shamir_abi_version() == SHAMIR_ABI_VERSION);
+		test_compatibility();
+		test_errors();
+		test_batch();
+		test_batch_lanes();
+		test_mnemonics();
+	} catch (const char * s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
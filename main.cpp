@@ -1,15 +1,29 @@
 #include <shamirmulti.h>
 #include <multiblock.h>
 #include <wordlist.h>
+#include <sharefile.h>
+#include <sharewriter.h>
+#include <vault.h>
+#include <mnemonic.h>
+#include <batch.h>
+#include <shardrun.h>
+#include <threadpool.h>
+#include <daemon.h>
+#include <get_insecure_randomness.h>
 
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <sstream>
 #include <string>
 #include <cstring>
 #include <cstdlib>
 #include <set>
+#include <vector>
+#include <algorithm>
+#include <csignal>
+#include <thread>
 
 namespace {
 	int readint(const char * s) {
@@ -22,8 +36,29 @@ namespace {
 	}
 }
 
-void process_clarg(bool & bip2slip, int & count, int & threshold, int argc, const char * argv[]) {
-	const std::string help("Usage: " + std::string(argv[0]) + " [-d|-m] -t <1-32> -n <1-32>\n\td...distribute\n\tm...merge\n\tt...threshold\n\tn...count\n\tt<=n\n");
+struct options {
+	bool bip2slip, batch;
+	int count, threshold, threads, processes, repair;
+	std::string file, writer, vault, label, input, socket, output;
+	std::vector<std::string> share_files;
+};
+
+void process_clarg(options & opt, int argc, const char * argv[]) {
+	const std::string help("Usage: " + std::string(argv[0]) + " [-d|-m] -t <1-32> -n <1-32>\n"
+			"       " + std::string(argv[0]) + " -d -t <1-32> -n <1-32> -f <secret file> [-w mmap|uring|pwrite]\n"
+			"       " + std::string(argv[0]) + " -m -f <output file> <share file>...\n"
+			"       " + std::string(argv[0]) + " -d -t <1-32> -n <1-32> -v <vault directory> [-l <label>]\n"
+			"       " + std::string(argv[0]) + " -m [-c <1-3>]\n"
+			"       " + std::string(argv[0]) + " -s <socket path> [-j <1-32>]\n"
+			"       " + std::string(argv[0]) + " -b [-d -t <1-32> -n <1-32>|-m [-c <1-3>]] [-i <input file>] [-j <1-32>]\n"
+			"       " + std::string(argv[0]) + " -b [-d -t <1-32> -n <1-32>|-m [-c <1-3>]] -i <input file> -p <1-32> -o <output file> [-j <1-32>]\n"
+			"\td...distribute\n\tm...merge\n\tt...threshold\n\tn...count\n\tf...binary secret file, shares are written to <secret file>.share<i>\n\tw...share file writer, defaults to mmap\n"
+			"\tj...number of threads splitting large secrets, defaults to 1; in batch mode number of threads processing records, defaults to all\n"
+			"\tb...batch mode, one mnemonic per line to distribute, or share sets separated by empty lines to merge\n\ti...batch input, defaults to standard input\n"
+			"\tp...number of worker processes the batch input is sharded among, threads per process given by j\n\to...output of sharded batch, restartable from <output file>.checkpoint\n"
+			"\ts...serve requests on Unix socket until interrupted\n"
+			"\tc...repair misspelled share words, up to given number of edits per word, checked by share and secret checksums\n"
+			"\tv...durable share vault, shares are stored as <label>.share<i>\n\tl...label of the shares in vault, defaults to wallet\n\tt<=n\n");
 	if (argc == 1) {
 		std::cerr << help;
 		exit(1);
@@ -31,16 +66,43 @@ void process_clarg(bool & bip2slip, int & count, int & threshold, int argc, cons
 	const char * invalid = "Invalid command line arguments";
 	bool tmps(false), tmpd(false);
 	std::set<char> arguments;
-	count = 0;
-	threshold = 0;
+	opt.count = 0;
+	opt.threshold = 0;
+	opt.threads = 0;
+	opt.processes = 0;
+	opt.repair = 0;
+	opt.batch = false;
 	arguments.insert('d');
 	arguments.insert('m');
 	arguments.insert('t');
 	arguments.insert('n');
 	arguments.insert('h');
+	arguments.insert('f');
+	arguments.insert('w');
+	arguments.insert('v');
+	arguments.insert('l');
+	arguments.insert('j');
+	arguments.insert('b');
+	arguments.insert('i');
+	arguments.insert('s');
+	arguments.insert('p');
+	arguments.insert('o');
+	arguments.insert('c');
 	for (int i = 1; i < argc; ++i) {
-		if (argv[i][0] != '-') throw invalid;
+		if (argv[i][0] != '-') {
+			opt.share_files.push_back(argv[i]);
+			continue;
+		}
 		if (std::strlen(argv[i]) > 2) throw invalid;
+		/// undocumented: reproducible coefficients from given seed, for benchmarks and differential testing only
+		if (argv[i][1] == 'r') {
+			if (++i >= argc) throw invalid;
+			char * end;
+			const unsigned long long seed = std::strtoull(argv[i], &end, 10);
+			if (*argv[i] == 0 || *end != 0) throw "Invalid number";
+			set_random_source(seeded_random_source(seed));
+			continue;
+		}
 		auto ig = arguments.find(argv[i][1]);
 		if (ig == arguments.end()) throw "Unsupported command line arguments";
 		switch ( *ig) {
@@ -50,12 +112,66 @@ void process_clarg(bool & bip2slip, int & count, int & threshold, int argc, cons
 				  break;
 			case 't':  ++i;
 				  if (i >=argc ) throw invalid;
-				  threshold = readint(argv[i]);
+				  opt.threshold = readint(argv[i]);
 				  continue;
 				  break;
 			case 'n':  ++i;
 				  if (i >=argc ) throw invalid;
-				  count = readint(argv[i]);
+				  opt.count = readint(argv[i]);
+				  continue;
+				  break;
+			case 'f':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.file = argv[i];
+				  continue;
+				  break;
+			case 'w':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.writer = argv[i];
+				  if (opt.writer != "mmap" && opt.writer != "uring" && opt.writer != "pwrite") throw "Unsupported share file writer";
+				  continue;
+				  break;
+			case 'j':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.threads = readint(argv[i]);
+				  continue;
+				  break;
+			case 'v':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.vault = argv[i];
+				  continue;
+				  break;
+			case 'l':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.label = argv[i];
+				  continue;
+				  break;
+			case 'b':  opt.batch = true;
+				  break;
+			case 'i':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.input = argv[i];
+				  continue;
+				  break;
+			case 'p':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.processes = readint(argv[i]);
+				  continue;
+				  break;
+			case 'o':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.output = argv[i];
+				  continue;
+				  break;
+			case 's':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.socket = argv[i];
+				  continue;
+				  break;
+			case 'c':  ++i;
+				  if (i >=argc ) throw invalid;
+				  opt.repair = readint(argv[i]);
+				  if (opt.repair > 3) throw "Number out of range";
 				  continue;
 				  break;
 			case 'h': if (argc == 2) {
@@ -65,39 +181,69 @@ void process_clarg(bool & bip2slip, int & count, int & threshold, int argc, cons
 				  break;
 		}
 	}
+	if (!opt.socket.empty()) {
+		if (tmpd || tmps || opt.batch || opt.repair > 0 || !opt.file.empty() || !opt.vault.empty() || !opt.share_files.empty()) throw "Exclusive command line options";
+		return;
+	}
 	if ((tmpd ^ tmps) == 0) throw "Exclusive command line options";
-	if (threshold * count == 0 && tmpd) throw "Inconsistent command line arguments";
-	if (tmpd && (threshold > count)) throw "Number of shares specified is smaller than threshold specified";
-	bip2slip = tmpd;
+	if (opt.threshold * opt.count == 0 && tmpd) throw "Inconsistent command line arguments";
+	if (tmpd && (opt.threshold > opt.count)) throw "Number of shares specified is smaller than threshold specified";
+	if (!opt.share_files.empty() && (tmpd || opt.file.empty())) throw invalid;
+	if (!opt.writer.empty() && (tmps || opt.file.empty())) throw invalid;
+	if (tmps && !opt.file.empty() && opt.share_files.empty()) throw "No share files given";
+	if (!opt.vault.empty() && (tmps || !opt.file.empty())) throw invalid;
+	if (!opt.label.empty() && opt.vault.empty()) throw invalid;
+	if (opt.batch && (!opt.file.empty() || !opt.vault.empty())) throw invalid;
+	if (!opt.input.empty() && !opt.batch) throw invalid;
+	if (opt.repair > 0 && (tmpd || !opt.file.empty())) throw invalid;
+	if ((opt.processes > 0) != !opt.output.empty()) throw invalid;
+	if (opt.processes > 0 && (!opt.batch || opt.input.empty())) throw "Sharded batch needs input file";
+	if (opt.label.empty()) opt.label = "wallet";
+	if (opt.threads == 0 && !opt.batch) opt.threads = 1;
+	if (opt.threads == 0 && opt.processes > 0) opt.threads = std::max(1u, std::thread::hardware_concurrency() / opt.processes);
+	opt.bip2slip = tmpd;
+}
+
+/// resolves abbreviated words in place; before throwing on a word which does not, lists the words it could stand for
+void explain_unknown_word(Shamir::word_list list, std::vector<std::string> & words) {
+	size_t unknown(0);
+	const Shamir::status status = Shamir::try_normalize_mnemonic(list, words, unknown);
+	if (status == Shamir::status::ok) return;
+	const std::string & word = words[unknown];
+	const auto candidates = Shamir::complete_word(list, word);
+	if (candidates.empty()) std::cerr << "word " << unknown + 1 << " '" << word << "' is not in the dictionary" << std::endl;
+	else {
+		std::cerr << "word " << unknown + 1 << " '" << word << "' is ambiguous, type more letters of:";
+		for (auto && c: candidates) std::cerr << ' ' << c;
+		std::cerr << std::endl;
+	}
+	Shamir::check(status);
 }
 
-void distribute(int threshold, int count) {
+void distribute(int threshold, int count, share_vault * vault, const std::string & label) {
 	std::cout << "Enter BIP39 mnemonic seed:\n";
 	char word[512];
 	/// read BIP39 seed
 	std::cin.getline(word, 512);
 	if (std::cin.fail()) throw "Problem with reading BIP mnemonic";
-	std::stringstream ss;
-	ss << word;
-	std::string tmpw;
-	std::vector<std::string> mnemonic;
-	while ( true ) {
-		ss >> tmpw;
-		if ( ss.fail() ) break;
-		mnemonic.push_back(tmpw);
-	}
+	auto mnemonic = Shamir::split_words(word);
 	try {
-		auto seed = Shamir::power2ToHex(Shamir::bip39ToNum(mnemonic), 11);
-		Shamir::check_bip39_checksum(seed);
-		auto raw_shares = Shamir::distribute(seed, threshold, count);
-		int total_share_bits = seed.size()*8 + 42;
-		for (auto sh: raw_shares) {
-			auto slip_words_num = Shamir::hexToPower2(sh,10);
-			if (slip_words_num.size()*10 - total_share_bits >= 10) slip_words_num.pop_back(); /// drop the last word if it does not encode any information
-			for (auto it: slip_words_num) {
-				std::cout << slip_words[it] << " ";
+		explain_unknown_word(Shamir::word_list::bip39, mnemonic);
+		auto lines = Shamir::split_mnemonic(mnemonic, threshold, count);
+		for (auto i = 0u; i < lines.size(); ++i) {
+			const std::string share_line(lines[i] + " \n");
+			if (vault == nullptr) {
+				std::cout << share_line << std::flush;
+				continue;
+			}
+			vault->put(label + ".share" + std::to_string(i + 1), reinterpret_cast<const uint8_t *>(share_line.data()), share_line.size());
+		}
+		if (vault != nullptr) {
+			vault->commit();
+			for (auto && b: vault->batches()) {
+				std::cerr << "vault commit: " << b.shares << " shares, " << b.bytes << " bytes, sync " << b.sync_ms
+					<< " ms, rename " << b.rename_ms << " ms, total " << b.total_ms << " ms" << std::endl;
 			}
-			std::cout << std::endl;
 		}
 
 	} catch (const char *s) {
@@ -107,7 +253,24 @@ void distribute(int threshold, int count) {
 
 }
 
-void process_share(std::vector<uint8_t> & hex_share, unsigned & index, unsigned & threshold) {
+/// share of the phrase, damaged words repaired within 'repair' edits if it is not zero; 'repaired' is set when a word was
+std::vector<uint8_t> read_share(const std::string & line, unsigned repair, bool & repaired) {
+	auto words = Shamir::split_words(line);
+	if (repair == 0) {
+		explain_unknown_word(Shamir::word_list::slip39, words);
+		return Shamir::slip39_to_share(words);
+	}
+	const auto given = words;
+	auto share = Shamir::try_repair_slip39_share(words, repair).value();
+	for (size_t i = 0; i < words.size(); ++i) {
+		if (words[i] == given[i]) continue;
+		std::cerr << "word " << i + 1 << " '" << given[i] << "' repaired to '" << words[i] << "'" << std::endl;
+		repaired = true;
+	}
+	return share;
+}
+
+void process_share(std::vector<uint8_t> & hex_share, unsigned & index, unsigned & threshold, unsigned repair, bool & repaired) {
 	if (threshold > 0) std::cout << index << " out of " << threshold<< " shares entered. Enter another share:" << std::endl;
 	else std::cout << index << " out of ??" << " shares entered. Enter another share:" << std::endl;
 	char word[512];
@@ -115,31 +278,16 @@ void process_share(std::vector<uint8_t> & hex_share, unsigned & index, unsigned
 	
 	std::cin.getline(word, 512);
 	if (std::cin.fail()) throw "Problem with reading BIP mnemonic";
-	std::stringstream ss;
-	ss << word;
 	if (std::strlen(word) == 0) {
 		index = 0;
 		threshold = 0;
 		return;
 	}
-	std::string tmpw;
-	std::vector<std::string> mnemonic;
-	while ( true ) {
-		ss >> tmpw;
-		if ( ss.fail() ) break;
-		mnemonic.push_back(tmpw);
-	}
 	try {
-		auto num_share = Shamir::slip39ToNum(mnemonic);
-		hex_share = Shamir::power2ToHex(num_share, 10);
-		int secret_length = ((num_share.size() * 10 - 42)/32)*4;
-		int share_bytes = (secret_length*8 + 42)/8;
-		share_bytes += (share_bytes % 8) ? 1 : 0;
-		hex_share.resize(share_bytes); /// stripp zero byte introduced by successive zero-padding during 10-bit array conversion to 8-bit array
+		hex_share = read_share(word, repair, repaired);
 
-		share preview(hex_share);
-		index = preview.index;
-		threshold = preview.threshold;
+		if (hex_share.size() < 5) throw "invalid share packet";
+		if (!Shamir::open_share_packet(hex_share.data(), hex_share.size(), index, threshold)) throw "checksum verification failed";
 
 	} catch (const char * s) {
 		std::cerr << s << std::endl;
@@ -148,13 +296,44 @@ void process_share(std::vector<uint8_t> & hex_share, unsigned & index, unsigned
 	}
 }
 
-void merge() {
+void file_distribute(const std::string & file, const std::string & writer, int threshold, int count) {
+	try {
+		mapped_file secret(file);
+		std::vector<std::string> paths;
+		for (int i = 1; i <= count; ++i) paths.push_back(file + ".share" + std::to_string(i));
+		if (writer.empty() || writer == "mmap") {
+			Shamir::distribute_to_files(secret.data(), secret.size(), threshold, paths);
+		} else {
+			auto backend = (writer == "uring") ? share_writer_backend::uring : share_writer_backend::pwrite;
+			auto out = make_share_writer(paths, Shamir::sharefile_size(secret.size()), backend);
+			Shamir::distribute_to_files(secret.data(), secret.size(), threshold, *out);
+		}
+	} catch (const char *s) {
+		std::cerr << s << std::endl;
+		exit(1);
+	}
+}
+
+void file_merge(const std::string & file, const std::vector<std::string> & share_files) {
+	try {
+		auto secret = Shamir::reconstruct_from_files(share_files);
+		mapped_file output(file, secret.size());
+		std::copy(secret.begin(), secret.end(), output.data());
+		output.sync();
+	} catch (const char *s) {
+		std::cerr << s << std::endl;
+		exit(1);
+	}
+}
+
+void merge(unsigned repair) {
 	std::vector<uint8_t> raw_share;
 	std::vector<std::vector<uint8_t>> all_shares;
 	unsigned count(1), index(0), threshold(0), fresh_threshold(0);
 	std::set<unsigned> indices;
+	bool repaired(false);
 	while (threshold == 0)
-		process_share(raw_share, index, threshold);
+		process_share(raw_share, index, threshold, repair, repaired);
 	all_shares.reserve(threshold);
 	all_shares.push_back(raw_share);
 
@@ -163,7 +342,7 @@ void merge() {
 		index = count;
 		fresh_threshold = threshold;
 		raw_share.clear();
-		process_share(raw_share, index, fresh_threshold);
+		process_share(raw_share, index, fresh_threshold, repair, repaired);
 		if (fresh_threshold == 0) continue; /// reading went wrong, give it another try
 		if (fresh_threshold != threshold) throw "Inconsistent shares. Thresholds differ.";
 		if (indices.find(index) != indices.cend()) {
@@ -174,34 +353,222 @@ void merge() {
 		all_shares.push_back(raw_share);
 		++count;
 	}
-	try {
-		auto secret = Shamir::reconstruct(all_shares);
-		int total_mnemonic_bits = secret.size()/4*33;
-		auto secret_bip39 = Shamir::hexToPower2(Shamir::append_bip39_checksum(secret), 11);
-		if (secret_bip39.size() * 11 - total_mnemonic_bits >= 11) secret_bip39.pop_back(); /// drop the last word if it does not encode any information
-		std::cout << "Reconstructed BIP39 seed:";
-		for (auto it: secret_bip39) {
-			auto word = bip_words[it];
-			std::cout << std::setw(word.size() + 1) << word;
+	/// a repaired share may be wrong, one more share lets the secret be checked from several windows of shares
+	while (repaired) {
+		std::cout << "Some words were repaired. Enter one more share to cross-check them, or an empty line to skip:" << std::endl;
+		index = count;
+		fresh_threshold = threshold;
+		try {
+			process_share(raw_share, index, fresh_threshold, repair, repaired);
+		} catch (const char *) {
+			break; /// end of input, nothing more to check with
+		}
+		if (fresh_threshold == 0) break;
+		if (fresh_threshold != threshold) throw "Inconsistent shares. Thresholds differ.";
+		if (indices.find(index) != indices.cend()) {
+			std::cout << "Share with current index already given. Give another one." << std::endl;
+			continue;
 		}
+		all_shares.push_back(raw_share);
+		break;
+	}
+	try {
+		std::cout << "Reconstructed BIP39 seed: " << (repair > 0 ? Shamir::try_merge_repaired(all_shares).value() : Shamir::merge_mnemonic(all_shares));
 		std::cout << std::endl;
 	} catch (const char * s) {
 		std::cerr << s << std::endl;
 	}
 }
 
+/// records of a group are split together, their BIP39 checksums and share checksums hashed side by side
+void distribute_records(const std::string * records, size_t count, std::string * outputs, std::string * errors, unsigned threshold, unsigned share_count) {
+	std::vector<std::vector<std::string>> phrases;
+	std::vector<size_t> parsed;
+	for (size_t i = 0; i < count; ++i) {
+		auto words = Shamir::split_words(records[i]);
+		size_t unknown;
+		const Shamir::status status = Shamir::try_normalize_mnemonic(Shamir::word_list::bip39, words, unknown);
+		if (status != Shamir::status::ok) {
+			errors[i] = Shamir::message(status);
+			continue;
+		}
+		phrases.push_back(words);
+		parsed.push_back(i);
+	}
+	auto results = Shamir::try_split_mnemonics(phrases, threshold, share_count);
+	for (size_t p = 0; p < parsed.size(); ++p) {
+		if (!results[p]) {
+			errors[parsed[p]] = Shamir::message(results[p].error());
+			continue;
+		}
+		std::string & output = outputs[parsed[p]];
+		output.clear();
+		for (auto && line: results[p].value()) output += line + "\n";
+	}
+}
+
+/// share sets of a group are merged together, see try_merge_mnemonics
+void merge_records(const std::string * records, size_t count, std::string * outputs, std::string * errors, unsigned repair) {
+	std::vector<std::vector<std::vector<uint8_t>>> sets;
+	std::vector<size_t> parsed;
+	for (size_t i = 0; i < count; ++i) {
+		std::istringstream lines(records[i]);
+		std::string line;
+		std::vector<std::vector<uint8_t>> shares;
+		try {
+			while (std::getline(lines, line)) {
+				auto words = Shamir::split_words(line);
+				if (repair > 0) shares.push_back(Shamir::try_repair_slip39_share(words, repair).value());
+				else shares.push_back(Shamir::slip39_to_share(Shamir::normalize_mnemonic(Shamir::word_list::slip39, words)));
+			}
+		} catch (const char * s) {
+			errors[i] = s;
+			continue;
+		}
+		if (repair > 0) {
+			/// repaired shares may be wrong, sets are cross-checked one by one
+			auto merged = Shamir::try_merge_repaired(shares);
+			if (merged) outputs[i] = merged.value() + "\n";
+			else errors[i] = Shamir::message(merged.error());
+			continue;
+		}
+		sets.push_back(std::move(shares));
+		parsed.push_back(i);
+	}
+	auto results = Shamir::try_merge_mnemonics(sets);
+	for (size_t p = 0; p < parsed.size(); ++p) {
+		if (results[p]) outputs[parsed[p]] = results[p].value() + "\n";
+		else errors[parsed[p]] = Shamir::message(results[p].error());
+	}
+}
+
+void sharded_batch(const options & opt) {
+	try {
+		Shamir::set_thread_count(1);
+		Shamir::sharded_stats stats;
+		if (opt.bip2slip) {
+			const unsigned threshold(opt.threshold), count(opt.count);
+			stats = Shamir::run_sharded_batch(opt.input, opt.output, opt.processes, opt.threads, false, "\n",
+					[threshold, count] (const std::string * records, size_t n, std::string * outputs, std::string * errors) {
+				distribute_records(records, n, outputs, errors, threshold, count);
+			});
+		} else {
+			const unsigned repair(opt.repair);
+			stats = Shamir::run_sharded_batch(opt.input, opt.output, opt.processes, opt.threads, true, "",
+					[repair] (const std::string * records, size_t n, std::string * outputs, std::string * errors) {
+				merge_records(records, n, outputs, errors, repair);
+			});
+		}
+		for (size_t i = 0; i < stats.shards.size(); ++i) {
+			const auto & s = stats.shards[i];
+			std::cerr << "shard " << i + 1 << ": records " << s.first_record + 1 << ".." << s.first_record + s.records << ", " << s.failed << " failed, "
+				<< s.seconds << " s" << (s.resumed ? " (from checkpoint)" : "") << std::endl;
+		}
+		std::cerr << "batch: " << stats.records << " records, " << stats.failed << " failed, " << opt.processes << " processes, "
+			<< opt.threads << " threads each, merge " << stats.merge_seconds << " s" << std::endl;
+		if (stats.failed > 0) exit(1);
+	} catch (const char *s) {
+		std::cerr << s << std::endl;
+		exit(1);
+	}
+}
+
+void batch(const options & opt) {
+	try {
+		std::ifstream file;
+		if (!opt.input.empty()) {
+			file.open(opt.input);
+			if (!file) throw "Cannot open batch input";
+		}
+		std::istream & input = opt.input.empty() ? std::cin : file;
+		/// records are spread over the threads, every single one is split sequentially
+		Shamir::set_thread_count(1);
+		thread_pool pool(opt.threads);
+		Shamir::batch_stats stats;
+		if (opt.bip2slip) {
+			const unsigned threshold(opt.threshold), count(opt.count);
+			stats = Shamir::run_batch(input, std::cout, false, "\n", [threshold, count] (const std::string * records, size_t n, std::string * outputs, std::string * errors) {
+				distribute_records(records, n, outputs, errors, threshold, count);
+			}, pool);
+		} else {
+			const unsigned repair(opt.repair);
+			stats = Shamir::run_batch(input, std::cout, true, "", [repair] (const std::string * records, size_t n, std::string * outputs, std::string * errors) {
+				merge_records(records, n, outputs, errors, repair);
+			}, pool);
+		}
+		std::cerr << "batch: " << stats.records << " records, " << stats.failed << " failed, " << pool.size() << " threads, "
+			<< stats.steals << " steals, " << stats.seconds << " s" << std::endl;
+		if (stats.failed > 0) exit(1);
+	} catch (const char *s) {
+		std::cerr << s << std::endl;
+		exit(1);
+	}
+}
+
+namespace {
+	share_daemon * running_daemon = nullptr;
+
+	void stop_daemon(int) {
+		if (running_daemon != nullptr) running_daemon->stop();
+	}
+}
+
+void serve(const options & opt) {
+	try {
+		share_daemon daemon(opt.socket, opt.threads);
+		running_daemon = &daemon;
+		std::signal(SIGINT, stop_daemon);
+		std::signal(SIGTERM, stop_daemon);
+		daemon.run();
+		running_daemon = nullptr;
+		auto s = daemon.stats();
+		std::cerr << "daemon: " << s.requests << " requests in " << s.batches << " batches, " << s.errors << " failed, p99 "
+			<< s.p99_us << " us" << std::endl;
+	} catch (const char *s) {
+		std::cerr << s << std::endl;
+		exit(1);
+	}
+}
+
 int main(int argc, const char* argv[]) {
-	bool bip2slip(true);
-	int threshold, count;
+	options opt;
 	try {
-		process_clarg(bip2slip, count, threshold, argc, argv);
+		process_clarg(opt, argc, argv);
 	} catch (const char *s) {
 		std::cerr << "Error: " << s << std::endl;
 		exit(0);
 	}
-	if (bip2slip)
-		distribute((unsigned) threshold, (unsigned) count);
+	if (!opt.socket.empty()) {
+		serve(opt);
+		return 0;
+	}
+	if (opt.batch && opt.processes > 0) {
+		sharded_batch(opt);
+		return 0;
+	}
+	if (opt.batch) {
+		batch(opt);
+		return 0;
+	}
+	Shamir::set_thread_count(opt.threads);
+	if (!opt.file.empty()) {
+		if (opt.bip2slip)
+			file_distribute(opt.file, opt.writer, opt.threshold, opt.count);
+		else
+			file_merge(opt.file, opt.share_files);
+	}
+	else if (opt.bip2slip && !opt.vault.empty()) {
+		try {
+			share_vault vault(opt.vault);
+			distribute((unsigned) opt.threshold, (unsigned) opt.count, &vault, opt.label);
+		} catch (const char *s) {
+			std::cerr << s << std::endl;
+			exit(1);
+		}
+	}
+	else if (opt.bip2slip)
+		distribute((unsigned) opt.threshold, (unsigned) opt.count, nullptr, opt.label);
 	else 
-		merge();
+		merge(opt.repair);
 	return 0;
 }
@@ -0,0 +1,298 @@
+#include <mnemonic.h>
+#include <shamirmulti.h>
+#include <wordlist.h>
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <map>
+
+namespace Shamir {
+	std::vector<std::string> split_words(const std::string & line) {
+		std::istringstream ss(line);
+		std::vector<std::string> words;
+		std::string word;
+		while (ss >> word) words.push_back(word);
+		return words;
+	}
+
+	status try_normalize_mnemonic(word_list list, std::vector<std::string> & words, size_t & unknown) {
+		for (size_t i = 0; i < words.size(); ++i) {
+			const int index = resolve_word(list, words[i]);
+			if (index < 0) {
+				unknown = i;
+				return list == word_list::slip39 ? status::unknown_slip39_word : status::unknown_bip39_word;
+			}
+			const word_view & word = list == word_list::slip39 ? slip_words[index] : bip_words[index];
+			if (word.size() != words[i].size()) words[i] = word.str();
+		}
+		return status::ok;
+	}
+
+	std::vector<std::string> normalize_mnemonic(word_list list, const std::vector<std::string> & words) {
+		std::vector<std::string> output(words);
+		size_t unknown;
+		check(try_normalize_mnemonic(list, output, unknown));
+		return output;
+	}
+
+	namespace {
+		/// SLIP39 phrase of a share packet of a 'seed_length' bytes seed
+		std::string share_phrase(const std::vector<uint8_t> & share, size_t seed_length) {
+			const size_t total_share_bits = seed_length*8 + 42;
+			auto slip_words_num = hexToPower2(share, 10);
+			if (slip_words_num.size()*10 - total_share_bits >= 10) slip_words_num.pop_back(); /// drop the last word if it does not encode any information
+			std::string line;
+			for (auto it: slip_words_num) {
+				if (!line.empty()) line += ' ';
+				line += slip_words[it];
+			}
+			return line;
+		}
+
+		/// BIP39 phrase of a seed with its checksum appended
+		std::string seed_phrase(const std::vector<uint8_t> & seed, size_t seed_length) {
+			const size_t total_mnemonic_bits = seed_length/4*33;
+			auto secret_bip39 = hexToPower2(seed, 11);
+			if (secret_bip39.size() * 11 - total_mnemonic_bits >= 11) secret_bip39.pop_back(); /// drop the last word if it does not encode any information
+			std::string output;
+			for (auto it: secret_bip39) {
+				if (!output.empty()) output += ' ';
+				output += bip_words[it];
+			}
+			return output;
+		}
+	}
+
+	std::vector<std::string> split_mnemonic(const std::vector<std::string> & bip39, unsigned threshold, unsigned count) {
+		auto seed = power2ToHex(bip39ToNum(bip39), 11);
+		check_bip39_checksum(seed);
+		auto raw_shares = distribute(seed, threshold, count);
+		std::vector<std::string> output;
+		output.reserve(raw_shares.size());
+		for (auto && sh: raw_shares) output.push_back(share_phrase(sh, seed.size()));
+		return output;
+	}
+
+	std::vector<result<std::vector<std::string>>> try_split_mnemonics(const std::vector<std::vector<std::string>> & bip39, unsigned threshold, unsigned count) {
+		if (count < threshold) throw "share threshold must be equal or greater than total share count";
+		if (threshold == 0) throw "threshold must be greater than zero";
+		if (count > 32) throw "share count must be at most 32";
+		std::vector<result<std::vector<std::string>>> output;
+		std::vector<std::vector<uint8_t>> seeds(bip39.size());
+		std::vector<status> statuses(bip39.size());
+		for (size_t i = 0; i < bip39.size(); ++i) {
+			std::vector<int> nums;
+			statuses[i] = try_bip39ToNum(bip39[i], nums);
+			if (statuses[i] == status::ok) seeds[i] = power2ToHex(nums, 11);
+		}
+		std::vector<status> checksums;
+		try_check_bip39_checksums(seeds, checksums);
+		/// seeds of one length are split together, their checksums hashed side by side
+		std::map<size_t, std::vector<size_t>> lengths;
+		for (size_t i = 0; i < bip39.size(); ++i) {
+			if (statuses[i] == status::ok) statuses[i] = checksums[i];
+			if (statuses[i] == status::ok && seeds[i].empty()) statuses[i] = status::invalid_share;
+			if (statuses[i] == status::ok) lengths[seeds[i].size()].push_back(i);
+		}
+		std::vector<std::vector<std::string>> phrases(bip39.size());
+		for (auto && group: lengths) {
+			const size_t length = group.first, stride = share_size(length), batch = group.second.size();
+			std::vector<uint8_t> msgs(batch * length), shares(batch * count * stride);
+			for (size_t b = 0; b < batch; ++b) std::copy(seeds[group.second[b]].begin(), seeds[group.second[b]].end(), msgs.begin() + b * length);
+			distribute_packets_batch(msgs.data(), batch, length, threshold, count, shares.data(), stride);
+			for (size_t b = 0; b < batch; ++b) {
+				for (unsigned s = 0; s < count; ++s) {
+					const uint8_t * packet = shares.data() + (b * count + s) * stride;
+					phrases[group.second[b]].push_back(share_phrase(std::vector<uint8_t>(packet, packet + stride), length));
+				}
+			}
+			std::fill(msgs.begin(), msgs.end(), 0);
+		}
+		for (size_t i = 0; i < bip39.size(); ++i) {
+			if (statuses[i] == status::ok) output.push_back(std::move(phrases[i]));
+			else output.push_back(statuses[i]);
+		}
+		return output;
+	}
+
+	namespace {
+		result<std::vector<uint8_t>> words_to_share(const std::vector<int> & num_share) {
+			if (num_share.size() * 10 < 42 + 32) return status::invalid_share;
+			auto hex_share = power2ToHex(num_share, 10);
+			const size_t secret_length = ((num_share.size() * 10 - 42)/32)*4;
+			hex_share.resize(share_size(secret_length)); /// strip zero byte introduced by successive zero-padding during 10-bit array conversion to 8-bit array
+			return std::move(hex_share);
+		}
+
+		bool share_checks(const std::vector<int> & num_share) {
+			auto share = words_to_share(num_share);
+			unsigned index, threshold;
+			return share && open_share_packet(share.value().data(), share.value().size(), index, threshold);
+		}
+
+		/**
+		 * tries every combination of the candidates of the damaged positions, stops at the second one passing
+		 * the checksum. 'found' receives the passing words, returns number of passing combinations (0, 1 or 2).
+		 */
+		int try_candidates(std::vector<int> & num_share, const std::vector<size_t> & positions,
+				const std::vector<std::vector<int>> & candidates, std::vector<int> & found) {
+			int passing(0);
+			std::vector<size_t> choice(positions.size(), 0);
+			for (;;) {
+				for (size_t p = 0; p < positions.size(); ++p) num_share[positions[p]] = candidates[p][choice[p]];
+				if (share_checks(num_share)) {
+					if (++passing > 1) return passing;
+					found = num_share;
+				}
+				size_t p = 0;
+				while (p < positions.size() && ++choice[p] == candidates[p].size()) choice[p++] = 0;
+				if (p == positions.size()) return passing;
+			}
+		}
+	}
+
+	result<std::vector<uint8_t>> try_slip39_to_share(const std::vector<std::string> & slip39) {
+		std::vector<int> num_share;
+		const status words = try_slip39ToNum(slip39, num_share);
+		if (words != status::ok) return words;
+		return words_to_share(num_share);
+	}
+
+	result<std::vector<uint8_t>> try_repair_slip39_share(std::vector<std::string> & slip39, unsigned distance) {
+		/// every wrong candidate passes the 16 bit share checksum with probability 2^-16, this many keep a false repair below 2^-8
+		const size_t most_trials = 1 << 8;
+		size_t trials(0);
+		std::vector<int> num_share(slip39.size());
+		std::vector<size_t> damaged;
+		for (size_t i = 0; i < slip39.size(); ++i) {
+			num_share[i] = resolve_word(word_list::slip39, slip39[i]);
+			if (num_share[i] < 0) damaged.push_back(i);
+		}
+		if (damaged.empty()) {
+			auto share = words_to_share(num_share);
+			unsigned index, threshold;
+			if (!share || open_share_packet(share.value().data(), share.value().size(), index, threshold)) {
+				for (size_t i = 0; i < slip39.size(); ++i) slip39[i] = slip_words[num_share[i]].str();
+				return share;
+			}
+		}
+		std::vector<int> found;
+		bool tried(false);
+		for (unsigned edits = 1; edits <= distance; ++edits) {
+			int passing(0);
+			if (damaged.empty()) {
+				/// every word is in the dictionary, one of them is the wrong one; the budget covers all positions together
+				std::vector<std::vector<int>> neighbours(num_share.size());
+				for (size_t i = 0; i < num_share.size(); ++i) {
+					for (int c: similar_words(word_list::slip39, slip_words[num_share[i]].str(), edits)) {
+						if (c != num_share[i]) neighbours[i].push_back(c);
+					}
+					trials += neighbours[i].size();
+					if (trials > most_trials) return status::share_checksum;
+				}
+				for (size_t i = 0; i < num_share.size() && passing < 2; ++i) {
+					if (neighbours[i].empty()) continue;
+					std::vector<int> trial(num_share);
+					passing += try_candidates(trial, std::vector<size_t>(1, i), std::vector<std::vector<int>>(1, neighbours[i]), found);
+				}
+			} else {
+				std::vector<std::vector<int>> candidates;
+				size_t combinations(1);
+				for (size_t i: damaged) {
+					candidates.push_back(similar_words(word_list::slip39, slip39[i], edits));
+					combinations *= std::max<size_t>(candidates.back().size(), 1);
+					if (trials + combinations > most_trials) return status::share_checksum;
+				}
+				if (std::any_of(candidates.begin(), candidates.end(), [] (const std::vector<int> & c) { return c.empty(); })) continue;
+				trials += combinations;
+				tried = true;
+				passing = try_candidates(num_share, damaged, candidates, found);
+			}
+			if (passing > 1) return status::share_checksum;
+			if (passing == 1) {
+				for (size_t i = 0; i < slip39.size(); ++i) slip39[i] = slip_words[found[i]].str();
+				return words_to_share(found);
+			}
+		}
+		return damaged.empty() || tried ? status::share_checksum : status::unknown_slip39_word;
+	}
+
+	std::vector<uint8_t> slip39_to_share(const std::vector<std::string> & slip39) {
+		return try_slip39_to_share(slip39).value();
+	}
+
+	result<std::string> try_merge_mnemonic(const std::vector<std::vector<uint8_t>> & shares) {
+		auto restored = try_reconstruct(shares);
+		if (!restored) return restored.error();
+		auto & secret = restored.value();
+		const size_t length = secret.size();
+		return seed_phrase(append_bip39_checksum(secret), length);
+	}
+
+	std::vector<result<std::string>> try_merge_mnemonics(const std::vector<std::vector<std::vector<uint8_t>>> & sets) {
+		std::vector<result<std::string>> output(sets.size(), result<std::string>(status::not_enough_shares));
+		/// sets of the same shape are restored together, packets and secrets hashed side by side
+		std::map<std::pair<size_t, size_t>, std::vector<size_t>> shapes;
+		for (size_t i = 0; i < sets.size(); ++i) {
+			if (sets[i].empty()) continue;
+			const size_t share_length = sets[i][0].size();
+			bool same = share_length >= 7;
+			for (auto && s: sets[i]) same = same && s.size() == share_length;
+			if (same) shapes[std::make_pair(sets[i].size(), share_length)].push_back(i);
+			else output[i] = try_merge_mnemonic(sets[i]);
+		}
+		std::vector<size_t> restored;
+		std::vector<std::vector<uint8_t>> seeds;
+		for (auto && shape: shapes) {
+			const size_t count = shape.first.first, share_length = shape.first.second, batch = shape.second.size(), length = share_length - 6;
+			std::vector<uint8_t> shares(batch * count * share_length), secrets(batch * length);
+			for (size_t b = 0; b < batch; ++b) {
+				for (size_t s = 0; s < count; ++s) {
+					const auto & packet = sets[shape.second[b]][s];
+					std::copy(packet.begin(), packet.end(), shares.begin() + (b * count + s) * share_length);
+				}
+			}
+			std::vector<status> statuses(batch);
+			reconstruct_packets_batch(shares.data(), batch, count, share_length, share_length, secrets.data(), statuses.data());
+			for (size_t b = 0; b < batch; ++b) {
+				/// failures are rare, the set is merged again on its own for the exact status
+				if (statuses[b] != status::ok) {
+					output[shape.second[b]] = try_merge_mnemonic(sets[shape.second[b]]);
+					continue;
+				}
+				restored.push_back(shape.second[b]);
+				seeds.push_back(std::vector<uint8_t>(secrets.begin() + b * length, secrets.begin() + (b + 1) * length));
+			}
+			std::fill(secrets.begin(), secrets.end(), 0);
+		}
+		append_bip39_checksums(seeds);
+		for (size_t r = 0; r < restored.size(); ++r) {
+			const size_t length = sets[restored[r]][0].size() - 6;
+			output[restored[r]] = seed_phrase(seeds[r], length);
+		}
+		return output;
+	}
+
+	result<std::string> try_merge_repaired(const std::vector<std::vector<uint8_t>> & shares) {
+		auto whole = try_merge_mnemonic(shares);
+		if (!whole) return whole;
+		/// lengths and thresholds agree and the packets passed their checksums, or the whole set would have failed
+		unsigned index, threshold;
+		read_share_header(shares[0].data(), index, threshold);
+		if (shares.size() == threshold) return whole;
+		std::vector<std::vector<uint8_t>> window(threshold);
+		for (size_t first = 0; first < shares.size(); ++first) {
+			for (size_t w = 0; w < threshold; ++w) window[w] = shares[(first + w) % shares.size()];
+			auto part = try_merge_mnemonic(window);
+			if (!part) return part;
+			if (part.value() != whole.value()) return status::secret_checksum;
+		}
+		return whole;
+	}
+
+	std::string merge_mnemonic(const std::vector<std::vector<uint8_t>> & shares) {
+		return try_merge_mnemonic(shares).value();
+	}
+} // Shamir namespace
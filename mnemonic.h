@@ -0,0 +1,57 @@
+#ifndef MNEMONIC
+#define MNEMONIC
+
+#include <shamirstatus.h>
+#include <wordlist.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * conversions between BIP39 mnemonic phrases, SLIP39 share phrases and binary shares,
+ * as used by the command line tool. Words are separated by whitespace.
+ */
+namespace Shamir {
+	std::vector<std::string> split_words(const std::string & line);
+	/// replaces abbreviated words of the phrase (see resolve_word) by whole ones, throws on unknown or ambiguous word
+	std::vector<std::string> normalize_mnemonic(word_list list, const std::vector<std::string> & words);
+	/// verifies BIP39 checksum of the phrase and splits its enthropy into 'count' SLIP39 share phrases
+	std::vector<std::string> split_mnemonic(const std::vector<std::string> & bip39, unsigned threshold, unsigned count);
+	/// binary share packet encoded by SLIP39 share phrase, checksum is not verified yet
+	std::vector<uint8_t> slip39_to_share(const std::vector<std::string> & slip39);
+	/// reconstructs enthropy from binary shares and returns it as BIP39 mnemonic phrase
+	std::string merge_mnemonic(const std::vector<std::vector<uint8_t>> & shares);
+
+	/// non-throwing variants for validating many candidate phrases, see shamirstatus.h
+	result<std::vector<uint8_t>> try_slip39_to_share(const std::vector<std::string> & slip39);
+	result<std::string> try_merge_mnemonic(const std::vector<std::vector<uint8_t>> & shares);
+	/**
+	 * split_mnemonic and merge_mnemonic of many phrases or share sets at once, for batch pipelines: seeds and
+	 * share sets of the same length go through distribute_packets_batch / reconstruct_packets_batch and their
+	 * BIP39 checksums through SHA256Batch, so checksums are hashed side by side. Result i belongs to input i,
+	 * invalid threshold or count throw as in split_mnemonic.
+	 */
+	std::vector<result<std::vector<std::string>>> try_split_mnemonics(const std::vector<std::vector<std::string>> & bip39, unsigned threshold, unsigned count);
+	std::vector<result<std::string>> try_merge_mnemonics(const std::vector<std::vector<std::vector<uint8_t>>> & sets);
+	/// 'unknown' receives position of the first word which resolves to none or several words
+	status try_normalize_mnemonic(word_list list, std::vector<std::string> & words, size_t & unknown);
+	/**
+	 * binary share of a damaged SLIP39 phrase: words which are not in the dictionary, or a single misspelled word
+	 * which happens to be in it, are replaced by dictionary words within 'distance' edits (see similar_words) until
+	 * the share checksum matches. Fewer edits are tried first, corrections are written back to 'slip39'.
+	 * No candidate or more than one matching the 16 bit checksum is reported as share_checksum, and so is damage
+	 * needing more than 2^8 candidate shares in total. A wrong candidate passes the checksum with probability
+	 * 2^-16, so a repair is wrong with probability up to 2^-8; merge repaired shares with try_merge_repaired.
+	 */
+	result<std::vector<uint8_t>> try_repair_slip39_share(std::vector<std::string> & slip39, unsigned distance);
+	/**
+	 * try_merge_mnemonic of a set which may hold wrongly repaired shares. Shares must agree in length and threshold,
+	 * and a set of more than threshold shares must restore the same secret from every window of threshold shares
+	 * taken in turn, otherwise secret_checksum is reported. With exactly threshold shares only the 16 bit checksum
+	 * of the secret stands behind a wrong repair, letting it through with probability 2^-16.
+	 */
+	result<std::string> try_merge_repaired(const std::vector<std::vector<uint8_t>> & shares);
+}
+
+#endif
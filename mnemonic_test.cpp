@@ -0,0 +1,110 @@
+#include <mnemonic.h>
+#include <shamirmulti.h>
+#include <multiblock.h>
+#include <wordlist.h>
+#include <get_insecure_randomness.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+namespace {
+	const std::string mnemonic("legal winner thank year wave sausage worth useful legal winner thank yellow");
+
+	/// 3 of 5 shares of the mnemonic, the same on every run
+	std::vector<std::string> fixed_shares() {
+		set_random_source(seeded_random_source(39));
+		const auto lines = Shamir::split_mnemonic(Shamir::split_words(mnemonic), 3, 5);
+		set_random_source(random_source());
+		return lines;
+	}
+
+	/// 'damaged' is repaired within 'distance' edits to exactly the words and bytes of 'line'
+	void expect_repaired(const std::string & line, std::vector<std::string> damaged, unsigned distance) {
+		const auto original = Shamir::split_words(line);
+		auto given = Shamir::try_slip39_to_share(damaged);
+		unsigned index, threshold;
+		assert(!given || !Shamir::open_share_packet(given.value().data(), given.value().size(), index, threshold));
+		auto share = Shamir::try_repair_slip39_share(damaged, distance);
+		assert(share);
+		assert(share.value() == Shamir::slip39_to_share(original));
+		assert(damaged == original);
+	}
+}
+
+/// fixed misspellings come back as the original share, damage beyond the trial budget is refused
+void test_repair() {
+	const auto lines = fixed_shares();
+	auto words = Shamir::split_words(lines[0]);
+	assert(words[3] == "source");
+	words[3] = "surce";
+	expect_repaired(lines[0], words, 1);
+
+	words = Shamir::split_words(lines[1]);
+	assert(words[4] == "recipe" && words[9] == "dentist");
+	words[4] = "ecipe";
+	words[9] = "dnetist";
+	expect_repaired(lines[1], words, 2);
+
+	/// a misspelling which is itself a dictionary word, found among the neighbours of every word
+	words = Shamir::split_words(lines[0]);
+	assert(words[2] == "clever");
+	words[2] = "cover";
+	expect_repaired(lines[0], words, 2);
+
+	auto intact = Shamir::split_words(lines[3]);
+	assert(Shamir::try_repair_slip39_share(intact, 1).value() == Shamir::slip39_to_share(Shamir::split_words(lines[3])));
+
+	words = Shamir::split_words(lines[4]);
+	/// 19 and 24 words lie within 2 edits of these, 456 combinations are more than the trial budget allows
+	assert(words[5] == "lens" && words[8] == "real");
+	words[5] = "rent";
+	words[8] = "ceay";
+	assert(Shamir::similar_words(Shamir::word_list::slip39, "rent", 2).size() * Shamir::similar_words(Shamir::word_list::slip39, "ceay", 2).size() == 456);
+	assert(Shamir::try_repair_slip39_share(words, 2).error() == Shamir::status::share_checksum);
+	assert(words[5] == "rent");
+	words = Shamir::split_words(lines[0]);
+	words[0] = "qqqqqqqq";
+	assert(Shamir::try_repair_slip39_share(words, 2).error() == Shamir::status::unknown_slip39_word);
+	std::cout << "damaged shares repaired to the original bytes: passed" << std::endl;
+}
+
+/// a share passing its own checksum but carrying wrong data is caught when the set is merged
+void test_merge_repaired() {
+	const auto lines = fixed_shares();
+	std::vector<std::vector<uint8_t>> shares;
+	for (auto && line: lines) shares.push_back(Shamir::slip39_to_share(Shamir::split_words(line)));
+	assert(Shamir::try_merge_repaired(shares).value() == mnemonic);
+	assert(Shamir::try_merge_repaired(std::vector<std::vector<uint8_t>>(shares.begin(), shares.begin() + 3)).value() == mnemonic);
+
+	/// as a repair slipping through the share checksum would look
+	unsigned index, threshold;
+	std::vector<uint8_t> data(shares[2].size() - 4);
+	Shamir::parse_share(shares[2].data(), shares[2].size(), index, threshold, data.data());
+	data[3] ^= 0x20;
+	std::vector<uint8_t> wrong(shares[2].size());
+	Shamir::frame_share(index, threshold, data.data(), data.size(), wrong.data());
+	assert(Shamir::open_share_packet(wrong.data(), wrong.size(), index, threshold));
+	std::vector<std::vector<uint8_t>> set(shares.begin(), shares.begin() + 4);
+	set[2] = wrong;
+	assert(Shamir::try_merge_repaired(set).error() == Shamir::status::secret_checksum);
+	set.resize(3);
+	assert(Shamir::try_merge_repaired(set).error() == Shamir::status::secret_checksum);
+
+	set = std::vector<std::vector<uint8_t>>(shares.begin(), shares.begin() + 4);
+	set[1].push_back(0);
+	assert(Shamir::try_merge_repaired(set).error() == Shamir::status::different_lengths);
+	std::cout << "repaired share sets cross-checked: passed" << std::endl;
+}
+
+int main() {
+	try {
+		test_repair();
+		test_merge_repaired();
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
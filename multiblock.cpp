@@ -1,14 +1,130 @@
 #include <multiblock.h>
+#include <oneblockshamir.h>
+#include <get_insecure_randomness.h>
 #include <sha256.h>
+#include <byteorder.h>
 
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <cstring>
 #include <endian.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpufeatures.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+	const unsigned max_shares = 32;
+	/// columns whose random coefficients are drawn at once
+	const size_t coefficient_block = 64;
+	/// messages handed to SHA256Batch at once, a multiple of the widest lane count and at least max_shares
+	const size_t hash_group = 64;
+	/// longest packet whose checksum the batch reconstruction verifies in lanes, its hashed part is copied to the stack
+	const size_t max_batch_packet = 64;
+
+	/**
+	 * Share data sits in packets 10 bits off byte boundary: packing shifts the byte stream 2 bits right, parsing 2 bits left.
+	 * Vector kernels shift 16 bit words and mask the bits which crossed into the neighbouring byte, bits which cross
+	 * between bytes come from a second load one byte off; they return how many bytes they did, scalar code does the rest.
+	 */
+	/// scalar until detection ran, so framing during static initialization of other units is safe
+	Shamir::shift_implementation shift_kernels = Shamir::shift_implementation::scalar;
+
+#if defined(__x86_64__) || defined(__i386__)
+	__attribute__((target("avx2"))) size_t shift_left2_avx2(const uint8_t * in, size_t length, uint8_t * out) {
+		const __m256i high = _mm256_set1_epi8(static_cast<char>(0xfc)), low = _mm256_set1_epi8(3);
+		size_t j = 0;
+		for (; j + 32 <= length; j += 32) {
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + j));
+			const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + j + 1));
+			const __m256i r = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(a, 2), high), _mm256_and_si256(_mm256_srli_epi16(b, 6), low));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j), r);
+		}
+		return j;
+	}
+
+	__attribute__((target("avx2"))) size_t shift_right2_avx2(const uint8_t * in, size_t length, uint8_t * out) {
+		const __m256i high = _mm256_set1_epi8(static_cast<char>(0xc0)), low = _mm256_set1_epi8(0x3f);
+		size_t j = 0;
+		for (; j + 32 <= length; j += 32) {
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + j - 1));
+			const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + j));
+			const __m256i r = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(a, 6), high), _mm256_and_si256(_mm256_srli_epi16(b, 2), low));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j), r);
+		}
+		return j;
+	}
+
+	__attribute__((target("sse2"))) size_t shift_left2_sse2(const uint8_t * in, size_t length, uint8_t * out) {
+		const __m128i high = _mm_set1_epi8(static_cast<char>(0xfc)), low = _mm_set1_epi8(3);
+		size_t j = 0;
+		for (; j + 16 <= length; j += 16) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + j));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + j + 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), _mm_or_si128(_mm_and_si128(_mm_slli_epi16(a, 2), high), _mm_and_si128(_mm_srli_epi16(b, 6), low)));
+		}
+		return j;
+	}
+
+	__attribute__((target("sse2"))) size_t shift_right2_sse2(const uint8_t * in, size_t length, uint8_t * out) {
+		const __m128i high = _mm_set1_epi8(static_cast<char>(0xc0)), low = _mm_set1_epi8(0x3f);
+		size_t j = 0;
+		for (; j + 16 <= length; j += 16) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + j - 1));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + j));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), _mm_or_si128(_mm_and_si128(_mm_slli_epi16(a, 6), high), _mm_and_si128(_mm_srli_epi16(b, 2), low)));
+		}
+		return j;
+	}
+#endif
+
+	const Shamir::shift_implementation selected_shift = Shamir::select_shift();
+}
+
+namespace Shamir {
+	shift_implementation select_shift(shift_implementation widest) {
+		shift_kernels = shift_implementation::scalar;
+#if defined(__x86_64__) || defined(__i386__)
+		if (widest >= shift_implementation::avx2 && cpu_features::have_avx2()) shift_kernels = shift_implementation::avx2;
+		else if (widest >= shift_implementation::sse2 && cpu_features::have_sse2()) shift_kernels = shift_implementation::sse2;
+#endif
+		return shift_kernels;
+	}
+
+	void shift_left2(const uint8_t * in, size_t length, uint8_t * out) {
+		size_t j = 0;
+#if defined(__x86_64__) || defined(__i386__)
+		if (shift_kernels == shift_implementation::avx2) j = shift_left2_avx2(in, length, out);
+		else if (shift_kernels == shift_implementation::sse2) j = shift_left2_sse2(in, length, out);
+#endif
+		for (; j + 8 <= length; j += 8) store64be(out + j, load64be(in + j) << 2 | in[j + 8] >> 6);
+		for (; j < length; ++j) out[j] = static_cast<uint8_t>(in[j] << 2 | in[j + 1] >> 6);
+	}
+
+	void shift_right2(const uint8_t * in, size_t length, uint8_t * out) {
+		size_t j = 0;
+#if defined(__x86_64__) || defined(__i386__)
+		if (shift_kernels == shift_implementation::avx2) j = shift_right2_avx2(in, length, out);
+		else if (shift_kernels == shift_implementation::sse2) j = shift_right2_sse2(in, length, out);
+#endif
+		for (; j + 8 <= length; j += 8) store64be(out + j, load64be(in + j) >> 2 | static_cast<uint64_t>(in[j - 1]) << 62);
+		for (; j < length; ++j) out[j] = static_cast<uint8_t>(in[j - 1] << 6 | in[j] >> 2);
+	}
+}
+
 std::vector<uint8_t> checksummed16::serialize() const {
+	std::vector<uint8_t> output(this->size() + 2);
+	serialize(output.data());
+	return output;
+}
+
+void checksummed16::serialize(uint8_t * output) const {
 	CSHA256 h;
 	std::array<uint8_t, 32> hash;
-	std::vector<uint8_t> output(*this);
+	std::copy(this->begin(), this->end(), output);
+	output += this->size() - 1;
 
 	h.Write(this->data(), this->size());
 	h.Finalize(hash.data());
@@ -19,43 +135,31 @@ std::vector<uint8_t> checksummed16::serialize() const {
 	tmp = static_cast<uint16_t>(hash[0]);
 	tmp <<= ((8 - (data_bits % 8)) % 8);
 	tmp = htobe16(tmp);
-	output.back() |= tmps[0];
-	output.push_back(tmps[1]);
+	*output |= tmps[0];
+	*(++output) = tmps[1];
 
 	tmp = static_cast<uint16_t>(hash[1]);
 	tmp <<= ((8 - (data_bits % 8)) % 8);
 	tmp = htobe16(tmp);
-	output.back() |= tmps[0];
-	output.push_back(tmps[1]);
-	return output;
+	*output |= tmps[0];
+	*(++output) = tmps[1];
 }
 
 bool checksummed16::deserialize() {
 	if (this->size() < 3) return false;
-	std::vector<uint8_t> tmpv(*this);
-	uint32_t tmpchecksum;
-	uint8_t * tmparray = reinterpret_cast<uint8_t*>(&tmpchecksum);
-	auto it = tmpv.rbegin();
-	tmparray[3] = *it;
-	++it;
-	tmparray[2] = *it;
-	++it;
-	tmparray[1] = *it;
-	tmparray[0] = 0;
-	tmpchecksum = be32toh(tmpchecksum);
-	tmpchecksum >>= (8 - (data_bits % 8)) % 8;
-	tmpchecksum = htobe32(tmpchecksum);
-	tmpv.pop_back();
-	tmpv.pop_back();
-	const uint8_t masq = 255 << (8 - (data_bits % 8)) % 8;
-	tmpv.back() &= masq;
+	/// checksum occupies last 16 bits of data_bits, hash data before it in place, its last byte masked
+	const unsigned shift = (8 - (data_bits % 8)) % 8;
+	const uint8_t masq = 255 << shift;
+	const uint8_t * tail = this->data() + this->size() - 3;
+	const uint32_t checksum = (static_cast<uint32_t>(tail[0]) << 16 | static_cast<uint32_t>(tail[1]) << 8 | tail[2]) >> shift;
+	const uint8_t last = tail[0] & masq;
 	CSHA256 sha;
 	uint8_t checkhashverify[32];
-	sha.Write(tmpv.data(), tmpv.size());
+	sha.Write(this->data(), this->size() - 3);
+	sha.Write(&last, 1);
 	sha.Finalize(checkhashverify);
-	sha.Reset();
-	if (checkhashverify[0] != tmparray[2]) return false;
-	if (checkhashverify[1] != tmparray[3]) return false;
+	if (checkhashverify[0] != ((checksum >> 8) & 0xff)) return false;
+	if (checkhashverify[1] != (checksum & 0xff)) return false;
 
 	this->pop_back();
 	this->pop_back();
@@ -69,48 +173,327 @@ checksummed16::checksummed16(const std::vector<uint8_t> & data) : std::vector<ui
 	data_bits = data.size() * 8;
 }
 
-checksummed16::checksummed16(const std::vector<uint8_t> & data, size_t bits) : std::vector<uint8_t>(data) {
+checksummed16::checksummed16(const std::vector<uint8_t> & data, size_t bits) : checksummed16(data.data(), data.size(), bits) {
+}
+
+checksummed16::checksummed16(const uint8_t * data, size_t length) : std::vector<uint8_t>(data, data + length) {
+	data_bits = length * 8;
+}
+
+checksummed16::checksummed16(const uint8_t * data, size_t length, size_t bits) {
 	size_t bytes = bits / 8 + ((bits % 8 == 0) ? 0 : 1); 
-	if (data.size() * 8 < bits) throw "Too short data supplied for checksum";
-	this->resize(bytes); 
+	if (length * 8 < bits) throw "Too short data supplied for checksum";
+	this->assign(data, data + bytes); 
 	const uint8_t masq_last = 255u << (8 - (bits % 8)) % 8;
 	this->back() &= masq_last;
 	data_bits = bits;	
 }
 
-share::share(const std::vector<uint8_t> & p) {
-	if (p.size() < 5) throw "invalid share packet";
-	checksummed16 payload(p, p.size() * 8 - 6); /// verifies checksum
-	if (!payload.deserialize()) throw "checksum verification failed";
-	uint16_t overflower(0);
-	uint8_t * tmp_ar = reinterpret_cast<uint8_t *>(&overflower);
-	tmp_ar[0] = payload[0];
-	tmp_ar[1] = payload[1];
-	overflower = be16toh(overflower);
-	index = (overflower >> 11) + 1;
-	threshold = ((overflower >> 6) & 31) + 1;
-	for (size_t i = 2; i < payload.size(); ++i) {
-		tmp_ar[0] = payload[i - 1];
-		tmp_ar[1] = payload[i];
-		overflower = be16toh(overflower);
-		overflower <<= 2;
-		overflower = htobe16(overflower);
-		data.push_back(tmp_ar[0]);
-	}
+share::share(const std::vector<uint8_t> & p) : share(p.data(), p.size()) {
+}
+
+share::share(const uint8_t * p, size_t length) {
+	if (length < 5) throw "invalid share packet";
+	unsigned ind, thr;
+	data.resize(length - 4);
+	Shamir::check(Shamir::try_parse_share(p, length, ind, thr, data.data()));
+	index = ind;
+	threshold = thr;
 }
 
 checksummed16 Shamir::make_share(uint16_t index, uint16_t threshold, const std::vector<uint8_t> & data) {
-	uint16_t tmp_it = (index - 1) << 11;
-	tmp_it |= ((threshold - 1) & 31)  << 6;
-	tmp_it = htobe16(tmp_it);
-	uint8_t * tmp_array = reinterpret_cast<uint8_t *>(& tmp_it);
-	std::vector<uint8_t> wrapper;
-	wrapper.push_back(tmp_array[0]);
-	wrapper.push_back(tmp_array[1]);
-	for (auto i: data) {
-		tmp_it = htobe16(static_cast<uint16_t>(i) << 6);
-		wrapper.back() |= tmp_array[0];
-		wrapper.push_back(tmp_array[1]);
-	}
-	return checksummed16(wrapper, data.size()*8 + 10);
+	/// header and data bits, the byte after the last data byte holds its two low bits
+	const uint16_t header = static_cast<uint16_t>((index - 1) << 11 | ((threshold - 1) & 31) << 6);
+	std::vector<uint8_t> wrapper(data.size() + 2);
+	wrapper[0] = static_cast<uint8_t>(header >> 8);
+	wrapper[1] = static_cast<uint8_t>(header);
+	if (!data.empty()) {
+		wrapper[1] |= data[0] >> 2;
+		shift_right2(data.data() + 1, data.size() - 1, wrapper.data() + 2);
+		wrapper.back() = static_cast<uint8_t>(data.back() << 6);
+	}
+	return checksummed16(wrapper, data.size() * 8 + 10);
+}
+
+void Shamir::start_share_packet(uint8_t * packet, size_t columns, unsigned index, unsigned threshold) {
+	std::fill(packet, packet + columns + 4, 0);
+	const uint16_t header = ((index - 1) & 31) << 5 | ((threshold - 1) & 31);
+	packet[0] = header >> 2;
+	packet[1] = (header & 3) << 6;
+}
+
+void Shamir::seal_share_packet(uint8_t * packet, size_t columns) {
+	/// checksum covers header and data, i. e. columns + 2 bytes with the last one holding two bits
+	share_checksum checksum;
+	checksum.write(packet, columns + 1);
+	checksum.seal(packet + columns + 1);
+}
+
+void Shamir::seal_share_packet(uint8_t * packet, size_t columns, const uint8_t * hash) {
+	packet[columns + 1] |= hash[0] >> 2;
+	packet[columns + 2] = static_cast<uint8_t>(hash[0] << 6 | hash[1] >> 2);
+	packet[columns + 3] = static_cast<uint8_t>(hash[1] << 6);
+}
+
+bool Shamir::open_share_packet(const uint8_t * packet, size_t length, unsigned & index, unsigned & threshold) {
+	if (length < 5) return false;
+	const size_t columns = length - 4;
+	share_checksum checksum;
+	checksum.write(packet, columns + 1);
+	if (!checksum.check(packet + columns + 1)) return false;
+	read_share_header(packet, index, threshold);
+	return true;
+}
+
+bool Shamir::check_share_packet(const uint8_t * packet, size_t columns, const uint8_t * hash) {
+	return hash[0] == get_share_column(packet, columns) && hash[1] == get_share_column(packet, columns + 1);
+}
+
+namespace {
+	/// evaluates polynomials of all columns into unsealed packets, 'checksum' of the message gives the last two columns
+	void fill_packets(const uint8_t * msg, size_t length, const uint8_t * checksum, unsigned threshold, unsigned sharecount, uint8_t * shares,
+			size_t stride, const random_source & source = random_source()) {
+		const size_t columns = length + 2;
+		for (unsigned i = 0; i < sharecount; ++i) Shamir::start_share_packet(shares + i * stride, columns, i + 1, threshold);
+		const Shamir::evaluate_kernel evaluate_k = Shamir::evaluate_for(threshold);
+		uint8_t coefficients[coefficient_block * max_shares];
+		for (size_t block = 0; block < columns; block += coefficient_block) {
+			const size_t end = std::min(columns, block + coefficient_block);
+			random_fill(source, block * threshold, coefficients, (end - block) * threshold);
+			for (size_t j = block; j < end; ++j) {
+				uint8_t * c = coefficients + (j - block) * threshold;
+				c[0] = j < length ? msg[j] : checksum[j - length];
+				for (unsigned i = 0; i < sharecount; ++i) Shamir::put_share_column(shares + i * stride, j, evaluate_k(c, i + 1));
+			}
+		}
+		std::memset(coefficients, 0, sizeof(coefficients));
+	}
+
+	Shamir::status check_shape(size_t count, size_t share_length) {
+		if (share_length < 7) return Shamir::status::invalid_share;
+		if (count == 0) return Shamir::status::not_enough_shares;
+		if (count > max_shares) return Shamir::status::duplicate_indices; /// more indices than 5 bits can hold can not be distinct
+		return Shamir::status::ok;
+	}
+
+	/// checks headers of a set whose packets were verified, 'valid[i]' holds the result for packet i, and interpolates secret and its checksum columns
+	Shamir::status interpolate_packets(const uint8_t * shares, size_t count, size_t share_length, size_t stride, const bool * valid,
+			uint8_t * secret, uint8_t * expected) {
+		uint8_t xs[max_shares], ys[max_shares], weights[max_shares];
+		unsigned threshold(0);
+		/// set checks come in the order of the vector interface, so both report the same failure
+		for (size_t i = 0; i < count; ++i) {
+			unsigned index, t;
+			Shamir::read_share_header(shares + i * stride, index, t);
+			if (i > 0 && t != threshold) return Shamir::status::different_thresholds;
+			threshold = t;
+			xs[i] = index;
+		}
+		if (threshold > count) return Shamir::status::not_enough_shares;
+		for (size_t i = 0; i < count; ++i) {
+			for (size_t m = 0; m < i; ++m) {
+				if (xs[m] == xs[i]) return Shamir::status::duplicate_indices;
+			}
+		}
+		for (size_t i = 0; i < count; ++i) {
+			if (!valid[i]) return Shamir::status::share_checksum;
+		}
+		Shamir::lagrange_weights(xs, count, weights);
+		const Shamir::interpolate_kernel interpolate_k = Shamir::interpolate_for(count);
+
+		const size_t columns = share_length - 4, length = columns - 2;
+		for (size_t j = 0; j < columns; ++j) {
+			for (size_t i = 0; i < count; ++i) ys[i] = Shamir::get_share_column(shares + i * stride, j);
+			const uint8_t value = interpolate_k(weights, ys);
+			if (j < length) secret[j] = value;
+			else expected[j - length] = value;
+		}
+		return Shamir::status::ok;
+	}
+
+	Shamir::status compare_checksum(const uint8_t * checksum, const uint8_t * expected, uint8_t * secret, size_t length) {
+		if (checksum[0] != expected[0] || checksum[1] != expected[1]) {
+			std::memset(secret, 0, length);
+			return Shamir::status::secret_checksum;
+		}
+		return Shamir::status::ok;
+	}
+}
+
+void Shamir::distribute_packets(const uint8_t * msg, size_t length, unsigned threshold, unsigned sharecount, uint8_t * shares, size_t stride,
+		const random_source & source) {
+	uint8_t checksum[CSHA256::OUTPUT_SIZE];
+	CSHA256 h;
+	h.Write(msg, length);
+	h.Finalize(checksum);
+	fill_packets(msg, length, checksum, threshold, sharecount, shares, stride, source);
+	for (unsigned i = 0; i < sharecount; ++i) seal_share_packet(shares + i * stride, length + 2);
+}
+
+void Shamir::distribute_packets_batch(const uint8_t * msgs, size_t batch, size_t length, unsigned threshold, unsigned sharecount,
+		uint8_t * shares, size_t stride) {
+	const size_t columns = length + 2;
+	const unsigned char * data[hash_group];
+	size_t lengths[hash_group];
+	uint8_t hashes[hash_group * CSHA256::OUTPUT_SIZE];
+	for (size_t first = 0; first < batch; first += hash_group) {
+		const size_t n = std::min(hash_group, batch - first);
+		for (size_t b = 0; b < n; ++b) {
+			data[b] = msgs + (first + b) * length;
+			lengths[b] = length;
+		}
+		SHA256Batch(data, lengths, n, hashes);
+		for (size_t b = 0; b < n; ++b) {
+			fill_packets(data[b], length, hashes + b * CSHA256::OUTPUT_SIZE, threshold, sharecount, shares + (first + b) * sharecount * stride, stride);
+		}
+		/// packets of all secrets of the group are sealed together
+		uint8_t * packets = shares + first * sharecount * stride;
+		const size_t total = n * sharecount;
+		for (size_t p = 0; p < total; p += hash_group) {
+			const size_t m = std::min(hash_group, total - p);
+			for (size_t i = 0; i < m; ++i) {
+				data[i] = packets + (p + i) * stride;
+				lengths[i] = columns + 2;
+			}
+			SHA256Batch(data, lengths, m, hashes);
+			for (size_t i = 0; i < m; ++i) seal_share_packet(packets + (p + i) * stride, columns, hashes + i * CSHA256::OUTPUT_SIZE);
+		}
+	}
+	std::memset(hashes, 0, sizeof(hashes));
+}
+
+Shamir::status Shamir::reconstruct_packets(const uint8_t * shares, size_t count, size_t share_length, size_t stride, uint8_t * secret) {
+	const status shape = check_shape(count, share_length);
+	if (shape != status::ok) return shape;
+	bool valid[max_shares];
+	for (size_t i = 0; i < count; ++i) {
+		unsigned index, t;
+		valid[i] = open_share_packet(shares + i * stride, share_length, index, t);
+	}
+	uint8_t expected[2];
+	const status interpolated = interpolate_packets(shares, count, share_length, stride, valid, secret, expected);
+	if (interpolated != status::ok) return interpolated;
+	const size_t length = share_length - 6;
+	uint8_t checksum[CSHA256::OUTPUT_SIZE];
+	CSHA256 h;
+	h.Write(secret, length);
+	h.Finalize(checksum);
+	return compare_checksum(checksum, expected, secret, length);
+}
+
+void Shamir::reconstruct_packets_batch(const uint8_t * shares, size_t batch, size_t count, size_t share_length, size_t stride,
+		uint8_t * secrets, status * statuses) {
+	const status shape = check_shape(count, share_length);
+	/// packets are copied to be hashed with their checksum bits masked, so long ones are verified one set after another
+	if (shape != status::ok || share_length > max_batch_packet) {
+		for (size_t b = 0; b < batch; ++b) {
+			statuses[b] = reconstruct_packets(shares + b * count * stride, count, share_length, stride, secrets + b * (share_length - 6));
+		}
+		return;
+	}
+	const size_t columns = share_length - 4, length = share_length - 6;
+	const size_t group = hash_group / count; /// share sets whose packets fit into one call
+	uint8_t scratch[hash_group * max_batch_packet];
+	const unsigned char * data[hash_group];
+	size_t lengths[hash_group];
+	uint8_t hashes[hash_group * CSHA256::OUTPUT_SIZE];
+	uint8_t expected[hash_group][2];
+	bool valid[hash_group];
+	for (size_t first = 0; first < batch; first += group) {
+		const size_t n = std::min(group, batch - first), total = n * count;
+		const uint8_t * packets = shares + first * count * stride;
+		for (size_t i = 0; i < total; ++i) {
+			uint8_t * input = scratch + i * max_batch_packet;
+			std::memcpy(input, packets + i * stride, columns + 2);
+			input[columns + 1] &= 0xc0;
+			data[i] = input;
+			lengths[i] = columns + 2;
+		}
+		SHA256Batch(data, lengths, total, hashes);
+		for (size_t i = 0; i < total; ++i) valid[i] = check_share_packet(packets + i * stride, columns, hashes + i * CSHA256::OUTPUT_SIZE);
+		size_t interpolated = 0;
+		for (size_t b = 0; b < n; ++b) {
+			uint8_t * secret = secrets + (first + b) * length;
+			statuses[first + b] = interpolate_packets(packets + b * count * stride, count, share_length, stride, valid + b * count, secret, expected[b]);
+			/// secrets of failed sets are hashed as empty messages
+			const bool ok = statuses[first + b] == status::ok;
+			data[b] = secret;
+			lengths[b] = ok ? length : 0;
+			if (ok) ++interpolated;
+		}
+		if (interpolated > 0) SHA256Batch(data, lengths, n, hashes);
+		for (size_t b = 0; b < n; ++b) {
+			if (statuses[first + b] != status::ok) continue;
+			statuses[first + b] = compare_checksum(hashes + b * CSHA256::OUTPUT_SIZE, expected[b], secrets + (first + b) * length, length);
+		}
+	}
+	std::memset(scratch, 0, sizeof(scratch));
+	std::memset(hashes, 0, sizeof(hashes));
+}
+
+void Shamir::frame_share(unsigned index, unsigned threshold, const uint8_t * data, size_t length, uint8_t * packet) {
+	share_framer framer(index, threshold);
+	framer.finish(packet + framer.put(data, length, packet));
+}
+
+void Shamir::share_checksum::seal(uint8_t * tail) {
+	uint8_t hash[CSHA256::OUTPUT_SIZE];
+	const uint8_t last = tail[0] & 0xc0;
+	m_hash.Write(&last, 1);
+	m_hash.Finalize(hash);
+	tail[0] = static_cast<uint8_t>(last | hash[0] >> 2);
+	tail[1] = static_cast<uint8_t>(hash[0] << 6 | hash[1] >> 2);
+	tail[2] = static_cast<uint8_t>(hash[1] << 6);
+}
+
+bool Shamir::share_checksum::check(const uint8_t * tail) {
+	uint8_t hash[CSHA256::OUTPUT_SIZE];
+	const uint8_t last = tail[0] & 0xc0;
+	m_hash.Write(&last, 1);
+	m_hash.Finalize(hash);
+	return hash[0] == static_cast<uint8_t>(tail[0] << 2 | tail[1] >> 6) && hash[1] == static_cast<uint8_t>(tail[1] << 2 | tail[2] >> 6);
+}
+
+Shamir::share_framer::share_framer(unsigned index, unsigned threshold) : m_started(false) {
+	const uint16_t header = ((index - 1) & 31) << 5 | ((threshold - 1) & 31);
+	m_header = static_cast<uint8_t>(header >> 2);
+	m_pending = static_cast<uint8_t>((header & 3) << 6);
+}
+
+size_t Shamir::share_framer::start(uint8_t * out) {
+	if (m_started) return 0;
+	m_started = true;
+	out[0] = m_header;
+	m_checksum.write(out, 1);
+	return 1;
+}
+
+size_t Shamir::share_framer::put(const uint8_t * data, size_t length, uint8_t * out) {
+	const size_t header = start(out);
+	if (length == 0) return header;
+	uint8_t * bytes = out + header;
+	bytes[0] = static_cast<uint8_t>(m_pending | data[0] >> 2);
+	shift_right2(data + 1, length - 1, bytes + 1);
+	m_pending = static_cast<uint8_t>(data[length - 1] << 6);
+	m_checksum.write(bytes, length);
+	return header + length;
+}
+
+size_t Shamir::share_framer::finish(uint8_t * out) {
+	const size_t header = start(out);
+	uint8_t * tail = out + header;
+	tail[0] = m_pending;
+	m_checksum.seal(tail);
+	return header + 3;
+}
+
+Shamir::status Shamir::try_parse_share(const uint8_t * packet, size_t length, unsigned & index, unsigned & threshold, uint8_t * data) {
+	if (length < 5) return status::invalid_share;
+	if (!open_share_packet(packet, length, index, threshold)) return status::share_checksum;
+	shift_left2(packet + 1, length - 4, data);
+	return status::ok;
+}
+
+void Shamir::parse_share(const uint8_t * packet, size_t length, unsigned & index, unsigned & threshold, uint8_t * data) {
+	check(try_parse_share(packet, length, index, threshold, data));
 }
@@ -1,8 +1,13 @@
 #ifndef MULTIBLOCK
 #define MULTIBLOCK
 
+#include <shamirstatus.h>
+#include <get_insecure_randomness.h>
+#include <sha256.h>
+
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 /**
  * holds data with length 'data_bits' bits in a vector,
@@ -16,8 +21,11 @@ class checksummed16: public std::vector<uint8_t> {
 	public:
 		checksummed16(const std::vector<uint8_t> & data);
 		checksummed16(const std::vector<uint8_t> & data, size_t bits);
+		checksummed16(const uint8_t * data, size_t length);
+		checksummed16(const uint8_t * data, size_t length, size_t bits);
 		std::vector<uint8_t> serialize() const; // returns data with 16bit checksum appended
-		bool deserialize(); // checks if last 16 bits is valid checksum and removes it from data if so.
+		void serialize(uint8_t * output) const; // writes data with 16bit checksum appended, i. e. size() + 2 bytes, to output
+		bool deserialize(); // checks if last 16 bits is valid checksum and removes it from data if so, hashes in place.
 		size_t getLength() const { return data_bits; }
 };
 
@@ -31,10 +39,107 @@ struct share {
 		uint16_t index, threshold;
 		std::vector<uint8_t> data;
 		share(const std::vector<uint8_t> & p);
+		share(const uint8_t * p, size_t length);
 };
 
 namespace Shamir {
 	checksummed16 make_share(uint16_t index, uint16_t threshold, const std::vector<uint8_t> & data);
+	/// frames 'length' data bytes into packet of length + 4 bytes, same bytes as make_share(...).serialize() without intermediate copies
+	void frame_share(unsigned index, unsigned threshold, const uint8_t * data, size_t length, uint8_t * packet);
+	/// verifies packet of 'length' bytes in place and writes its length - 4 data bytes to 'data', throws as share constructor does
+	void parse_share(const uint8_t * packet, size_t length, unsigned & index, unsigned & threshold, uint8_t * data);
+	status try_parse_share(const uint8_t * packet, size_t length, unsigned & index, unsigned & threshold, uint8_t * data);
+
+	/// share data sits 2 bits off byte boundary in a packet: framing shifts it right, parsing left
+	/// out[j] = in[j] << 2 | in[j + 1] >> 6 for j < length, reads in[0] .. in[length]
+	void shift_left2(const uint8_t * in, size_t length, uint8_t * out);
+	/// out[j] = in[j - 1] << 6 | in[j] >> 2 for j < length, reads in[-1] .. in[length - 1]
+	void shift_right2(const uint8_t * in, size_t length, uint8_t * out);
+	enum class shift_implementation { scalar, sse2, avx2 };
+	/**
+	 * selects the widest shift kernel the CPU supports up to 'widest' and returns it. Runs automatically at
+	 * startup; calling it again is meant for tests and benchmarks and must not race with framing or parsing.
+	 */
+	shift_implementation select_shift(shift_implementation widest = shift_implementation::avx2);
+
+	/**
+	 * allocation free access to share packet of 'columns' data bytes, i. e. columns + 4 bytes long:
+	 * 10 bits header, data bytes, 16 bits checksum, 6 zero bits.
+	 * Packet is started with header, filled column by column and sealed with checksum at last.
+	 */
+	void start_share_packet(uint8_t * packet, size_t columns, unsigned index, unsigned threshold);
+	inline void put_share_column(uint8_t * packet, size_t column, uint8_t value) {
+		packet[column + 1] |= value >> 2;
+		packet[column + 2] |= static_cast<uint8_t>(value << 6);
+	}
+	void seal_share_packet(uint8_t * packet, size_t columns);
+	/// seals with SHA256 'hash' of first columns + 2 bytes of the packet, for callers hashing it while it is being filled
+	void seal_share_packet(uint8_t * packet, size_t columns, const uint8_t * hash);
+	/// verifies checksum of the packet and reads its header, false if packet is invalid
+	bool open_share_packet(const uint8_t * packet, size_t length, unsigned & index, unsigned & threshold);
+	/// compares checksum of the packet with SHA256 'hash' of its first columns + 1 bytes and header and data bits of the next one
+	bool check_share_packet(const uint8_t * packet, size_t columns, const uint8_t * hash);
+	/**
+	 * allocation free split of 'length' bytes into 'sharecount' packets of length + 6 bytes placed 'stride' bytes apart.
+	 * Caller validates parameters: length > 0, 1 <= threshold <= sharecount <= 32.
+	 */
+	void distribute_packets(const uint8_t * msg, size_t length, unsigned threshold, unsigned sharecount, uint8_t * shares, size_t stride,
+			const random_source & source = random_source());
+	/**
+	 * distribute_packets for 'batch' secrets stored one after another, packets of secret b start at shares + b * sharecount * stride.
+	 * Checksums of secrets and packets are computed by SHA256Batch, many messages side by side. Coefficients come from the default source.
+	 */
+	void distribute_packets_batch(const uint8_t * msgs, size_t batch, size_t length, unsigned threshold, unsigned sharecount,
+			uint8_t * shares, size_t stride);
+	/// allocation free reconstruction from 'count' packets of 'share_length' bytes placed 'stride' bytes apart, secret gets share_length - 6 bytes
+	status reconstruct_packets(const uint8_t * shares, size_t count, size_t share_length, size_t stride, uint8_t * secret);
+	/**
+	 * reconstruct_packets for 'batch' sets of 'count' packets, set b starts at shares + b * count * stride, its secret at
+	 * secrets + b * (share_length - 6) and its result in statuses[b]. Checksums are verified by SHA256Batch.
+	 */
+	void reconstruct_packets_batch(const uint8_t * shares, size_t batch, size_t count, size_t share_length, size_t stride,
+			uint8_t * secrets, status * statuses);
+	inline void read_share_header(const uint8_t * packet, unsigned & index, unsigned & threshold) {
+		index = (packet[0] >> 3) + 1;
+		threshold = ((packet[0] & 7) << 2 | packet[1] >> 6) + 1;
+	}
+	inline uint8_t get_share_column(const uint8_t * packet, size_t column) {
+		return static_cast<uint8_t>(packet[column + 1] << 2 | packet[column + 2] >> 6);
+	}
+
+	/**
+	 * checksum of a share packet computed while its bytes pass by: packet bytes 0 .. columns are written
+	 * in chunks of any size, the last three bytes (two data bits, 16 checksum bits, 6 zero bits) are
+	 * handled by seal or check, which mask the data bits as checksummed16 does.
+	 */
+	class share_checksum {
+		private:
+			CSHA256 m_hash;
+		public:
+			void write(const uint8_t * bytes, size_t length) { m_hash.Write(bytes, length); }
+			/// 'tail' is packet + columns + 1 with the last data bits in place, checksum bits are filled in
+			void seal(uint8_t * tail);
+			/// verifies checksum bits of 'tail', i. e. packet + columns + 1
+			bool check(const uint8_t * tail);
+	};
+
+	/**
+	 * frames share data streamed chunk by chunk into the bytes frame_share produces, hashing them on the way,
+	 * so neither the data nor the packet has to be in memory as a whole.
+	 */
+	class share_framer {
+		private:
+			share_checksum m_checksum;
+			uint8_t m_header, m_pending; /// first packet byte and upper two bits of the next one
+			bool m_started;
+			size_t start(uint8_t * out);
+		public:
+			share_framer(unsigned index, unsigned threshold);
+			/// writes packet bytes completed by 'length' data bytes to 'out' and returns their count: length, plus one for header at the first call
+			size_t put(const uint8_t * data, size_t length, uint8_t * out);
+			/// writes the last bytes of the packet, 3 or 4 if nothing was put, and returns their count
+			size_t finish(uint8_t * out);
+	};
 }
 
 #endif
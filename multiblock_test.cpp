@@ -54,10 +54,106 @@ void check_parser() {
 	}
 }
 
+/// view based framing and parsing give the same packets and data as the vector based classes
+void check_views() {
+	for (size_t length: {1ul, 2ul, 3ul, 9ul, 16ul, 17ul, 31ul, 32ul, 33ul, 41ul, 64ul, 75ul, 1ul << 20}) {
+		std::vector<uint8_t> data(length);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t) (i * 7 % 251);
+		std::vector<uint8_t> packet(length + 4);
+		Shamir::frame_share(5, 3, data.data(), data.size(), packet.data());
+		assert(packet == Shamir::make_share(5, 3, data).serialize());
+
+		unsigned index, threshold;
+		std::vector<uint8_t> parsed(length);
+		Shamir::parse_share(packet.data(), packet.size(), index, threshold, parsed.data());
+		assert(index == 5 && threshold == 3 && parsed == data);
+		share sss(packet);
+		assert(sss.index == 5 && sss.threshold == 3 && sss.data == data);
+
+		checksummed16 framed(packet, packet.size() * 8 - 6);
+		assert(framed.deserialize());
+		packet[length / 2 + 1] ^= 0x10;
+		try {
+			Shamir::parse_share(packet.data(), packet.size(), index, threshold, parsed.data());
+			assert(false);
+		} catch (const char * s) {
+			assert(std::string(s) == "checksum verification failed");
+		}
+	}
+}
+
+/// every shift kernel agrees byte by byte with the plain definition, for lengths around the vector widths and odd alignments
+void check_shift_kernels() {
+	std::vector<uint8_t> in(1 + 300 + 1);
+	for (size_t i = 0; i < in.size(); ++i) in[i] = (uint8_t) (i * 97 + 13);
+	for (auto widest: {Shamir::shift_implementation::scalar, Shamir::shift_implementation::sse2, Shamir::shift_implementation::avx2}) {
+		const auto selected = Shamir::select_shift(widest);
+		if (selected != widest) {
+			std::cout << "shift kernel " << static_cast<int>(widest) << " not supported by this CPU, skipped" << std::endl;
+			continue;
+		}
+		for (size_t offset = 1; offset < 4; ++offset) {
+			for (size_t length = 0; length + offset + 1 < in.size(); ++length) {
+				const uint8_t * from = in.data() + offset;
+				std::vector<uint8_t> left(length + 1, 0xa5), right(length + 1, 0xa5);
+				Shamir::shift_left2(from, length, left.data());
+				Shamir::shift_right2(from, length, right.data());
+				for (size_t j = 0; j < length; ++j) {
+					assert(left[j] == (uint8_t) (from[j] << 2 | from[j + 1] >> 6));
+					assert(right[j] == (uint8_t) (from[j - 1] << 6 | from[j] >> 2));
+				}
+				assert(left[length] == 0xa5 && right[length] == 0xa5);
+			}
+		}
+		/// data bits sit right after the 10 header bits of a framed packet
+		std::vector<uint8_t> data(in.begin(), in.begin() + 77), packet(data.size() + 4), parsed(data.size());
+		Shamir::frame_share(7, 2, data.data(), data.size(), packet.data());
+		for (size_t bit = 0; bit < data.size() * 8; ++bit) {
+			assert(((packet[(bit + 10) / 8] >> (7 - (bit + 10) % 8)) & 1) == ((data[bit / 8] >> (7 - bit % 8)) & 1));
+		}
+		unsigned index, threshold;
+		Shamir::parse_share(packet.data(), packet.size(), index, threshold, parsed.data());
+		assert(index == 7 && threshold == 2 && parsed == data);
+	}
+	Shamir::select_shift();
+	std::cout << "shift kernels match the per byte definition: passed" << std::endl;
+}
+
+/// data framed chunk by chunk gives the packet frame_share makes, packet checked chunk by chunk is accepted until a bit flips
+void check_stream() {
+	for (size_t length: {0ul, 1ul, 2ul, 17ul, 1000ul}) {
+		std::vector<uint8_t> data(length);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t) (i * 11 % 253);
+		std::vector<uint8_t> expected(length + 4);
+		if (length > 0) Shamir::frame_share(9, 4, data.data(), data.size(), expected.data());
+		for (size_t chunk: {1ul, 3ul, 64ul}) {
+			std::vector<uint8_t> packet(length + 4);
+			Shamir::share_framer framer(9, 4);
+			size_t written = 0;
+			for (size_t j = 0; j < length; j += chunk) written += framer.put(data.data() + j, std::min(chunk, length - j), packet.data() + written);
+			written += framer.finish(packet.data() + written);
+			assert(written == packet.size());
+			if (length == 0) continue;
+			assert(packet == expected);
+
+			Shamir::share_checksum checksum;
+			for (size_t j = 0; j <= length; j += chunk) checksum.write(packet.data() + j, std::min(chunk, length + 1 - j));
+			assert(checksum.check(packet.data() + length + 1));
+			packet[length + 1] ^= 0x40;
+			Shamir::share_checksum corrupted;
+			corrupted.write(packet.data(), length + 1);
+			assert(!corrupted.check(packet.data() + length + 1));
+		}
+	}
+}
+
 int main() {
 	try {
 		check_big();
 		check_parser();
+		check_views();
+		check_shift_kernels();
+		check_stream();
 	} catch (const char *s) {
 		std::cout << s << std::endl;
 	}
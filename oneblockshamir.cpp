@@ -5,6 +5,67 @@
 #include <vector>
 #include <cstdint>
 
+namespace {
+	/// c[0] + x (c[1] + x (... + x c[K - 1])): Horner's scheme expanded by the compiler, I coefficients left, x given by its logarithm
+	template <unsigned I>
+	struct horner {
+		static uint8_t apply(uint8_t acc, const uint8_t * c, uint8_t log_x) {
+			return horner<I - 1>::apply(GF256::multiply_log(acc, log_x) ^ c[I - 1], c, log_x);
+		}
+	};
+
+	template <>
+	struct horner<0> {
+		static uint8_t apply(uint8_t acc, const uint8_t *, uint8_t) { return acc; }
+	};
+
+	/// Sum(w[j] * y[j]) for j < I
+	template <unsigned I>
+	struct dot {
+		static uint8_t apply(const uint8_t * w, const uint8_t * y) {
+			return dot<I - 1>::apply(w, y) ^ GF256::multiply(w[I - 1], y[I - 1]);
+		}
+	};
+
+	template <>
+	struct dot<0> {
+		static uint8_t apply(const uint8_t *, const uint8_t *) { return 0; }
+	};
+
+	template <unsigned K>
+	uint8_t evaluate_unrolled(const uint8_t * coefficients, uint8_t x) {
+		if (x == 0) return coefficients[0];
+		return horner<K - 1>::apply(coefficients[K - 1], coefficients, GF256::logarithm(x));
+	}
+
+	template <unsigned K>
+	uint8_t interpolate_unrolled(const uint8_t * weights, const uint8_t * ys) {
+		return dot<K>::apply(weights, ys);
+	}
+
+	const Shamir::evaluate_kernel evaluate_kernels[32] = {
+		evaluate_unrolled<1>, evaluate_unrolled<2>, evaluate_unrolled<3>, evaluate_unrolled<4>,
+		evaluate_unrolled<5>, evaluate_unrolled<6>, evaluate_unrolled<7>, evaluate_unrolled<8>,
+		evaluate_unrolled<9>, evaluate_unrolled<10>, evaluate_unrolled<11>, evaluate_unrolled<12>,
+		evaluate_unrolled<13>, evaluate_unrolled<14>, evaluate_unrolled<15>, evaluate_unrolled<16>,
+		evaluate_unrolled<17>, evaluate_unrolled<18>, evaluate_unrolled<19>, evaluate_unrolled<20>,
+		evaluate_unrolled<21>, evaluate_unrolled<22>, evaluate_unrolled<23>, evaluate_unrolled<24>,
+		evaluate_unrolled<25>, evaluate_unrolled<26>, evaluate_unrolled<27>, evaluate_unrolled<28>,
+		evaluate_unrolled<29>, evaluate_unrolled<30>, evaluate_unrolled<31>, evaluate_unrolled<32>
+	};
+
+	const Shamir::interpolate_kernel interpolate_kernels[32] = {
+		interpolate_unrolled<1>, interpolate_unrolled<2>, interpolate_unrolled<3>, interpolate_unrolled<4>,
+		interpolate_unrolled<5>, interpolate_unrolled<6>, interpolate_unrolled<7>, interpolate_unrolled<8>,
+		interpolate_unrolled<9>, interpolate_unrolled<10>, interpolate_unrolled<11>, interpolate_unrolled<12>,
+		interpolate_unrolled<13>, interpolate_unrolled<14>, interpolate_unrolled<15>, interpolate_unrolled<16>,
+		interpolate_unrolled<17>, interpolate_unrolled<18>, interpolate_unrolled<19>, interpolate_unrolled<20>,
+		interpolate_unrolled<21>, interpolate_unrolled<22>, interpolate_unrolled<23>, interpolate_unrolled<24>,
+		interpolate_unrolled<25>, interpolate_unrolled<26>, interpolate_unrolled<27>, interpolate_unrolled<28>,
+		interpolate_unrolled<29>, interpolate_unrolled<30>, interpolate_unrolled<31>, interpolate_unrolled<32>
+	};
+} // anonymous namespace
+
 
 void GFpolynomial::polyInit(size_t _degree) {
 	m_coefficients.resize(_degree + 1);
@@ -59,3 +120,38 @@ Shamir::xy_point GFpolynomial::getShare(int _index) const {
 	}
 	return Shamir::xy_point(index.octet(), result.octet());
 }
+
+uint8_t Shamir::evaluate(const uint8_t * coefficients, unsigned count, uint8_t x) {
+	if (count == 0) return 0;
+	GF256 result(coefficients[count - 1]);
+	const GF256 point(x);
+	for (unsigned i = count - 1; i-- > 0; ) result = result * point + GF256(coefficients[i]);
+	return result.octet();
+}
+
+void Shamir::lagrange_weights(const uint8_t * xs, unsigned count, uint8_t * weights) {
+	for (unsigned j = 0; j < count; ++j) {
+		GF256 tmp(1);
+		for (unsigned m = 0; m < count; ++m) {
+			if (m == j) continue;
+			tmp = tmp * GF256(xs[m]) / (GF256(xs[j]) - GF256(xs[m]));
+		}
+		weights[j] = tmp.octet();
+	}
+}
+
+uint8_t Shamir::interpolate(const uint8_t * weights, const uint8_t * ys, unsigned count) {
+	GF256 result(0);
+	for (unsigned j = 0; j < count; ++j) result = result + GF256(weights[j]) * GF256(ys[j]);
+	return result.octet();
+}
+
+Shamir::evaluate_kernel Shamir::evaluate_for(unsigned count) {
+	if (count < 1 || count > 32) throw "invalid polynomial degree";
+	return evaluate_kernels[count - 1];
+}
+
+Shamir::interpolate_kernel Shamir::interpolate_for(unsigned count) {
+	if (count < 1 || count > 32) throw "Invalid shamir share set";
+	return interpolate_kernels[count - 1];
+}
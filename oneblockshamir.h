@@ -31,5 +31,20 @@ class GFpolynomial
 		uint8_t			getSecret() const;
 };
 
+namespace Shamir
+{
+	/// value of polynomial coefficients[0] + coefficients[1] x + ... at x, Horner's scheme
+	uint8_t evaluate(const uint8_t * coefficients, unsigned count, uint8_t x);
+	/// weights[j] = l_j(0) of Lagrange basis through distinct non-zero xs, so secret is Sum(weights[j] * y_j)
+	void lagrange_weights(const uint8_t * xs, unsigned count, uint8_t * weights);
+	uint8_t interpolate(const uint8_t * weights, const uint8_t * ys, unsigned count);
+
+	/// evaluate and interpolate unrolled for fixed count (threshold 1 .. 32), looked up in a jump table once per share set
+	typedef uint8_t (*evaluate_kernel)(const uint8_t * coefficients, uint8_t x);
+	typedef uint8_t (*interpolate_kernel)(const uint8_t * weights, const uint8_t * ys);
+	evaluate_kernel evaluate_for(unsigned count);
+	interpolate_kernel interpolate_for(unsigned count);
+} // Shamir namespace
+
 
 #endif
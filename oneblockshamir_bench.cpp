@@ -0,0 +1,49 @@
+#include <oneblockshamir.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+/**
+ * compares threshold specialized kernels with the generic loops over the same columns.
+ * Usage: oneblockshamir_bench [columns] [rounds]
+ */
+int main(int argc, const char * argv[]) {
+	const size_t columns = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+	const unsigned rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+	std::vector<uint8_t> coefficients(columns * 32);
+	for (size_t i = 0; i < coefficients.size(); ++i) coefficients[i] = (uint8_t) (i * 131 + 7);
+	uint8_t xs[32], weights[32];
+	for (unsigned i = 0; i < 32; ++i) xs[i] = i + 1;
+	unsigned sink(0);
+
+	std::cout << "threshold  evaluate generic / unrolled (ns per share byte)  interpolate generic / unrolled (ns per secret byte)" << std::endl;
+	for (unsigned k: {2u, 3u, 5u, 8u, 16u, 32u}) {
+		const unsigned count = k == 32 ? 32 : k + 2; /// e.g. 2 of 4, 3 of 5
+		const Shamir::evaluate_kernel evaluate = Shamir::evaluate_for(k);
+		const Shamir::interpolate_kernel interpolate = Shamir::interpolate_for(k);
+		Shamir::lagrange_weights(xs, k, weights);
+		double results[4];
+		for (int variant = 0; variant < 4; ++variant) {
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned r = 0; r < rounds; ++r) {
+				for (size_t j = 0; j < columns; ++j) {
+					const uint8_t * c = coefficients.data() + j * 32;
+					switch (variant) {
+						case 0: for (unsigned i = 1; i <= count; ++i) sink += Shamir::evaluate(c, k, i); break;
+						case 1: for (unsigned i = 1; i <= count; ++i) sink += evaluate(c, i); break;
+						case 2: sink += Shamir::interpolate(weights, c, k); break;
+						case 3: sink += interpolate(weights, c); break;
+					}
+				}
+			}
+			std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+			results[variant] = elapsed.count() / rounds / columns / (variant < 2 ? count : 1);
+		}
+		std::cout << std::setw(9) << k << std::fixed << std::setprecision(2) << std::setw(18) << results[0] << " / " << results[1]
+			<< std::setw(36) << results[2] << " / " << results[3] << std::endl;
+	}
+	return sink == 0xffffffff;
+}
@@ -86,7 +86,7 @@ void test0()
 #endif
 	for ( int i=0; i<100; ++i) {
 		std::shuffle(shares.begin(), shares.end(), gen);
-		std::for_each( shares.begin(), shares.begin() + share_threshold, [&reconstr] (auto ii) {reconstr.push_back(ii);});
+		std::for_each( shares.begin(), shares.begin() + share_threshold, [&reconstr] (const Shamir::xy_point & ii) {reconstr.push_back(ii);});
 		GFpolynomial restored_secret(reconstr);
 #ifdef HARDCODED
 		assert(restored_secret.getSecret() == 0x40);
@@ -111,9 +111,41 @@ void test1() {
 	assert(p2.getSecret() == 49);
 }
 
+/**
+ * unrolled kernels of every threshold give the same values as the generic loops
+ * and evaluating at share indices followed by interpolation restores the secret.
+ */
+void test_kernels() {
+	std::default_random_engine gen(554433);
+	std::uniform_int_distribution<int> byte(0, 255);
+	for (unsigned k = 1; k <= 32; ++k) {
+		const Shamir::evaluate_kernel evaluate = Shamir::evaluate_for(k);
+		const Shamir::interpolate_kernel interpolate = Shamir::interpolate_for(k);
+		for (int round = 0; round < 20; ++round) {
+			uint8_t coefficients[32], xs[32], ys[32], weights[32];
+			for (unsigned i = 0; i < k; ++i) coefficients[i] = byte(gen);
+			for (unsigned i = 0; i < k; ++i) {
+				xs[i] = 32 - i - round % 2;
+				ys[i] = evaluate(coefficients, xs[i]);
+				assert(ys[i] == Shamir::evaluate(coefficients, k, xs[i]));
+			}
+			Shamir::lagrange_weights(xs, k, weights);
+			assert(interpolate(weights, ys) == Shamir::interpolate(weights, ys, k));
+			assert(interpolate(weights, ys) == coefficients[0]);
+		}
+	}
+	try {
+		Shamir::evaluate_for(33);
+		assert(false);
+	} catch (const char * s) {
+		assert(0 == std::strcmp(s, "invalid polynomial degree"));
+	}
+}
+
 int main() {
 	test0();
 	test1();
+	test_kernels();
 	std::cout << "ok" << std::endl;
 	return 0;
 }
@@ -14,9 +14,11 @@ namespace {
 	}
 } // anonymous namespace
 
-/// static members initialization
-bool GF256::multiplication_table_initialized(false);
+/// static members initialization, table is built before main() so that threads never race on it
 std::array<uint8_t, 255> GF256::powers;
+std::array<uint8_t, 256> GF256::logarithms;
+std::array<uint8_t, 510> GF256::exponents;
+bool GF256::multiplication_table_initialized((GF256::group_0XE5_multiplication_table_initialization(), true));
 
 /**
  * Generation of Rijndael field multiplication table with generator 0xe5
@@ -28,24 +30,17 @@ void GF256::group_0XE5_multiplication_table_initialization() {
 	uint8_t tmp_field_element(0x01);
 	for (int i=0; i<255; ++i) {
 		powers[i] = tmp_field_element;
+		logarithms[tmp_field_element] = i;
+		exponents[i] = exponents[i + 255] = tmp_field_element;
 		tmp_field_element = russian_peasant_multiplication(tmp_field_element, generator);
 	}
 	if ( tmp_field_element != 1 )
 		throw "Rijndael's field table construction failed failed";
 }
 
-GF256::GF256() : element(0) {
-        if (!multiplication_table_initialized) {
-                group_0XE5_multiplication_table_initialization();
-                multiplication_table_initialized = true;
-        }
-}
-
-GF256::GF256(const uint8_t _element) : element(_element) {
-        if (!multiplication_table_initialized) {
-                group_0XE5_multiplication_table_initialization();
-                multiplication_table_initialized = true;
-        }
+void GF256::init_table() {
+        group_0XE5_multiplication_table_initialization();
+        multiplication_table_initialized = true;
 }
 
 std::ostream & operator << ( std::ostream & ost, const GF256 & x ) {
@@ -55,26 +50,10 @@ std::ostream & operator << ( std::ostream & ost, const GF256 & x ) {
 	return ost;
 }
 
-GF256	GF256::operator * (const GF256 & x) const {
-        return GF256(russian_peasant_multiplication(element, x.element));
-}
-
 GF256   GF256::inversion() const {
         if ( element == 0 )
                 throw "Zero element can't be inverted\n";
-        uint8_t dlog;
-        bool    dlogSet(false);
-        for (uint8_t i=0; i<255; ++i)
-        {
-                if ( powers[i] == element )
-                {
-                        dlogSet = true;
-                        dlog = i;
-			break;
-                }
-        }
-        if (!dlogSet) throw "some error in field inversion: DLog hasn't been found\n";
-        return GF256(powers[(255-dlog) % 255]);
+        return GF256(exponents[255 - logarithms[element]]);
 }
 
 /**
@@ -86,25 +65,7 @@ GF256   GF256::operator / (const GF256 & x) const
                 throw "Division by zero";
         if ( element == 0 )
                 return GF256(0);
-
-        uint8_t log1(0), log2(0);
-        bool log1set(false), log2set(false);
-        for (size_t i=0; i<powers.size(); ++i)
-        {
-                if (element == powers[i])
-                {
-                        log1set = true;
-                        log1 = i;
-                }
-                if (x.element == powers[i])
-                {
-                        log2set = true;
-                        log2 = i;
-                }
-                if (log1set && log2set) break;
-        }
-        if ( ! (log1set && log2set) ) throw "some error by field inversion. DLog not found.";
-        return GF256(powers[(log1 - log2 + 255) % 255]) ;
+        return GF256(exponents[logarithms[element] + 255 - logarithms[x.element]]);
 }
 
 GF256 GF256::pow(int k) const
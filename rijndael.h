@@ -20,21 +20,34 @@ private:
         uint8_t         element;
 	static bool	multiplication_table_initialized;
         static std::array<uint8_t, 255>   powers; // with respect to 0xE5
+        static std::array<uint8_t, 256>   logarithms; // logarithms[powers[i]] == i, logarithms[0] unused
+        static std::array<uint8_t, 510>   exponents; // powers twice, so sum of two logarithms needs no reduction
         static void	group_0XE5_multiplication_table_initialization(); // power table one-time-generation
+        static void	init_table();
 
 public:
 
-                GF256();
-                GF256(const uint8_t _element);
+                GF256() : element(0) { if (!multiplication_table_initialized) init_table(); }
+                GF256(const uint8_t _element) : element(_element) { if (!multiplication_table_initialized) init_table(); }
 
         bool      operator ==(const GF256 & x) const { return element == x.element; }
         GF256     operator + (const GF256 & x) const { return element ^ x.element; }
         GF256     operator - (const GF256 & x) const { return element ^ x.element; }
-        GF256     operator * (const GF256 & x) const ;
+        GF256     operator * (const GF256 & x) const { return GF256(multiply(element, x.element)); }
         GF256     operator / (const GF256 & x) const ;
         GF256     inversion() const;
         uint8_t   octet() const { return element; }
         GF256     pow(int k) const;
+        /// multiplication through logarithm tables, inlined into callers' loops
+        static uint8_t multiply(uint8_t x, uint8_t y) {
+                if (x == 0 || y == 0) return 0;
+                return exponents[logarithms[x] + logarithms[y]];
+        }
+        /// same for non-zero y given by its logarithm, saves lookups when y is fixed over a loop
+        static uint8_t logarithm(uint8_t y) { return logarithms[y]; }
+        static uint8_t multiply_log(uint8_t x, uint8_t log_y) {
+                return x == 0 ? 0 : exponents[logarithms[x] + log_y];
+        }
 };
 
 #endif
@@ -0,0 +1,129 @@
+#include <securearena.h>
+
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace {
+	const size_t huge_page = 1 << 21;
+
+	size_t round_up(size_t size, size_t unit) {
+		return (size + unit - 1) / unit * unit;
+	}
+
+	std::atomic<size_t> arena_capacity(1 << 21);
+	std::atomic<int> arena_backing(static_cast<int>(secure_arena::pages::transparent_huge));
+}
+
+secure_arena::secure_arena(size_t capacity, pages backing) : m_capacity(capacity > 0 ? capacity : 1), m_backing(backing), m_huge(false) {
+	m_regions.push_back(map_region(m_capacity, true));
+}
+
+secure_arena::~secure_arena() {
+	for (auto && r: m_regions) unmap_region(r);
+}
+
+secure_arena::region secure_arena::map_region(size_t size, bool first) {
+	region r = region();
+	if (m_backing == pages::huge) {
+		r.size = round_up(size, huge_page);
+		void * p = mmap(nullptr, r.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED) {
+			r.data = static_cast<uint8_t *>(p);
+			if (first) m_huge = true;
+		}
+	}
+	if (r.data == nullptr) {
+		r.size = round_up(size, sysconf(_SC_PAGESIZE));
+		const bool transparent = m_backing == pages::transparent_huge && r.size >= huge_page;
+		if (transparent) r.size = round_up(r.size, huge_page);
+		/// transparent huge pages need aligned region, so one huge page more is mapped and the ends are cut off
+		const size_t mapped = transparent ? r.size + huge_page : r.size;
+		void * p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED) throw "Cannot map secure arena";
+		r.data = static_cast<uint8_t *>(p);
+		if (transparent) {
+			const size_t head = round_up(reinterpret_cast<uintptr_t>(r.data), huge_page) - reinterpret_cast<uintptr_t>(r.data);
+			if (head > 0) munmap(r.data, head);
+			munmap(r.data + head + r.size, huge_page - head);
+			r.data += head;
+			madvise(r.data, r.size, MADV_HUGEPAGE);
+		}
+	}
+	madvise(r.data, r.size, MADV_DONTDUMP);
+	r.locked = mlock(r.data, r.size) == 0;
+	return r;
+}
+
+void secure_arena::unmap_region(region & r) {
+	explicit_bzero(r.data, r.used);
+	if (r.locked) munlock(r.data, r.size);
+	munmap(r.data, r.size);
+	r.data = nullptr;
+}
+
+void * secure_arena::allocate(size_t size, size_t alignment) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	region * r = &m_regions.back();
+	size_t offset = round_up(reinterpret_cast<uintptr_t>(r->data) + r->used, alignment) - reinterpret_cast<uintptr_t>(r->data);
+	if (offset + size > r->size) {
+		m_regions.push_back(map_region(std::max(m_capacity, size + alignment), false));
+		r = &m_regions.back();
+		offset = round_up(reinterpret_cast<uintptr_t>(r->data), alignment) - reinterpret_cast<uintptr_t>(r->data);
+	}
+	r->used = offset + size;
+	return r->data + offset;
+}
+
+secure_arena::position secure_arena::mark() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	position p;
+	p.region = m_regions.size() - 1;
+	p.offset = m_regions.back().used;
+	return p;
+}
+
+void secure_arena::reset(position from) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (m_regions.size() > from.region + 1) {
+		unmap_region(m_regions.back());
+		m_regions.pop_back();
+	}
+	region & r = m_regions.back();
+	if (r.used > from.offset) {
+		explicit_bzero(r.data + from.offset, r.used - from.offset);
+		r.used = from.offset;
+	}
+}
+
+size_t secure_arena::used() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t total(0);
+	for (auto && r: m_regions) total += r.used;
+	return total;
+}
+
+bool secure_arena::locked() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto && r: m_regions) {
+		if (!r.locked) return false;
+	}
+	return true;
+}
+
+namespace Shamir {
+	secure_arena & thread_arena() {
+		thread_local std::unique_ptr<secure_arena> arena;
+		if (!arena) arena.reset(new secure_arena(arena_capacity, static_cast<secure_arena::pages>(arena_backing.load())));
+		return *arena;
+	}
+
+	void set_arena_size(size_t capacity, secure_arena::pages backing) {
+		arena_capacity = capacity;
+		arena_backing = static_cast<int>(backing);
+	}
+}
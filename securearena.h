@@ -0,0 +1,71 @@
+#ifndef SECUREARENA
+#define SECUREARENA
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * bump allocator for buffers holding key material.
+ * Region of 'capacity' bytes is mapped up front, locked in memory so it is never swapped out
+ * and excluded from core dumps; transparent or explicit huge pages cut TLB misses on large splits.
+ * Allocations just move a pointer, nothing is freed one by one: reset() zeroes everything
+ * allocated after given position and makes it available again. When the region is exhausted,
+ * further regions are mapped and released again by reset().
+ * Locking is best effort (RLIMIT_MEMLOCK), locked() tells whether it succeeded.
+ */
+class secure_arena {
+	public:
+		enum class pages { normal, transparent_huge, huge }; // huge falls back to normal pages if none are reserved
+		/// allocation point reset() returns to
+		struct position {
+			size_t region, offset;
+		};
+
+		explicit secure_arena(size_t capacity = 1 << 21, pages backing = pages::transparent_huge);
+		secure_arena(const secure_arena &) = delete;
+		secure_arena & operator = (const secure_arena &) = delete;
+		~secure_arena(); // zeroes and unmaps everything
+		void * allocate(size_t size, size_t alignment = 64); // safe to call from several threads
+		position mark();
+		void reset(position from = position()); // zeroes memory allocated since 'from', not concurrently with allocate
+		size_t used(); // bytes allocated, including alignment
+		bool locked();
+		bool huge() const { return m_huge; } // first region is backed by explicit huge pages
+	private:
+		struct region {
+			uint8_t * data;
+			size_t size, used;
+			bool locked;
+		};
+		std::vector<region> m_regions;
+		size_t m_capacity;
+		pages m_backing;
+		bool m_huge;
+		std::mutex m_mutex;
+
+		region map_region(size_t size, bool first);
+		static void unmap_region(region & r);
+};
+
+/// returns arena to the position it had when the scope started, so an operation leaves no key material behind
+class arena_scope {
+	private:
+		secure_arena & m_arena;
+		secure_arena::position m_start;
+	public:
+		explicit arena_scope(secure_arena & arena) : m_arena(arena), m_start(arena.mark()) {}
+		arena_scope(const arena_scope &) = delete;
+		arena_scope & operator = (const arena_scope &) = delete;
+		~arena_scope() { m_arena.reset(m_start); }
+};
+
+namespace Shamir {
+	/// arena of the calling thread used by distribute and reconstruct, mapped on first use
+	secure_arena & thread_arena();
+	/// capacity and backing of thread arenas mapped from now on, default 2 MiB of transparent huge pages
+	void set_arena_size(size_t capacity, secure_arena::pages backing);
+}
+
+#endif
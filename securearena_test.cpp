@@ -0,0 +1,80 @@
+#include <securearena.h>
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstring>
+
+/// allocations are aligned, do not overlap and are zeroed by reset
+void test_bump() {
+	secure_arena arena(1 << 16, secure_arena::pages::normal);
+	uint8_t * a = static_cast<uint8_t *>(arena.allocate(100));
+	uint8_t * b = static_cast<uint8_t *>(arena.allocate(100, 16));
+	assert(reinterpret_cast<uintptr_t>(a) % 64 == 0 && reinterpret_cast<uintptr_t>(b) % 16 == 0);
+	assert(b >= a + 100);
+	std::memset(a, 0xaa, 100);
+	std::memset(b, 0xbb, 100);
+	auto middle = arena.mark();
+	uint8_t * c = static_cast<uint8_t *>(arena.allocate(1000));
+	std::memset(c, 0xcc, 1000);
+	arena.reset(middle);
+	for (size_t i = 0; i < 1000; ++i) assert(c[i] == 0);
+	assert(a[99] == 0xaa && b[99] == 0xbb);
+	assert(arena.allocate(1000) == c);
+	arena.reset();
+	for (size_t i = 0; i < 100; ++i) assert(a[i] == 0 && b[i] == 0);
+	assert(arena.used() == 0);
+	std::cout << "secure arena bump allocation and reset: passed" << std::endl;
+}
+
+/// exhausted arena maps another region, scope releases it again
+void test_growth() {
+	secure_arena arena(4096, secure_arena::pages::transparent_huge);
+	{
+		arena_scope scope(arena);
+		uint8_t * small = static_cast<uint8_t *>(arena.allocate(1000));
+		uint8_t * large = static_cast<uint8_t *>(arena.allocate(3 << 20));
+		std::memset(small, 1, 1000);
+		std::memset(large, 2, 3 << 20);
+		assert(arena.used() >= 1000 + (3 << 20));
+	}
+	assert(arena.used() == 0);
+	secure_arena huge(1 << 21, secure_arena::pages::huge); // without reserved huge pages it runs on normal pages
+	std::memset(huge.allocate(1 << 20), 3, 1 << 20);
+	std::cout << "secure arena growth, huge pages " << (huge.huge() ? "reserved" : "not reserved") << ", memory "
+		<< (arena.locked() ? "locked" : "not locked") << ": passed" << std::endl;
+}
+
+/// threads allocating from one arena get disjoint blocks
+void test_threads() {
+	secure_arena arena(1 << 20, secure_arena::pages::normal);
+	std::vector<std::thread> threads;
+	std::vector<uint8_t *> blocks(8);
+	for (size_t t = 0; t < blocks.size(); ++t) {
+		threads.push_back(std::thread([&arena, &blocks, t] {
+			for (int round = 0; round < 100; ++round) {
+				blocks[t] = static_cast<uint8_t *>(arena.allocate(512));
+				std::memset(blocks[t], static_cast<int>(t), 512);
+			}
+		}));
+	}
+	for (auto && t: threads) t.join();
+	for (size_t t = 0; t < blocks.size(); ++t) {
+		for (size_t i = 0; i < 512; ++i) assert(blocks[t][i] == t);
+	}
+	assert(&Shamir::thread_arena() == &Shamir::thread_arena());
+	std::cout << "secure arena shared by threads: passed" << std::endl;
+}
+
+int main() {
+	try {
+		test_bump();
+		test_growth();
+		test_threads();
+	} catch (const char * s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -7,6 +7,21 @@
 #include <endian.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpufeatures.h>
+#include <immintrin.h>
+
+namespace sha256_avx2
+{
+    void TransformLanes(uint32_t* state, const unsigned char* const* blocks);
+}
+
+namespace sha256_avx512
+{
+    void TransformLanes(uint32_t* state, const unsigned char* const* blocks);
+}
+#endif
+
 
 // Internal implementation code.
 namespace
@@ -149,6 +164,187 @@ namespace
             }
         }
     } // namespace sha256
+
+#if defined(__x86_64__) || defined(__i386__)
+    /// SHA-256 compression with Intel SHA extensions, compiled for them regardless of build flags and used only where cpuid reports them.
+    namespace sha256_shani
+    {
+#define SHANI_TARGET __attribute__((target("sha,sse4.1"), always_inline))
+        alignas(16) const uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        alignas(16) const uint8_t MASK[16] = {0x03, 0x02, 0x01, 0x00, 0x07, 0x06, 0x05, 0x04, 0x0b, 0x0a, 0x09, 0x08, 0x0f, 0x0e, 0x0d, 0x0c};
+
+        /** Four rounds with message words 'm' and round constants K[4 * q] ... K[4 * q + 3]. */
+        SHANI_TARGET inline void QuadRound(__m128i& state0, __m128i& state1, __m128i m, int q)
+        {
+            const __m128i msg = _mm_add_epi32(m, _mm_load_si128((const __m128i*)(K + 4 * q)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e));
+        }
+
+        SHANI_TARGET inline void ShiftMessageA(__m128i& m0, __m128i m1)
+        {
+            m0 = _mm_sha256msg1_epu32(m0, m1);
+        }
+
+        SHANI_TARGET inline void ShiftMessageC(__m128i& m0, __m128i m1, __m128i& m2)
+        {
+            m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, _mm_alignr_epi8(m1, m0, 4)), m1);
+        }
+
+        SHANI_TARGET inline void ShiftMessageB(__m128i& m0, __m128i m1, __m128i& m2)
+        {
+            ShiftMessageC(m0, m1, m2);
+            ShiftMessageA(m0, m1);
+        }
+
+        /** State words a..h as the rounds instructions expect them: ABEF and CDGH. */
+        SHANI_TARGET inline void Shuffle(__m128i& s0, __m128i& s1)
+        {
+            const __m128i t1 = _mm_shuffle_epi32(s0, 0xB1);
+            const __m128i t2 = _mm_shuffle_epi32(s1, 0x1B);
+            s0 = _mm_alignr_epi8(t1, t2, 0x08);
+            s1 = _mm_blend_epi16(t2, t1, 0xF0);
+        }
+
+        SHANI_TARGET inline void Unshuffle(__m128i& s0, __m128i& s1)
+        {
+            const __m128i t1 = _mm_shuffle_epi32(s0, 0x1B);
+            const __m128i t2 = _mm_shuffle_epi32(s1, 0xB1);
+            s0 = _mm_blend_epi16(t1, t2, 0xF0);
+            s1 = _mm_alignr_epi8(t2, t1, 0x08);
+        }
+
+        SHANI_TARGET inline __m128i Load(const unsigned char* in)
+        {
+            return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), _mm_load_si128((const __m128i*)MASK));
+        }
+#undef SHANI_TARGET
+
+        __attribute__((target("sha,sse4.1"))) void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+        {
+            __m128i m0, m1, m2, m3, s0, s1, so0, so1;
+
+            s0 = _mm_loadu_si128((const __m128i*)s);
+            s1 = _mm_loadu_si128((const __m128i*)(s + 4));
+            Shuffle(s0, s1);
+
+            while (blocks--) {
+                so0 = s0;
+                so1 = s1;
+
+                m0 = Load(chunk);
+                QuadRound(s0, s1, m0, 0);
+                m1 = Load(chunk + 16);
+                QuadRound(s0, s1, m1, 1);
+                ShiftMessageA(m0, m1);
+                m2 = Load(chunk + 32);
+                QuadRound(s0, s1, m2, 2);
+                ShiftMessageA(m1, m2);
+                m3 = Load(chunk + 48);
+                QuadRound(s0, s1, m3, 3);
+                ShiftMessageB(m2, m3, m0);
+                QuadRound(s0, s1, m0, 4);
+                ShiftMessageB(m3, m0, m1);
+                QuadRound(s0, s1, m1, 5);
+                ShiftMessageB(m0, m1, m2);
+                QuadRound(s0, s1, m2, 6);
+                ShiftMessageB(m1, m2, m3);
+                QuadRound(s0, s1, m3, 7);
+                ShiftMessageB(m2, m3, m0);
+                QuadRound(s0, s1, m0, 8);
+                ShiftMessageB(m3, m0, m1);
+                QuadRound(s0, s1, m1, 9);
+                ShiftMessageB(m0, m1, m2);
+                QuadRound(s0, s1, m2, 10);
+                ShiftMessageB(m1, m2, m3);
+                QuadRound(s0, s1, m3, 11);
+                ShiftMessageB(m2, m3, m0);
+                QuadRound(s0, s1, m0, 12);
+                ShiftMessageB(m3, m0, m1);
+                QuadRound(s0, s1, m1, 13);
+                ShiftMessageC(m0, m1, m2);
+                QuadRound(s0, s1, m2, 14);
+                ShiftMessageC(m1, m2, m3);
+                QuadRound(s0, s1, m3, 15);
+
+                s0 = _mm_add_epi32(s0, so0);
+                s1 = _mm_add_epi32(s1, so1);
+                chunk += 64;
+            }
+
+            Unshuffle(s0, s1);
+            _mm_storeu_si128((__m128i*)s, s0);
+            _mm_storeu_si128((__m128i*)(s + 4), s1);
+        }
+    } // namespace sha256_shani
+#endif
+
+    typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
+    /** Portable until detection ran, so hashing during static initialization of other units is safe. */
+    TransformType Transform = sha256::Transform;
+
+    /** One block of each of 'LaneCount' messages, state is word-major: word i of lane l at state[i * LaneCount + l]. */
+    typedef void (*TransformLanesType)(uint32_t* state, const unsigned char* const* blocks);
+    const size_t MAX_LANES = 16;
+    TransformLanesType TransformLanes = nullptr;
+    size_t LaneCount = 1;
+
+    const std::string selected = SHA256AutoDetect();
+
+    void HashOne(const unsigned char* data, size_t len, unsigned char* hash)
+    {
+        CSHA256().Write(data, len).Finalize(hash);
+    }
+
+    /** Up to LaneCount messages in lock-step; lanes that ran out of blocks, or are not used, compress zeros. */
+    void HashLanes(const unsigned char* const* data, const size_t* lengths, size_t count, unsigned char* hashes)
+    {
+        static const unsigned char idle[64] = {0};
+        unsigned char tails[MAX_LANES][128];
+        const unsigned char* blocks[MAX_LANES];
+        size_t full[MAX_LANES], total[MAX_LANES];
+        uint32_t state[8 * MAX_LANES];
+        size_t rounds = 0;
+        for (size_t l = 0; l < count; ++l) {
+            // Message blocks are read in place, only the padded tail (one block, or two above 55 bytes) is copied.
+            const size_t rest = lengths[l] % 64;
+            const size_t padded = rest < 56 ? 64 : 128;
+            full[l] = lengths[l] / 64;
+            total[l] = full[l] + padded / 64;
+            memcpy(tails[l], data[l] + 64 * full[l], rest);
+            tails[l][rest] = 0x80;
+            memset(tails[l] + rest + 1, 0, padded - rest - 9);
+            WriteBE64(tails[l] + padded - 8, uint64_t(lengths[l]) << 3);
+            if (total[l] > rounds) rounds = total[l];
+        }
+        uint32_t iv[8];
+        sha256::Initialize(iv);
+        for (int i = 0; i < 8; ++i) {
+            for (size_t l = 0; l < LaneCount; ++l) state[i * LaneCount + l] = iv[i];
+        }
+        for (size_t b = 0; b < rounds; ++b) {
+            for (size_t l = 0; l < LaneCount; ++l) {
+                if (l >= count || b >= total[l]) blocks[l] = idle;
+                else if (b < full[l]) blocks[l] = data[l] + 64 * b;
+                else blocks[l] = tails[l] + 64 * (b - full[l]);
+            }
+            TransformLanes(state, blocks);
+            for (size_t l = 0; l < count; ++l) {
+                if (b + 1 != total[l]) continue;
+                for (int i = 0; i < 8; ++i) WriteBE32(hashes + 32 * l + 4 * i, state[i * LaneCount + l]);
+            }
+        }
+        memset(tails, 0, sizeof(tails));
+        memset(state, 0, sizeof(state));
+    }
 } // namespace
 
 
@@ -166,12 +362,12 @@ CSHA256& CSHA256::Write(const unsigned char* data, size_t len)
         memcpy(buf + bufsize, data, 64 - bufsize);
         bytes += 64 - bufsize;
         data += 64 - bufsize;
-	sha256::Transform(s, buf, 1);
+        Transform(s, buf, 1);
         bufsize = 0;
     }
     if (end - data >= 64) {
         size_t blocks = (end - data) / 64;
-	sha256::Transform(s, data, blocks);
+        Transform(s, data, blocks);
         data += 64 * blocks;
         bytes += 64 * blocks;
     }
@@ -206,3 +402,43 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    Transform = sha256::Transform;
+    TransformLanes = nullptr;
+    LaneCount = 1;
+#if defined(__x86_64__) || defined(__i386__)
+    bool shani = false;
+    if ((use_implementation & sha256_implementation::USE_SHANI) && cpu_features::have_shani()) {
+        Transform = sha256_shani::Transform;
+        ret = "shani(1way)";
+        shani = true;
+    }
+    if ((use_implementation & sha256_implementation::USE_AVX512) && cpu_features::have_avx512()) {
+        TransformLanes = sha256_avx512::TransformLanes;
+        LaneCount = 16;
+        ret += ",avx512(16way)";
+    } else if ((use_implementation & sha256_implementation::USE_AVX2) && !shani && cpu_features::have_avx2()) {
+        // eight lanes of AVX2 are no faster than one SHA-NI unit, so they only stand in for it
+        TransformLanes = sha256_avx2::TransformLanes;
+        LaneCount = 8;
+        ret += ",avx2(8way)";
+    }
+#endif
+    return ret;
+}
+
+void SHA256Batch(const unsigned char* const* data, const size_t* lengths, size_t count, unsigned char* hashes)
+{
+    size_t i = 0;
+    if (TransformLanes != nullptr) {
+        // A group needs half of its lanes busy to beat hashing the messages one by one.
+        for (; i < count && count - i >= LaneCount / 2; i += LaneCount) {
+            const size_t n = count - i < LaneCount ? count - i : LaneCount;
+            HashLanes(data + i, lengths + i, n, hashes + 32 * i);
+        }
+    }
+    for (; i < count; ++i) HashOne(data[i], lengths[i], hashes + 32 * i);
+}
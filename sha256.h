@@ -26,4 +26,22 @@ public:
     CSHA256& Reset();
 };
 
+namespace sha256_implementation {
+enum UseImplementation : uint8_t {
+    USE_STANDARD = 0,
+    USE_SHANI = 1 << 0,
+    USE_AVX2 = 1 << 1,
+    USE_AVX512 = 1 << 2,
+    USE_ALL = USE_SHANI | USE_AVX2 | USE_AVX512,
+};
+}
+
+/** Selects the fastest compression function the CPU supports among the allowed ones and returns its description.
+ *  Runs automatically at startup; calling it again is meant for tests and must not race with hashing. */
+std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implementation = sha256_implementation::USE_ALL);
+
+/** SHA-256 of 'count' independent messages, 32 bytes per message into 'hashes'. With AVX2 or AVX-512
+ *  8 or 16 messages are compressed side by side, a message shorter than 56 bytes in a single pass. */
+void SHA256Batch(const unsigned char* const* data, const size_t* lengths, size_t count, unsigned char* hashes);
+
 #endif // SHA256_H
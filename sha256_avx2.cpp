@@ -0,0 +1,17 @@
+// Copyright (c) 2014-2017 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Compiled with -mavx2, called only where cpuid and the OS report AVX2.
+
+#include <sha256_lanes.h>
+
+namespace sha256_avx2
+{
+    typedef uint32_t vec __attribute__((vector_size(32)));
+
+    void TransformLanes(uint32_t* state, const unsigned char* const* blocks)
+    {
+        sha256_lanes::Transform<vec>(state, blocks);
+    }
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2014-2017 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SHA256_LANES_H
+#define SHA256_LANES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <endian.h>
+
+/**
+ * SHA-256 compression of several independent blocks side by side, word i of every lane in one vector.
+ * Included by units compiled for a particular instruction set (sha256_avx2.cpp, sha256_avx512.cpp),
+ * which instantiate it with a vector type of that width.
+ */
+namespace
+{
+    namespace sha256_lanes
+    {
+        const uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+        template <typename V> inline V Rotr(V x, int n) { return (x >> n) | (x << (32 - n)); }
+        template <typename V> inline V Ch(V x, V y, V z) { return z ^ (x & (y ^ z)); }
+        template <typename V> inline V Maj(V x, V y, V z) { return (x & y) | (z & (x | y)); }
+        template <typename V> inline V Sigma0(V x) { return Rotr(x, 2) ^ Rotr(x, 13) ^ Rotr(x, 22); }
+        template <typename V> inline V Sigma1(V x) { return Rotr(x, 6) ^ Rotr(x, 11) ^ Rotr(x, 25); }
+        template <typename V> inline V sigma0(V x) { return Rotr(x, 7) ^ Rotr(x, 18) ^ (x >> 3); }
+        template <typename V> inline V sigma1(V x) { return Rotr(x, 17) ^ Rotr(x, 19) ^ (x >> 10); }
+
+        /** One block of every lane: state holds word i of lane l at state[i * lanes + l], blocks[l] points to 64 bytes of lane l. */
+        template <typename V>
+        inline void Transform(uint32_t* state, const unsigned char* const* blocks)
+        {
+            const size_t lanes = sizeof(V) / sizeof(uint32_t);
+            V s[8], w[16];
+            uint32_t words[16][lanes];
+            for (size_t l = 0; l < lanes; ++l) {
+                for (int i = 0; i < 16; ++i) {
+                    uint32_t x;
+                    memcpy(&x, blocks[l] + 4 * i, 4);
+                    words[i][l] = be32toh(x);
+                }
+            }
+            memcpy(w, words, sizeof(w));
+            for (int i = 0; i < 8; ++i) memcpy(&s[i], state + i * lanes, sizeof(V));
+            V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#pragma GCC unroll 64
+            for (int i = 0; i < 64; ++i) {
+                if (i >= 16) w[i & 15] += sigma1(w[(i - 2) & 15]) + w[(i - 7) & 15] + sigma0(w[(i - 15) & 15]);
+                const V t1 = h + Sigma1(e) + Ch(e, f, g) + K[i] + w[i & 15];
+                const V t2 = Sigma0(a) + Maj(a, b, c);
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+            s[0] += a;
+            s[1] += b;
+            s[2] += c;
+            s[3] += d;
+            s[4] += e;
+            s[5] += f;
+            s[6] += g;
+            s[7] += h;
+            for (int i = 0; i < 8; ++i) memcpy(state + i * lanes, &s[i], sizeof(V));
+        }
+    } // namespace sha256_lanes
+} // namespace
+
+#endif // SHA256_LANES_H
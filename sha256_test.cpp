@@ -0,0 +1,83 @@
+#include <sha256.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+	std::vector<unsigned char> hash(const std::vector<unsigned char> & data, size_t piece) {
+		CSHA256 h;
+		for (size_t i = 0; i < data.size(); i += piece) h.Write(data.data() + i, std::min(piece, data.size() - i));
+		std::vector<unsigned char> out(CSHA256::OUTPUT_SIZE);
+		h.Finalize(out.data());
+		return out;
+	}
+}
+
+/// FIPS 180-2 examples
+void test_vectors() {
+	const std::string abc("abc"), two_blocks("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+	const unsigned char abc_hash[32] = {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+	const unsigned char two_blocks_hash[32] = {0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+		0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1};
+	for (auto use: {sha256_implementation::USE_STANDARD, sha256_implementation::USE_ALL}) {
+		const std::string name = SHA256AutoDetect(use);
+		assert(std::memcmp(hash(std::vector<unsigned char>(abc.begin(), abc.end()), 3).data(), abc_hash, 32) == 0);
+		assert(std::memcmp(hash(std::vector<unsigned char>(two_blocks.begin(), two_blocks.end()), 56).data(), two_blocks_hash, 32) == 0);
+		std::cout << "SHA256 " << name << " test vectors: passed" << std::endl;
+	}
+}
+
+/// selected implementation hashes random data of every length up to several blocks as the portable one
+void test_equivalence() {
+	std::mt19937 gen(4711);
+	for (size_t length = 0; length <= 64 * 5 + 1; ++length) {
+		std::vector<unsigned char> data(length);
+		for (auto && b: data) b = static_cast<unsigned char>(gen());
+		const size_t piece = 1 + gen() % 100;
+		SHA256AutoDetect(sha256_implementation::USE_STANDARD);
+		const auto expected = hash(data, length + 1);
+		SHA256AutoDetect();
+		assert(hash(data, length + 1) == expected);
+		assert(hash(data, piece) == expected);
+	}
+	std::cout << "SHA256 " << SHA256AutoDetect() << " matches standard on random inputs: passed" << std::endl;
+}
+
+/// batches of every size around the lane counts, messages of mixed lengths, hash as one by one
+void test_batch() {
+	std::mt19937 gen(815);
+	for (auto use: {sha256_implementation::USE_STANDARD, sha256_implementation::USE_AVX2, sha256_implementation::USE_ALL}) {
+		const std::string name = SHA256AutoDetect(use);
+		for (size_t count = 0; count <= 40; ++count) {
+			std::vector<std::vector<unsigned char>> messages(count);
+			std::vector<const unsigned char *> data;
+			std::vector<size_t> lengths;
+			for (auto && m: messages) {
+				m.resize(gen() % 2 ? gen() % 56 : gen() % 200);
+				for (auto && b: m) b = static_cast<unsigned char>(gen());
+				data.push_back(m.data());
+				lengths.push_back(m.size());
+			}
+			std::vector<unsigned char> hashes(32 * count);
+			SHA256Batch(data.data(), lengths.data(), count, hashes.data());
+			for (size_t i = 0; i < count; ++i) {
+				assert(std::equal(hashes.begin() + 32 * i, hashes.begin() + 32 * (i + 1), hash(messages[i], 64).begin()));
+			}
+		}
+		std::cout << "SHA256 batch " << name << " matches single messages: passed" << std::endl;
+	}
+	SHA256AutoDetect();
+}
+
+int main() {
+	test_vectors();
+	test_equivalence();
+	test_batch();
+	return 0;
+}
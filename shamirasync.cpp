@@ -0,0 +1,273 @@
+#include <shamirasync.h>
+#include <shamirmulti.h>
+#include <oneblockshamir.h>
+#include <multiblock.h>
+
+#include <get_insecure_randomness.h>
+#include <sha256.h>
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	/**
+	 * threads taking turns in running steps of pending jobs: job is taken from the front of the queue,
+	 * one chunk of it is done and unless it finished, it goes to the back, so large operations do not
+	 * delay small ones queued after them.
+	 */
+	class async_executor {
+		private:
+			std::vector<std::thread> m_threads;
+			std::deque< std::shared_ptr<Shamir::detail::async_job> > m_jobs;
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			bool m_stop;
+
+			void worker() {
+				while (true) {
+					std::shared_ptr<Shamir::detail::async_job> job;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+						if (m_jobs.empty()) return;
+						job = std::move(m_jobs.front());
+						m_jobs.pop_front();
+					}
+					if (!job->run_step()) push(std::move(job));
+				}
+			}
+		public:
+			explicit async_executor(unsigned threads) : m_stop(false) {
+				if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+				for (unsigned i = 0; i < threads; ++i) m_threads.push_back(std::thread(&async_executor::worker, this));
+			}
+			~async_executor() {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_wake.notify_all();
+				for (auto && t: m_threads) t.join();
+			}
+			void push(std::shared_ptr<Shamir::detail::async_job> job) {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_jobs.push_back(std::move(job));
+				}
+				m_wake.notify_one();
+			}
+	};
+
+	std::mutex executor_mutex;
+	unsigned executor_threads(0);
+	std::unique_ptr<async_executor> executor;
+
+	async_executor & shared_executor() {
+		std::lock_guard<std::mutex> lock(executor_mutex);
+		if (!executor) executor.reset(new async_executor(executor_threads));
+		return *executor;
+	}
+
+	/**
+	 * hashes message, then evaluates polynomials chunk by chunk of columns directly into share packets.
+	 * Packets are hashed as their bytes get final, so sealing them does not need another pass.
+	 */
+	class distribute_job: public Shamir::detail::async_value_job< std::vector< std::vector<uint8_t> > > {
+		private:
+			std::vector<uint8_t> m_msg;
+			unsigned m_threshold, m_sharecount;
+			size_t m_columns, m_position;
+			bool m_hashed;
+			CSHA256 m_msg_hash;
+			uint8_t m_checksum[2];
+			std::vector<Shamir::share_checksum> m_share_hashes;
+			std::vector<uint8_t> m_coefficients;
+			Shamir::evaluate_kernel m_evaluate;
+
+			/// packet bytes before 'end' got all their bits once columns before 'end' are written
+			void hash_shares(size_t begin, size_t end) {
+				for (unsigned i = 0; i < m_sharecount; ++i) m_share_hashes[i].write(result[i].data() + begin, end - begin);
+			}
+		protected:
+			bool step() override {
+				const size_t length = m_msg.size();
+				if (!m_hashed) {
+					const size_t end = std::min(length, m_position + m_options.chunk);
+					m_msg_hash.Write(m_msg.data() + m_position, end - m_position);
+					m_done += end - m_position;
+					m_position = end;
+					if (m_position < length) return false;
+					uint8_t hash[CSHA256::OUTPUT_SIZE];
+					m_msg_hash.Finalize(hash);
+					m_checksum[0] = hash[0];
+					m_checksum[1] = hash[1];
+					m_hashed = true;
+					m_position = 0;
+					result.assign(m_sharecount, std::vector<uint8_t>(m_columns + 4));
+					for (unsigned i = 0; i < m_sharecount; ++i) Shamir::start_share_packet(result[i].data(), m_columns, i + 1, m_threshold);
+					m_share_hashes.assign(m_sharecount, Shamir::share_checksum());
+					return false;
+				}
+				const size_t begin = m_position, end = std::min(m_columns, m_position + m_options.chunk);
+				m_coefficients.resize((end - begin) * m_threshold);
+				random_fill(m_options.coefficients, begin * m_threshold, m_coefficients.data(), m_coefficients.size());
+				for (size_t j = begin; j < end; ++j) {
+					uint8_t * c = m_coefficients.data() + (j - begin) * m_threshold;
+					c[0] = j < length ? m_msg[j] : m_checksum[j - length];
+					for (unsigned i = 0; i < m_sharecount; ++i) Shamir::put_share_column(result[i].data(), j, m_evaluate(c, i + 1));
+				}
+				std::fill(m_coefficients.begin(), m_coefficients.end(), 0);
+				m_done += (end - begin) * m_sharecount;
+				m_position = end;
+				if (m_position < m_columns) {
+					hash_shares(begin == 0 ? 0 : begin + 1, end + 1);
+					return false;
+				}
+				hash_shares(begin == 0 ? 0 : begin + 1, m_columns + 1);
+				for (unsigned i = 0; i < m_sharecount; ++i) m_share_hashes[i].seal(result[i].data() + m_columns + 1);
+				return true;
+			}
+		public:
+			distribute_job(std::vector<uint8_t> && msg, unsigned threshold, unsigned sharecount, const Shamir::async_options & options)
+					: async_value_job(options), m_msg(std::move(msg)), m_threshold(threshold), m_sharecount(sharecount),
+					m_columns(m_msg.size() + 2), m_position(0), m_hashed(false) {
+				if (sharecount < threshold) throw "share threshold must be equal or greater than total share count";
+				if (threshold == 0) throw "threshold must be greater than zero";
+				if (sharecount > 32) throw "share count must be at most 32";
+				if (m_msg.empty()) throw "secret must not be empty";
+				if (m_options.chunk == 0) m_options.chunk = 1;
+				m_evaluate = Shamir::evaluate_for(threshold);
+				m_total = m_msg.size() + m_columns * sharecount;
+			}
+	};
+
+	/**
+	 * interpolates secret chunk by chunk of columns, hashing share packets and restored secret
+	 * along the way; both checksums are compared after the last chunk.
+	 */
+	class reconstruct_job: public Shamir::detail::async_value_job< std::vector<uint8_t> > {
+		private:
+			std::vector< std::vector<uint8_t> > m_shares;
+			size_t m_columns, m_position;
+			std::vector<uint8_t> m_weights, m_ys, m_tail;
+			Shamir::interpolate_kernel m_interpolate;
+			std::vector<Shamir::share_checksum> m_share_hashes;
+			CSHA256 m_secret_hash;
+		protected:
+			bool step() override {
+				const size_t begin = m_position, end = std::min(m_columns, m_position + m_options.chunk);
+				const size_t length = m_columns - 2, count = m_shares.size();
+				for (size_t j = begin; j < end; ++j) {
+					for (size_t i = 0; i < count; ++i) m_ys[i] = Shamir::get_share_column(m_shares[i].data(), j);
+					const uint8_t value = m_interpolate(m_weights.data(), m_ys.data());
+					if (j < length) result[j] = value;
+					else m_tail[j - length] = value;
+				}
+				/// column j ends in byte j + 1 of the packet, byte m_columns + 1 also holds checksum bits
+				const size_t hashed_begin = begin == 0 ? 0 : begin + 1, hashed_end = std::min(end + 1, m_columns + 1);
+				for (size_t i = 0; i < count; ++i) m_share_hashes[i].write(m_shares[i].data() + hashed_begin, hashed_end - hashed_begin);
+				if (begin < length) m_secret_hash.Write(result.data() + begin, std::min(end, length) - begin);
+				m_done += (end - begin) * count;
+				m_position = end;
+				if (m_position < m_columns) return false;
+
+				for (size_t i = 0; i < count; ++i) {
+					if (!m_share_hashes[i].check(m_shares[i].data() + m_columns + 1)) throw "checksum verification failed";
+				}
+				uint8_t hash[CSHA256::OUTPUT_SIZE];
+				m_secret_hash.Finalize(hash);
+				if (hash[0] != m_tail[0] || hash[1] != m_tail[1]) throw "Secret message checksum verification failed. Message possibly corrupted.";
+				return true;
+			}
+		public:
+			reconstruct_job(std::vector< std::vector<uint8_t> > && share_list, const Shamir::async_options & options)
+					: async_value_job(options), m_shares(std::move(share_list)), m_position(0) {
+				if (m_shares.empty()) throw "Not enough shares supplied";
+				for (auto && i: m_shares) {
+					if (i.size() != m_shares[0].size()) throw "Shares do not have same length";
+				}
+				if (m_shares[0].size() < 5) throw "invalid share packet";
+				if (m_shares[0].size() < 7) throw "Secret message checksum verification failed. Message possibly corrupted.";
+				if (m_shares.size() > 32) throw "Share indices are not distinct";
+				std::vector<uint8_t> xs(m_shares.size());
+				unsigned threshold(0);
+				for (size_t i = 0; i < m_shares.size(); ++i) {
+					unsigned index, t;
+					Shamir::read_share_header(m_shares[i].data(), index, t);
+					if (i > 0 && t != threshold) throw "Shares do not signal same threshold";
+					threshold = t;
+					xs[i] = index;
+					for (size_t m = 0; m < i; ++m) {
+						if (xs[m] == xs[i]) throw "Share indices are not distinct";
+					}
+				}
+				if (threshold > m_shares.size()) throw "Not enough shares supplied";
+				m_weights.resize(m_shares.size());
+				m_ys.resize(m_shares.size());
+				m_tail.resize(2);
+				Shamir::lagrange_weights(xs.data(), xs.size(), m_weights.data());
+				m_interpolate = Shamir::interpolate_for(m_shares.size());
+				m_columns = m_shares[0].size() - 4;
+				result.resize(m_columns - 2);
+				m_share_hashes.assign(m_shares.size(), Shamir::share_checksum());
+				if (m_options.chunk == 0) m_options.chunk = 1;
+				m_total = m_columns * m_shares.size();
+			}
+	};
+} // anonymous namespace
+
+namespace Shamir {
+	namespace detail {
+		void async_job::start(std::coroutine_handle<> continuation) {
+			m_continuation = continuation;
+			shared_executor().push(shared_from_this());
+		}
+
+		bool async_job::run_step() {
+			if (m_options.cancel.cancelled()) {
+				try {
+					throw "Operation cancelled";
+				} catch (...) {
+					m_error = std::current_exception();
+				}
+				finish();
+				return true;
+			}
+			bool finished;
+			try {
+				finished = step();
+				if (m_options.progress) m_options.progress(m_done, m_total);
+			} catch (...) {
+				m_error = std::current_exception();
+				finished = true;
+			}
+			if (finished) finish();
+			return finished;
+		}
+
+		void async_job::finish() {
+			if (m_options.resume) m_options.resume(m_continuation);
+			else m_continuation.resume();
+		}
+	}
+
+	async_result<std::vector<std::vector<uint8_t>>> distribute_async(std::vector<uint8_t> msg, unsigned threshold, unsigned sharecount,
+			const async_options & options) {
+		return async_result<std::vector<std::vector<uint8_t>>>(std::make_shared<distribute_job>(std::move(msg), threshold, sharecount, options));
+	}
+
+	async_result<std::vector<uint8_t>> reconstruct_async(std::vector<std::vector<uint8_t>> share_list, const async_options & options) {
+		return async_result<std::vector<uint8_t>>(std::make_shared<reconstruct_job>(std::move(share_list), options));
+	}
+
+	void set_async_thread_count(unsigned threads) {
+		std::lock_guard<std::mutex> lock(executor_mutex);
+		executor_threads = threads;
+	}
+} // Shamir namespace
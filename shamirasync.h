@@ -0,0 +1,96 @@
+#ifndef SHAMIRASYNC
+#define SHAMIRASYNC
+
+#include <get_insecure_randomness.h>
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <coroutine>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * C++20 coroutine interface to distribute and reconstruct, for callers running an event loop.
+ * Awaiting distribute_async or reconstruct_async hands the work to an internal executor, which
+ * processes it in chunks of columns taking turns with other pending operations, and resumes the
+ * awaiting coroutine once the result is ready. The awaiting thread never does any of the work.
+ */
+namespace Shamir {
+	/// shared flag, copies refer to the same operation(s)
+	class cancellation {
+		private:
+			std::shared_ptr<std::atomic<bool>> m_flag;
+		public:
+			cancellation() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+			void cancel() { *m_flag = true; }
+			bool cancelled() const { return *m_flag; }
+	};
+
+	struct async_options {
+		/// checked before every chunk, cancelled operation resumes the caller with "Operation cancelled" thrown
+		cancellation cancel;
+		/// called on executor thread after every chunk with amount of work done so far and total work, in bytes
+		std::function<void(size_t done, size_t total)> progress;
+		/// schedules resumption of the awaiting coroutine, e.g. posts it to the event loop; if empty, it is resumed on executor thread
+		std::function<void(std::coroutine_handle<>)> resume;
+		/// bytes of every share handled in one turn
+		size_t chunk = 1 << 16;
+		/// random coefficients of distribution, empty for the default source; seeded source gives the same shares as distribute
+		random_source coefficients;
+	};
+
+	namespace detail {
+		/// operation split into steps, executor runs one step of the oldest pending operation at a time
+		class async_job: public std::enable_shared_from_this<async_job> {
+			public:
+				explicit async_job(const async_options & options) : m_options(options), m_done(0), m_total(0) {}
+				virtual ~async_job() {}
+				void start(std::coroutine_handle<> continuation);
+				bool run_step(); // true when finished (successfully or not) and continuation was scheduled
+				void rethrow() const { if (m_error) std::rethrow_exception(m_error); }
+			protected:
+				async_options m_options;
+				size_t m_done, m_total;
+				virtual bool step() = 0; // does next chunk of work, advances m_done, true after the last one
+			private:
+				std::coroutine_handle<> m_continuation;
+				std::exception_ptr m_error;
+				void finish();
+		};
+
+		template <typename T>
+		class async_value_job: public async_job {
+			public:
+				using async_job::async_job;
+				T result;
+		};
+	}
+
+	/// awaitable result of an asynchronous operation; work starts when it is awaited
+	template <typename T>
+	class async_result {
+		private:
+			std::shared_ptr<detail::async_value_job<T>> m_job;
+		public:
+			explicit async_result(std::shared_ptr<detail::async_value_job<T>> job) : m_job(std::move(job)) {}
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> continuation) { m_job->start(continuation); }
+			T await_resume() {
+				m_job->rethrow();
+				return std::move(m_job->result);
+			}
+	};
+
+	/// same shares as distribute(msg, threshold, sharecount); invalid arguments are thrown right away, other errors on resumption
+	async_result<std::vector<std::vector<uint8_t>>> distribute_async(std::vector<uint8_t> msg, unsigned threshold, unsigned sharecount,
+			const async_options & options = async_options());
+	async_result<std::vector<uint8_t>> reconstruct_async(std::vector<std::vector<uint8_t>> share_list,
+			const async_options & options = async_options());
+	/// executor threads, 0 ... one per hardware thread (default); takes effect before the first operation only
+	void set_async_thread_count(unsigned threads);
+}
+
+#endif
@@ -0,0 +1,196 @@
+#include <shamirasync.h>
+#include <shamirmulti.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <cassert>
+
+namespace {
+	/// coroutine nobody waits for, results are reported through captured variables
+	struct detached {
+		struct promise_type {
+			detached get_return_object() { return detached(); }
+			std::suspend_never initial_suspend() { return std::suspend_never(); }
+			std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+	};
+
+	/// minimal single threaded event loop, coroutines are resumed only from run()
+	class event_loop {
+		private:
+			std::deque<std::coroutine_handle<>> m_ready;
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			size_t m_running;
+		public:
+			event_loop() : m_running(0) {}
+			void post(std::coroutine_handle<> h) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_ready.push_back(h);
+				m_wake.notify_one();
+			}
+			std::function<void(std::coroutine_handle<>)> scheduler() {
+				return [this] (std::coroutine_handle<> h) { post(h); };
+			}
+			void started() { ++m_running; }
+			void finished() { --m_running; }
+			/// resumes posted coroutines until all started ones finished
+			void run() {
+				while (m_running > 0) {
+					std::coroutine_handle<> h;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_wake.wait(lock, [this] { return !m_ready.empty(); });
+						h = m_ready.front();
+						m_ready.pop_front();
+					}
+					h.resume();
+				}
+			}
+	};
+
+	std::vector<uint8_t> make_secret(size_t length) {
+		std::vector<uint8_t> secret(length);
+		for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 7 + i / 251);
+		return secret;
+	}
+
+	detached split_and_merge(event_loop & loop, std::vector<uint8_t> secret, std::thread::id loop_thread, bool & passed) {
+		loop.started();
+		Shamir::async_options options;
+		options.resume = loop.scheduler();
+		options.chunk = 1000;
+		size_t last(0), total(0);
+		options.progress = [&last, &total] (size_t done, size_t all) {
+			assert(done >= last && done <= all);
+			last = done;
+			total = all;
+		};
+		auto shares = co_await Shamir::distribute_async(secret, 3, 5, options);
+		assert(std::this_thread::get_id() == loop_thread);
+		assert(last == total && total > 0);
+		assert(shares.size() == 5 && shares[0].size() == Shamir::share_size(secret.size()));
+
+		/// shares of the tool and of the async interface are the same packets
+		std::vector<std::vector<uint8_t>> tool_set(shares.begin() + 2, shares.end());
+		assert(Shamir::reconstruct(tool_set) == secret);
+		std::vector<std::vector<uint8_t>> picked;
+		for (unsigned i: {4u, 0u, 2u}) picked.push_back(shares[i]);
+		last = 0;
+		auto restored = co_await Shamir::reconstruct_async(std::move(picked), options);
+		assert(std::this_thread::get_id() == loop_thread);
+		assert(restored == secret);
+		assert(last == total);
+		passed = true;
+		loop.finished();
+	}
+
+	detached expect_failure(event_loop & loop, std::vector<std::vector<uint8_t>> shares, Shamir::async_options options, std::string expected, bool & passed) {
+		loop.started();
+		options.resume = loop.scheduler();
+		try {
+			co_await Shamir::reconstruct_async(std::move(shares), options);
+		} catch (const char * s) {
+			passed = (expected == s);
+		}
+		loop.finished();
+	}
+
+	detached split_into(event_loop & loop, std::vector<uint8_t> secret, Shamir::async_options options, std::vector<std::vector<uint8_t>> & shares, bool & passed) {
+		loop.started();
+		options.resume = loop.scheduler();
+		shares = co_await Shamir::distribute_async(std::move(secret), 3, 4, options);
+		passed = true;
+		loop.finished();
+	}
+
+	detached timed_split(event_loop & loop, size_t length, size_t chunk, std::vector<size_t> & finished_order) {
+		loop.started();
+		Shamir::async_options options;
+		options.resume = loop.scheduler();
+		options.chunk = chunk;
+		co_await Shamir::distribute_async(make_secret(length), 2, 3, options);
+		finished_order.push_back(length);
+		loop.finished();
+	}
+}
+
+void test_roundtrip() {
+	event_loop loop;
+	bool passed(false);
+	split_and_merge(loop, make_secret(10007), std::this_thread::get_id(), passed);
+	loop.run();
+	assert(passed);
+	std::cout << "async roundtrip resumed on event loop: passed" << std::endl;
+}
+
+void test_failures() {
+	event_loop loop;
+	auto shares = Shamir::distribute(make_secret(5000), 2, 3);
+	bool corrupted(false), cancelled(false);
+	auto damaged = shares;
+	damaged[1][2500] ^= 4;
+	Shamir::async_options options;
+	options.chunk = 512;
+	expect_failure(loop, damaged, options, "checksum verification failed", corrupted);
+	Shamir::async_options cancelling;
+	cancelling.cancel.cancel();
+	expect_failure(loop, shares, cancelling, "Operation cancelled", cancelled);
+	loop.run();
+	assert(corrupted);
+	assert(cancelled);
+	std::cout << "async corrupted share and cancellation: passed" << std::endl;
+}
+
+/// with one executor thread small split queued after a large one still finishes first
+void test_fairness() {
+	event_loop loop;
+	std::vector<size_t> finished_order;
+	timed_split(loop, 1 << 22, 4096, finished_order);
+	timed_split(loop, 64, 4096, finished_order);
+	loop.run();
+	assert(finished_order.size() == 2 && finished_order[0] == 64);
+	std::cout << "async operations take turns: passed" << std::endl;
+}
+
+/// with seeded coefficients chunking does not change the shares
+void test_seeded() {
+	event_loop loop;
+	auto secret = make_secret(3000);
+	auto reference = Shamir::distribute(secret, 3, 4, seeded_random_source(7));
+	std::vector<std::vector<std::vector<uint8_t>>> results(2);
+	bool passed[2] = {false, false};
+	for (size_t i = 0; i < 2; ++i) {
+		Shamir::async_options options;
+		options.chunk = i == 0 ? 100 : 4096;
+		options.coefficients = seeded_random_source(7);
+		split_into(loop, secret, options, results[i], passed[i]);
+	}
+	loop.run();
+	assert(passed[0] && passed[1]);
+	assert(results[0] == reference && results[1] == reference);
+	std::cout << "async seeded coefficients: passed" << std::endl;
+}
+
+int main() {
+	Shamir::set_async_thread_count(1);
+	try {
+		test_roundtrip();
+		test_failures();
+		test_fairness();
+		test_seeded();
+	} catch (const char * s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -2,19 +2,29 @@
 #include <oneblockshamir.h>
 #include <multiblock.h>
 
+#include <threadpool.h>
+#include <securearena.h>
+#include <get_insecure_randomness.h>
+#include <sha256.h>
+
 #include <endian.h>
 #include <array>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <algorithm>
 
 namespace {
-	void checkSameLengths(const std::vector< std::vector<uint8_t> > & share_list) {
+	Shamir::status checkSameLengths(const std::vector< std::vector<uint8_t> > & share_list) {
 		for (auto && i: share_list) {
-			if (i.size() != share_list[0].size()) throw "Shares do not have same length";
+			if (i.size() != share_list[0].size()) return Shamir::status::different_lengths;
 		}
+		return Shamir::status::ok;
 	}
 
-	void extractIndexThreshold(unsigned & ind, unsigned & thr, const std::vector<uint8_t> & data) {
+	void extractIndexThreshold(unsigned & ind, unsigned & thr, const uint8_t * data) {
 		uint16_t overflower;
 		uint8_t * tmp_array = reinterpret_cast<uint8_t *>(&overflower);
 		tmp_array[0] = data[0];
@@ -24,7 +34,7 @@ namespace {
 		thr = ((overflower >> 6) & 31) + 1;
 	}
 
-	void checkDistinctIndicesSameThresholds(const std::vector< std::vector<uint8_t> > & share_list) {
+	Shamir::status checkDistinctIndicesSameThresholds(const std::vector<const uint8_t *> & share_list) {
 		std::vector<unsigned> indices, thresholds;
 		for (const auto & it: share_list) {
 			unsigned ind, thr;
@@ -33,65 +43,255 @@ namespace {
 			thresholds.push_back(thr);
 		}
 		for (const auto & it: thresholds) {
-			if (it != thresholds[0]) throw "Shares do not signal same threshold";
+			if (it != thresholds[0]) return Shamir::status::different_thresholds;
 		}
 
-		if (thresholds[0] > thresholds.size()) throw "Not enough shares supplied";
+		if (thresholds[0] > thresholds.size()) return Shamir::status::not_enough_shares;
 
 		std::sort(indices.begin(), indices.end());
 		for (unsigned i=1; i<indices.size(); ++i) {
-			if (indices[i] == indices[i-1]) throw "Share indices are not distinct";
+			if (indices[i] == indices[i-1]) return Shamir::status::duplicate_indices;
 		}
+		return Shamir::status::ok;
 	}
-} // anonymous namespace
 
-namespace Shamir {
-	std::vector< std::vector<uint8_t> >  distribute(const std::vector<uint8_t> & msg, unsigned threshold, unsigned sharecount) {
+	const size_t parallel_chunk = 1 << 18; /// bytes of share matrix handled by one task, small enough to stay in L2 cache
+
+	std::mutex pool_mutex;
+	unsigned pool_threads(1);
+	std::shared_ptr<thread_pool> pool;
+
+	/// callers keep their snapshot until they are done, set_thread_count only drops the reference of the pool
+	std::shared_ptr<thread_pool> shared_pool() {
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		if (!pool) pool = std::make_shared<thread_pool>(pool_threads);
+		return pool;
+	}
+
+	/// first two bytes of SHA256 of data, i. e. the checksum checksummed16 appends to byte-aligned data
+	void checksum16(const uint8_t * data, size_t length, uint8_t * out) {
+		CSHA256 h;
+		uint8_t hash[CSHA256::OUTPUT_SIZE];
+		h.Write(data, length);
+		h.Finalize(hash);
+		out[0] = hash[0];
+		out[1] = hash[1];
+	}
+
+	/**
+	 * evaluates random polynomials hiding message bytes followed by their 16 bit checksum
+	 * at x = 1 .. sharecount into matrix allocated in 'arena', its row i of length + 2 bytes
+	 * is the share with index i + 1. Ranges of columns are processed in parallel while the
+	 * checksum is being hashed. Matrix and coefficients are zeroed when the arena is reset.
+	 */
+	uint8_t * distributeColumns(thread_pool & workers, secure_arena & arena, const uint8_t * msg, size_t length, unsigned threshold, unsigned sharecount,
+			const random_source & source) {
 		if (sharecount < threshold) throw "share threshold must be equal or greater than total share count";
 		if (threshold == 0) throw "threshold must be greater than zero";
-		std::vector<uint8_t> chcksmd(checksummed16(msg).serialize());
-	
-		std::vector< std::vector<Shamir::xy_point> > share_coll(chcksmd.size());
-		for (auto j=0u; j<chcksmd.size(); ++j) {
-			GFpolynomial sharepoly(chcksmd[j], threshold - 1);
-			for (unsigned i = 1; i <= sharecount; ++i) {
-				share_coll[j].push_back(sharepoly.getShare(i));
+		if (sharecount > 32) throw "share count must be at most 32"; /// share index has 5 bits
+		if (length == 0) throw "secret must not be empty";
+		const size_t row = length + 2;
+		uint8_t * ys = static_cast<uint8_t *>(arena.allocate(row * sharecount));
+		const Shamir::evaluate_kernel evaluate = Shamir::evaluate_for(threshold);
+		auto columns = [ys, row, &arena, &source, threshold, sharecount, evaluate] (const uint8_t * data, size_t begin, size_t end) {
+			/// random coefficients of a block of columns are drawn at once
+			const size_t block = 64;
+			uint8_t * coefficients = static_cast<uint8_t *>(arena.allocate(block * threshold));
+			for (size_t first = begin; first < end; first += block) {
+				const size_t last = std::min(end, first + block);
+				random_fill(source, first * threshold, coefficients, (last - first) * threshold);
+				for (size_t j = first; j < last; ++j) {
+					uint8_t * c = coefficients + (j - first) * threshold;
+					c[0] = data[j - begin];
+					for (unsigned i = 0; i < sharecount; ++i) ys[i * row + j] = evaluate(c, i + 1);
+				}
 			}
+		};
+
+		uint8_t checksum[2];
+		const size_t chunk = std::max<size_t>(1024, parallel_chunk / (sharecount + 1));
+		if (workers.size() == 1 || length <= chunk) {
+			/// nothing to overlap, typical for mnemonic sized secrets
+			checksum16(msg, length, checksum);
+			columns(msg, 0, length);
+			columns(checksum, length, length + 2);
+			return ys;
 		}
-	
-		std::vector< std::vector<uint8_t> > final_shares;
-		for (auto index = 0u; index < sharecount; ++index) {
-			std::vector<uint8_t> tmp_container;
-			for (auto i = 0u; i < chcksmd.size(); ++i) {
-				if (share_coll[i][index].first != index + 1) throw "inconsistent share indexing";
-				tmp_container.push_back(share_coll[i][index].second);
+		thread_pool::group hashing(workers);
+		hashing.run([msg, length, &checksum] { checksum16(msg, length, checksum); });
+		workers.parallel_for(0, length, chunk, [msg, &columns] (size_t begin, size_t end) {
+			columns(msg + begin, begin, end);
+		});
+		hashing.wait();
+		columns(checksum, length, length + 2);
+		return ys;
+	}
+
+	/**
+	 * restores secret column by column from parsed shares; column ranges are interpolated in parallel
+	 * and hashed in order as soon as they are finished, so checksum is ready shortly after the last column.
+	 */
+	Shamir::status reconstructColumns(thread_pool & workers, const std::vector<const uint8_t *> & shares, size_t share_length, std::vector<uint8_t> & secret) {
+		const size_t length = share_length - 4;
+		if (length < 3) return Shamir::status::secret_checksum;
+		const size_t chunk = std::max<size_t>(1024, parallel_chunk / (shares.size() + 1));
+		const size_t chunks = (length + chunk - 1) / chunk;
+		if (shares.size() > 32) return Shamir::status::duplicate_indices;
+		secret.resize(length);
+		/// Lagrange weights depend only on share indices, every column is just their dot product with its bytes
+		uint8_t xs[32], weights[32];
+		for (size_t i = 0; i < shares.size(); ++i) {
+			unsigned index, threshold;
+			Shamir::read_share_header(shares[i], index, threshold);
+			xs[i] = index;
+		}
+		Shamir::lagrange_weights(xs, shares.size(), weights);
+		const Shamir::interpolate_kernel dot = Shamir::interpolate_for(shares.size());
+		auto interpolate = [&secret, &shares, &weights, dot] (size_t begin, size_t end) {
+			uint8_t ys[32];
+			for (size_t j = begin; j < end; ++j) {
+				for (size_t i = 0; i < shares.size(); ++i) ys[i] = Shamir::get_share_column(shares[i], j);
+				secret[j] = dot(weights, ys);
+			}
+		};
+		uint8_t checksum[2];
+		if (workers.size() == 1 || chunks == 1) {
+			interpolate(0, length);
+			checksum16(secret.data(), length - 2, checksum);
+			if (checksum[0] != secret[length - 2] || checksum[1] != secret[length - 1]) return Shamir::status::secret_checksum;
+			secret.resize(length - 2);
+			return Shamir::status::ok;
+		}
+		std::vector<bool> finished(chunks, false);
+		bool aborted(false);
+		std::mutex progress_mutex;
+		std::condition_variable progress;
+
+		thread_pool::group hashing(workers);
+		hashing.run([&] {
+			CSHA256 h;
+			uint8_t hash[CSHA256::OUTPUT_SIZE];
+			for (size_t c = 0; c < chunks; ++c) {
+				{
+					std::unique_lock<std::mutex> lock(progress_mutex);
+					progress.wait(lock, [&] { return finished[c] || aborted; });
+					if (aborted) return;
+				}
+				const size_t begin = c * chunk, end = std::min(length - 2, (c + 1) * chunk);
+				if (begin < end) h.Write(secret.data() + begin, end - begin);
 			}
-			checksummed16 share_packet = Shamir::make_share(index + 1, threshold, tmp_container);
-			final_shares.push_back(share_packet.serialize());
+			h.Finalize(hash);
+			checksum[0] = hash[0];
+			checksum[1] = hash[1];
+		});
+		try {
+			workers.parallel_for(0, length, chunk, [&] (size_t begin, size_t end) {
+				interpolate(begin, end);
+				std::lock_guard<std::mutex> lock(progress_mutex);
+				finished[begin / chunk] = true;
+				progress.notify_all();
+			});
+		} catch (...) {
+			{
+				std::lock_guard<std::mutex> lock(progress_mutex);
+				aborted = true;
+				progress.notify_all();
+			}
+			try {
+				hashing.wait();
+			} catch (...) {}
+			throw;
 		}
+		hashing.wait();
+		if (checksum[0] != secret[length - 2] || checksum[1] != secret[length - 1]) return Shamir::status::secret_checksum;
+		secret.resize(length - 2);
+		return Shamir::status::ok;
+	}
+} // anonymous namespace
+
+namespace Shamir {
+	size_t share_size(size_t secret_length) {
+		/// 10 bits index and threshold, secret with its 16 bit checksum, 16 bits share checksum
+		return (10 + (secret_length + 2) * 8 + 16 + 7) / 8;
+	}
+
+	std::vector< std::vector<uint8_t> >  distribute(const std::vector<uint8_t> & msg, unsigned threshold, unsigned sharecount, const random_source & source) {
+		std::vector< std::vector<uint8_t> > final_shares(sharecount, std::vector<uint8_t>(share_size(msg.size())));
+		std::vector<uint8_t *> outputs;
+		for (auto && i: final_shares) outputs.push_back(i.data());
+		distribute(msg.data(), msg.size(), threshold, outputs, source);
 		return final_shares;
 	} // distribute func
+
+	void distribute(const uint8_t * msg, size_t length, unsigned threshold, const std::vector<uint8_t *> & outputs, const random_source & source) {
+		const std::shared_ptr<thread_pool> snapshot = shared_pool();
+		thread_pool & workers = *snapshot;
+		arena_scope scope(thread_arena());
+		const uint8_t * ys = distributeColumns(workers, thread_arena(), msg, length, threshold, outputs.size(), source);
+		workers.parallel_for(0, outputs.size(), 1, [&] (size_t begin, size_t end) {
+			for (size_t index = begin; index < end; ++index) Shamir::frame_share(index + 1, threshold, ys + index * (length + 2), length + 2, outputs[index]);
+		});
+	} // distribute func
+
+	void distribute(const uint8_t * msg, size_t length, unsigned threshold, unsigned sharecount, const share_sink & sink, const random_source & source) {
+		arena_scope scope(thread_arena());
+		const uint8_t * ys = distributeColumns(*shared_pool(), thread_arena(), msg, length, threshold, sharecount, source);
+		uint8_t * buffer = static_cast<uint8_t *>(thread_arena().allocate(share_size(length)));
+		for (auto index = 0u; index < sharecount; ++index) {
+			Shamir::frame_share(index + 1, threshold, ys + index * (length + 2), length + 2, buffer);
+			sink(index, buffer, share_size(length));
+		}
+	} // distribute func
 	
 	std::vector<uint8_t> reconstruct(const std::vector<std::vector<uint8_t>> & share_list) {
-		checkSameLengths(share_list);
-		checkDistinctIndicesSameThresholds(share_list);
-	
-		std::vector<std::vector<Shamir::xy_point>> plain_shares;
-		std::vector<uint16_t> indices;
-		for (auto && i: share_list) {
-			share tmp_cont(i);
-			for (size_t j = 0; j < tmp_cont.data.size(); ++j) {
-				while (plain_shares.size() < j+1) plain_shares.push_back(std::vector<Shamir::xy_point>());
-				plain_shares[j].push_back(Shamir::xy_point(tmp_cont.index, tmp_cont.data[j]));
-			}
-		}
-		std::vector<uint8_t> secret_cont;
-		for (auto && i: plain_shares) {
-			GFpolynomial recoveryPoly(i);
-			secret_cont.push_back(recoveryPoly.getSecret());
-		}
-		checksummed16 output(secret_cont);
-		if (output.deserialize() == false) throw "Secret message checksum verification failed. Message possibly corrupted.";
-		return output;
+		return try_reconstruct(share_list).value();
+	}
+
+	std::vector<uint8_t> reconstruct(const std::vector<const uint8_t *> & share_list, size_t share_length) {
+		return try_reconstruct(share_list, share_length).value();
 	} // reconstruct func
+
+	result<std::vector<uint8_t>> try_reconstruct(const std::vector<std::vector<uint8_t>> & share_list) {
+		const status same = checkSameLengths(share_list);
+		if (same != status::ok) return same;
+		std::vector<const uint8_t *> views;
+		for (auto && i: share_list) views.push_back(i.data());
+		return try_reconstruct(views, share_list.empty() ? 0 : share_list[0].size());
+	}
+
+	result<std::vector<uint8_t>> try_reconstruct(const std::vector<const uint8_t *> & share_list, size_t share_length) {
+		if (share_list.empty()) return status::not_enough_shares;
+		if (share_length < 5) return status::invalid_share;
+		const status set = checkDistinctIndicesSameThresholds(share_list);
+		if (set != status::ok) return set;
+
+		const std::shared_ptr<thread_pool> snapshot = shared_pool();
+		thread_pool & workers = *snapshot;
+		/// packets are verified in place and columns are read from them directly, nothing is copied
+		std::atomic<bool> corrupted(false);
+		workers.parallel_for(0, share_list.size(), 1, [&] (size_t begin, size_t end) {
+			for (size_t i = begin; i < end && !corrupted; ++i) {
+				unsigned index, threshold;
+				if (!Shamir::open_share_packet(share_list[i], share_length, index, threshold)) corrupted = true;
+			}
+		});
+		if (corrupted) return status::share_checksum;
+		std::vector<uint8_t> secret;
+		const status restored = reconstructColumns(workers, share_list, share_length, secret);
+		if (restored != status::ok) return restored;
+		return std::move(secret);
+	}
+
+	void set_thread_count(unsigned threads) {
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		if (threads == pool_threads && pool) return;
+		pool_threads = threads;
+		pool.reset();
+	}
+
+	unsigned thread_count() {
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		return pool_threads;
+	}
 } // Shamir namespace
@@ -1,12 +1,68 @@
 #ifndef SHAMIRMULTI
 #define SHAMIRMULTI
 
+#include <multiblock.h>
+#include <get_insecure_randomness.h>
+#include <shamirstatus.h>
+
 #include <vector>
+#include <array>
 #include <cstdint>
+#include <cstddef>
+#include <functional>
 
 namespace Shamir {
+	typedef std::function<void(unsigned index, const uint8_t * share, size_t length)> share_sink; // index counts from 0
+	size_t share_size(size_t secret_length); // length in bytes of every share produced for secret of 'secret_length' bytes
 	std::vector<uint8_t> reconstruct(const std::vector<std::vector<uint8_t>> & share_list);
-	std::vector< std::vector<uint8_t> >  distribute(const std::vector<uint8_t> & msg, unsigned threshold, unsigned sharecount);
+	std::vector<uint8_t> reconstruct(const std::vector<const uint8_t *> & share_list, size_t share_length); // shares are read in place
+	/// non-throwing reconstruct for bulk validation, failures are reported as status, see shamirstatus.h
+	result<std::vector<uint8_t>> try_reconstruct(const std::vector<std::vector<uint8_t>> & share_list);
+	result<std::vector<uint8_t>> try_reconstruct(const std::vector<const uint8_t *> & share_list, size_t share_length);
+	/// 'source' of random coefficients defaults to system randomness, see get_insecure_randomness.h
+	std::vector< std::vector<uint8_t> >  distribute(const std::vector<uint8_t> & msg, unsigned threshold, unsigned sharecount,
+			const random_source & source = random_source());
+	void distribute(const uint8_t * msg, size_t length, unsigned threshold, const std::vector<uint8_t *> & outputs,
+			const random_source & source = random_source()); // writes share_size(length) bytes to each output
+	void distribute(const uint8_t * msg, size_t length, unsigned threshold, unsigned sharecount, const share_sink & sink,
+			const random_source & source = random_source()); // passes every share to sink as soon as it is framed
+	/// distribute and reconstruct split byte columns of large secrets among 'threads' threads, 0 ... one per hardware thread, default 1; calls already running finish on the previous pool
+	void set_thread_count(unsigned threads);
+	unsigned thread_count();
+
+	/**
+	 * fixed size path for mnemonic sized secrets (BIP39 entropy is 16, 20, 24, 28 or 32 bytes):
+	 * shares are framed in std::array storage of the caller, nothing is allocated unless an error is thrown.
+	 */
+	template <size_t N>
+	using fixed_share = std::array<uint8_t, N + 6>; // share_size(N)
+
+	/// writes 'sharecount' shares to shares[0 .. sharecount - 1]
+	template <size_t N>
+	void distribute(const std::array<uint8_t, N> & msg, unsigned threshold, unsigned sharecount, fixed_share<N> * shares,
+			const random_source & source = random_source()) {
+		static_assert(N > 0, "secret must not be empty");
+		static_assert(sizeof(fixed_share<N>) == N + 6, "shares must be contiguous packets");
+		if (sharecount < threshold) throw "share threshold must be equal or greater than total share count";
+		if (threshold == 0) throw "threshold must be greater than zero";
+		if (sharecount > 32) throw "share count must be at most 32";
+		distribute_packets(msg.data(), N, threshold, sharecount, shares[0].data(), sizeof(fixed_share<N>), source);
+	}
+
+	template <size_t N, size_t Count>
+	std::array<fixed_share<N>, Count> distribute(const std::array<uint8_t, N> & msg, unsigned threshold, const random_source & source = random_source()) {
+		std::array<fixed_share<N>, Count> shares;
+		distribute<N>(msg, threshold, Count, shares.data(), source);
+		return shares;
+	}
+
+	/// restores secret from 'count' shares, e.g. reconstruct<16>(shares, 3)
+	template <size_t N>
+	std::array<uint8_t, N> reconstruct(const fixed_share<N> * shares, size_t count) {
+		std::array<uint8_t, N> secret;
+		check(reconstruct_packets(shares[0].data(), count, N + 6, sizeof(fixed_share<N>), secret.data()));
+		return secret;
+	}
 }
 
 #endif
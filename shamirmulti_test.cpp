@@ -3,13 +3,221 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <new>
+#include <cstdlib>
+#include <cassert>
 
 namespace {
 	std::ostream & myout (std::ostream & ost) { return ost << std::hex << std::setfill('0') << std::setw(2); }
+
+	/// every heap allocation of the test program goes through operator new below
+	std::atomic<size_t> allocations(0);
+}
+
+void * operator new(size_t size) {
+	++allocations;
+	if (void * p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept {
+	std::free(p);
+}
+
+/// shares made with any thread count restore the secret with any other thread count
+void test_thread_counts() {
+	std::vector<uint8_t> secret((1 << 19) + 17);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 31 % 253);
+	for (unsigned threads: {1u, 3u, 8u}) {
+		Shamir::set_thread_count(threads);
+		auto shares = Shamir::distribute(secret, 3, 5);
+		assert(shares.size() == 5);
+		for (auto && s: shares) assert(s.size() == Shamir::share_size(secret.size()));
+		Shamir::set_thread_count(threads == 1 ? 4 : 1);
+		std::vector<std::vector<uint8_t>> subset = {shares[4], shares[0], shares[2]};
+		assert(Shamir::reconstruct(subset) == secret);
+		subset[1][100] ^= 1;
+		try {
+			Shamir::reconstruct(subset);
+			assert(false);
+		} catch (const char * s) {
+			assert(std::string(s) == "checksum verification failed");
+		}
+	}
+	Shamir::set_thread_count(1);
+	try {
+		Shamir::distribute(secret, 2, 33);
+		assert(false);
+	} catch (const char * s) {
+		assert(std::string(s) == "share count must be at most 32");
+	}
+	std::cout << "multithreaded distribute and reconstruct: passed" << std::endl;
+}
+
+/// thread count changed while other threads distribute and reconstruct, they finish on the pool they started with
+void test_reconfigure() {
+	std::vector<uint8_t> secret((1 << 19) + 3, 0x5a);
+	std::atomic<bool> done(false);
+	std::vector<std::thread> users;
+	for (int u = 0; u < 2; ++u) users.push_back(std::thread([&secret] {
+		for (int round = 0; round < 20; ++round) {
+			auto shares = Shamir::distribute(secret, 2, 3);
+			assert(Shamir::reconstruct(std::vector<std::vector<uint8_t>>{shares[2], shares[0]}) == secret);
+		}
+	}));
+	std::thread configure([&done] {
+		for (unsigned threads = 1; !done; threads = threads % 6 + 1) Shamir::set_thread_count(threads);
+	});
+	for (auto && u: users) u.join();
+	done = true;
+	configure.join();
+	Shamir::set_thread_count(1);
+	std::cout << "thread count changed while in use: passed" << std::endl;
+}
+
+/// fixed size secrets are split and restored without a single allocation and interoperate with vector interface
+template <size_t N>
+void check_fixed() {
+	std::array<uint8_t, N> secret;
+	for (size_t i = 0; i < N; ++i) secret[i] = (uint8_t) (i * 29 + N);
+	std::array<Shamir::fixed_share<N>, 5> shares;
+	std::array<Shamir::fixed_share<N>, 3> subset;
+	std::array<uint8_t, N> restored;
+	/// on a fresh thread, so nothing set up by the first draw of a thread is left from earlier tests
+	std::thread fresh([&] {
+		const size_t before = allocations;
+		shares = Shamir::distribute<N, 5>(secret, 3);
+		subset = {{shares[4], shares[1], shares[2]}};
+		restored = Shamir::reconstruct<N>(subset.data(), subset.size());
+		assert(allocations == before);
+	});
+	fresh.join();
+	assert(restored == secret);
+
+	std::vector<std::vector<uint8_t>> copies;
+	for (auto && s: shares) copies.emplace_back(s.begin(), s.end());
+	copies.resize(3);
+	assert(Shamir::reconstruct(copies) == std::vector<uint8_t>(secret.begin(), secret.end()));
+	auto vector_shares = Shamir::distribute(std::vector<uint8_t>(secret.begin(), secret.end()), 2, 4);
+	std::array<Shamir::fixed_share<N>, 2> pair;
+	std::copy(vector_shares[3].begin(), vector_shares[3].end(), pair[0].begin());
+	std::copy(vector_shares[0].begin(), vector_shares[0].end(), pair[1].begin());
+	assert(Shamir::reconstruct<N>(pair.data(), 2) == secret);
+
+	subset[0][7] ^= 2;
+	try {
+		Shamir::reconstruct<N>(subset.data(), subset.size());
+		assert(false);
+	} catch (const char * s) {
+		assert(std::string(s) == "checksum verification failed");
+	}
+
+	/// invalid sets fail with the messages of the vector interface
+	subset[0] = shares[1];
+	for (size_t count: {size_t(3), size_t(2)}) {
+		std::vector<std::vector<uint8_t>> same;
+		for (size_t i = 0; i < count; ++i) same.emplace_back(subset[i].begin(), subset[i].end());
+		std::string expected;
+		try {
+			Shamir::reconstruct(same);
+		} catch (const char * s) {
+			expected = s;
+		}
+		try {
+			Shamir::reconstruct<N>(subset.data(), count);
+			assert(false);
+		} catch (const char * s) {
+			assert(std::string(s) == expected);
+		}
+	}
+}
+
+void test_fixed_sizes() {
+	check_fixed<16>();
+	check_fixed<20>();
+	check_fixed<24>();
+	check_fixed<28>();
+	check_fixed<32>();
+	std::cout << "allocation free fixed size secrets: passed" << std::endl;
+}
+
+/// non-throwing reconstruct reports the failure the throwing one throws
+void test_status() {
+	std::vector<uint8_t> secret(100, 7);
+	auto shares = Shamir::distribute(secret, 2, 3);
+	auto restored = Shamir::try_reconstruct(shares);
+	assert(restored && restored.value() == secret);
+
+	auto expect = [] (const std::vector<std::vector<uint8_t>> & set, Shamir::status expected) {
+		auto r = Shamir::try_reconstruct(set);
+		assert(!r && r.error() == expected);
+		try {
+			Shamir::reconstruct(set);
+			assert(false);
+		} catch (const char * s) {
+			assert(std::string(s) == Shamir::message(expected));
+		}
+	};
+	auto corrupted = shares;
+	corrupted[1][40] ^= 8;
+	expect(corrupted, Shamir::status::share_checksum);
+	expect({shares[0]}, Shamir::status::not_enough_shares);
+	expect({shares[0], shares[0]}, Shamir::status::duplicate_indices);
+	expect({shares[0], std::vector<uint8_t>(shares[1].begin(), shares[1].end() - 1)}, Shamir::status::different_lengths);
+	expect({{1, 2, 3}, {4, 5, 6}}, Shamir::status::invalid_share);
+	expect({}, Shamir::status::not_enough_shares);
+	std::cout << "non-throwing reconstruct statuses: passed" << std::endl;
+}
+
+/// seeded source gives bit-identical shares on every engine, thread count and chunking
+void test_seeded() {
+	const random_source seeded = seeded_random_source(20240601);
+	std::vector<uint8_t> secret((1 << 18) + 3);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 13 % 251);
+	Shamir::set_thread_count(1);
+	auto reference = Shamir::distribute(secret, 4, 6, seeded);
+	Shamir::set_thread_count(5);
+	assert(Shamir::distribute(secret, 4, 6, seeded) == reference);
+	assert(Shamir::distribute(secret, 4, 6, seeded_random_source(20240602)) != reference);
+	assert(Shamir::distribute(secret, 4, 6) != reference);
+	Shamir::set_thread_count(1);
+
+	std::vector<uint8_t> packets(6 * Shamir::share_size(secret.size()));
+	Shamir::distribute_packets(secret.data(), secret.size(), 4, 6, packets.data(), Shamir::share_size(secret.size()), seeded);
+	for (size_t i = 0; i < reference.size(); ++i) assert(std::equal(reference[i].begin(), reference[i].end(), packets.begin() + i * reference[i].size()));
+
+	std::array<uint8_t, 16> mnemonic_secret;
+	std::copy(secret.begin(), secret.begin() + 16, mnemonic_secret.begin());
+	auto fixed = Shamir::distribute<16, 3>(mnemonic_secret, 2, seeded);
+	auto vectors = Shamir::distribute(std::vector<uint8_t>(secret.begin(), secret.begin() + 16), 2, 3, seeded);
+	for (size_t i = 0; i < fixed.size(); ++i) assert(std::equal(fixed[i].begin(), fixed[i].end(), vectors[i].begin()));
+
+	set_random_source(seeded);
+	assert(Shamir::distribute(secret, 4, 6) == reference);
+	set_random_source(random_source());
+	assert(Shamir::distribute(secret, 4, 6) != reference);
+	std::cout << "seeded coefficients reproducible across engines: passed" << std::endl;
 }
 
 int main() {
 	uint8_t asdf(64);
-	std::cout << myout << (int) asdf;
+	std::cout << myout << (int) asdf << std::dec << std::endl;
+	try {
+		test_thread_counts();
+		test_reconfigure();
+		test_fixed_sizes();
+		test_status();
+		test_seeded();
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
 	return 0;
 }
@@ -0,0 +1,71 @@
+#ifndef SHAMIRSTATUS
+#define SHAMIRSTATUS
+
+#include <utility>
+
+/**
+ * error codes of the non-throwing API (functions starting with try_), meant for bulk validation
+ * where most candidates are invalid and unwinding an exception for each of them would dominate.
+ * Throwing functions are wrappers throwing message(status) of the same failure, so messages
+ * are identical in both APIs.
+ */
+namespace Shamir {
+	enum class status {
+		ok,
+		invalid_share,       // packet too short to hold header and checksum
+		share_checksum,      // packet checksum does not match
+		different_lengths,   // shares of one set differ in length
+		different_thresholds,
+		not_enough_shares,
+		duplicate_indices,
+		secret_checksum,     // restored secret does not match its checksum
+		bip39_checksum,
+		unknown_slip39_word,
+		unknown_bip39_word
+	};
+
+	inline const char * message(status s) {
+		switch (s) {
+			case status::ok: return "ok";
+			case status::invalid_share: return "invalid share packet";
+			case status::share_checksum: return "checksum verification failed";
+			case status::different_lengths: return "Shares do not have same length";
+			case status::different_thresholds: return "Shares do not signal same threshold";
+			case status::not_enough_shares: return "Not enough shares supplied";
+			case status::duplicate_indices: return "Share indices are not distinct";
+			case status::secret_checksum: return "Secret message checksum verification failed. Message possibly corrupted.";
+			case status::bip39_checksum: return "BIP39 checksum verification failed";
+			case status::unknown_slip39_word: return "Given word not in SLIP39 dictionary\n";
+			case status::unknown_bip39_word: return "Given word not in BIP39 dictionary\n";
+		}
+		return "unknown error";
+	}
+
+	/// bridge to the throwing API
+	inline void check(status s) {
+		if (s != status::ok) throw message(s);
+	}
+
+	/// value or status of the failure, value() throws as the throwing API would
+	template <typename T>
+	class result {
+		private:
+			status m_status;
+			T m_value;
+		public:
+			result(status s) : m_status(s), m_value() {}
+			result(T && value) : m_status(status::ok), m_value(std::move(value)) {}
+			explicit operator bool() const { return m_status == status::ok; }
+			status error() const { return m_status; }
+			T & value() & {
+				check(m_status);
+				return m_value;
+			}
+			T && value() && {
+				check(m_status);
+				return std::move(m_value);
+			}
+	};
+}
+
+#endif
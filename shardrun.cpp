@@ -0,0 +1,312 @@
+#include <shardrun.h>
+#include <batch.h>
+#include <sharefile.h>
+#include <threadpool.h>
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+namespace {
+	const char checkpoint_magic[] = "shamir-shards 2";
+
+	/// stream reading straight from the mapped input, no copy per worker
+	class memory_buffer: public std::streambuf {
+		public:
+			memory_buffer(const char * begin, const char * end) {
+				setg(const_cast<char *>(begin), const_cast<char *>(begin), const_cast<char *>(end));
+			}
+	};
+
+	struct shard_range {
+		size_t begin, end, first_record;
+	};
+
+	bool blank_line(const char * begin, const char * end) {
+		for (; begin < end; ++begin) {
+			if (*begin != ' ' && *begin != '\t' && *begin != '\r') return false;
+		}
+		return true;
+	}
+
+	/// calls found(offset) for the first line of every record, records are delimited the same way as in run_batch
+	template <typename Found>
+	void for_each_record(const char * data, size_t size, bool blocks, Found found) {
+		bool inside(false);
+		size_t pos = 0;
+		while (pos < size) {
+			const char * newline = static_cast<const char *>(std::memchr(data + pos, '\n', size - pos));
+			const size_t end = newline != nullptr ? newline - data : size;
+			if (blank_line(data + pos, data + end)) {
+				inside = false;
+			} else {
+				if (!blocks || !inside) found(pos);
+				inside = true;
+			}
+			pos = end + 1;
+		}
+	}
+
+	/// 'count' ranges holding equal numbers of records (up to one), starting at record boundaries
+	std::vector<shard_range> plan_shards(const char * data, size_t size, bool blocks, unsigned count) {
+		size_t total(0);
+		for_each_record(data, size, blocks, [&total] (size_t) { ++total; });
+		std::vector<shard_range> shards(count);
+		size_t record(0);
+		unsigned next(0);
+		for_each_record(data, size, blocks, [&] (size_t offset) {
+			while (next < count && record >= total * next / count) {
+				shards[next].begin = offset;
+				shards[next].first_record = record;
+				++next;
+			}
+			++record;
+		});
+		for (; next < count; ++next) {
+			shards[next].begin = size;
+			shards[next].first_record = total;
+		}
+		for (unsigned i = 0; i < count; ++i) shards[i].end = (i + 1 < count) ? shards[i + 1].begin : size;
+		return shards;
+	}
+
+	std::string shard_path(const std::string & output, unsigned index) {
+		return output + ".shard" + std::to_string(index + 1);
+	}
+
+	void sync_path(const std::string & path, bool directory) {
+		int fd = open(path.c_str(), O_RDONLY | (directory ? O_DIRECTORY : 0));
+		if (fd < 0) throw "Cannot open file to flush";
+		const int result = fsync(fd);
+		close(fd);
+		if (result != 0) throw "Cannot flush file";
+	}
+
+	std::string directory_of(const std::string & path) {
+		const size_t slash = path.rfind('/');
+		if (slash == std::string::npos) return ".";
+		return slash == 0 ? "/" : path.substr(0, slash);
+	}
+
+	/// writes file under temporary name and renames it, so readers see either old or new version
+	void replace_file(const std::string & path, const std::string & content) {
+		const std::string temp(path + ".tmp");
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			out << content;
+			out.close();
+			if (!out) throw "Cannot write checkpoint";
+		}
+		sync_path(temp, false);
+		if (std::rename(temp.c_str(), path.c_str()) != 0) throw "Cannot rename checkpoint";
+		sync_path(directory_of(path), true);
+	}
+
+	/// input file as the checkpoint knows it, an edit keeping the length still changes modification time
+	struct input_identity {
+		uint64_t size, device, inode, seconds, nanoseconds;
+
+		bool operator == (const input_identity & other) const {
+			return size == other.size && device == other.device && inode == other.inode && seconds == other.seconds && nanoseconds == other.nanoseconds;
+		}
+	};
+
+	input_identity identify(const std::string & path) {
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0) throw "Cannot stat input file";
+		return input_identity{static_cast<uint64_t>(st.st_size), static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+			static_cast<uint64_t>(st.st_mtim.tv_sec), static_cast<uint64_t>(st.st_mtim.tv_nsec)};
+	}
+
+	struct checkpoint {
+		input_identity input;
+		unsigned shards;
+		bool blocks;
+		std::vector<bool> finished;
+		std::vector<Shamir::shard_stats> stats;
+		size_t merged, merged_bytes; // shards appended to output so far and its length after them
+
+		checkpoint(const input_identity & id, unsigned count, bool b) : input(id), shards(count), blocks(b), finished(count, false),
+				stats(count, Shamir::shard_stats()), merged(0), merged_bytes(0) {}
+
+		std::string serialize() const {
+			std::string s(std::string(checkpoint_magic) + "\n");
+			s += "input " + std::to_string(input.size) + " " + std::to_string(input.device) + " " + std::to_string(input.inode) + " "
+				+ std::to_string(input.seconds) + " " + std::to_string(input.nanoseconds) + " shards " + std::to_string(shards) + " blocks " + (blocks ? "1" : "0") + "\n";
+			for (unsigned i = 0; i < shards; ++i) {
+				if (!finished[i]) continue;
+				s += "shard " + std::to_string(i) + " " + std::to_string(stats[i].first_record) + " " + std::to_string(stats[i].records) + " "
+					+ std::to_string(stats[i].failed) + " " + std::to_string(stats[i].seconds) + "\n";
+			}
+			s += "merged " + std::to_string(merged) + " " + std::to_string(merged_bytes) + "\n";
+			return s;
+		}
+
+		/// false when there is no checkpoint or it belongs to another run
+		bool load(const std::string & path) {
+			std::ifstream in(path);
+			if (!in) return false;
+			std::string line, word;
+			if (!std::getline(in, line) || line != checkpoint_magic) return false;
+			input_identity id;
+			unsigned count, b;
+			if (!(in >> word >> id.size >> id.device >> id.inode >> id.seconds >> id.nanoseconds) || word != "input"
+					|| !(in >> word >> count) || word != "shards" || !(in >> word >> b) || word != "blocks") return false;
+			if (!(id == input) || count != shards || (b != 0) != blocks) return false;
+			while (in >> word) {
+				if (word == "merged") return static_cast<bool>(in >> merged >> merged_bytes) && merged <= shards;
+				unsigned i;
+				Shamir::shard_stats s = Shamir::shard_stats();
+				if (word != "shard" || !(in >> i >> s.first_record >> s.records >> s.failed >> s.seconds) || i >= shards) return false;
+				s.resumed = true;
+				finished[i] = true;
+				stats[i] = s;
+			}
+			return false;
+		}
+	};
+
+	/// body of a forked worker, returns its exit status
+	int run_shard(const char * data, const shard_range & range, const std::string & path, unsigned threads, bool blocks,
+			const std::string & separator, const Shamir::group_handler & handler, Shamir::shard_stats & report) {
+		try {
+			memory_buffer buffer(data + range.begin, data + range.end);
+			std::istream input(&buffer);
+			std::ofstream output(path + ".tmp", std::ios::binary | std::ios::trunc);
+			if (!output) throw "Cannot create shard output";
+			thread_pool pool(threads);
+			auto stats = Shamir::run_batch(input, output, blocks, separator, handler, pool, 1 << 14, range.first_record);
+			output.close();
+			if (!output) throw "Cannot write shard output";
+			sync_path(path + ".tmp", false);
+			if (std::rename((path + ".tmp").c_str(), path.c_str()) != 0) throw "Cannot rename shard output";
+			report.first_record = range.first_record;
+			report.records = stats.records;
+			report.failed = stats.failed;
+			report.seconds = stats.seconds;
+			return 0;
+		} catch (const char * s) {
+			std::cerr << path << ": " << s << std::endl;
+			return 1;
+		}
+	}
+
+	/// appends whole file to fd, returns number of bytes
+	size_t append_file(int fd, const std::string & path) {
+		int in = open(path.c_str(), O_RDONLY);
+		if (in < 0) throw "Cannot open shard output";
+		std::vector<char> buffer(1 << 20);
+		size_t total(0);
+		while (true) {
+			const ssize_t r = read(in, buffer.data(), buffer.size());
+			if (r < 0) {
+				close(in);
+				throw "Cannot read shard output";
+			}
+			if (r == 0) break;
+			for (ssize_t written = 0; written < r; ) {
+				const ssize_t w = write(fd, buffer.data() + written, r - written);
+				if (w < 0) {
+					close(in);
+					throw "Cannot write merged output";
+				}
+				written += w;
+			}
+			total += r;
+		}
+		close(in);
+		return total;
+	}
+} // anonymous namespace
+
+namespace Shamir {
+	sharded_stats run_sharded_batch(const std::string & input, const std::string & output, unsigned processes, unsigned threads,
+			bool blocks, const std::string & separator, const record_handler & handler) {
+		return run_sharded_batch(input, output, processes, threads, blocks, separator, each_record(handler));
+	}
+
+	sharded_stats run_sharded_batch(const std::string & input, const std::string & output, unsigned processes, unsigned threads,
+			bool blocks, const std::string & separator, const group_handler & handler) {
+		if (processes == 0) processes = 1;
+		mapped_file mapping(input);
+		static const char empty = 0;
+		const char * data = mapping.size() > 0 ? reinterpret_cast<const char *>(mapping.data()) : &empty;
+		const auto ranges = plan_shards(data, mapping.size(), blocks, processes);
+		const std::string checkpoint_path(output + ".checkpoint");
+		const input_identity identity = identify(input);
+		checkpoint progress(identity, processes, blocks);
+		if (!progress.load(checkpoint_path)) progress = checkpoint(identity, processes, blocks);
+
+		/// workers report their statistics through anonymous shared memory
+		void * shared = mmap(nullptr, processes * sizeof(shard_stats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if (shared == MAP_FAILED) throw "Cannot map shared memory";
+		shard_stats * reports = static_cast<shard_stats *>(shared);
+		std::vector<pid_t> workers(processes, -1);
+		bool failed(false);
+		std::cout.flush();
+		std::cerr.flush();
+		std::fflush(nullptr);
+		for (unsigned i = 0; i < processes; ++i) {
+			if (i < progress.merged || progress.finished[i]) continue;
+			reports[i] = shard_stats();
+			const pid_t pid = fork();
+			if (pid == 0) _exit(run_shard(data, ranges[i], shard_path(output, i), threads, blocks, separator, handler, reports[i]));
+			if (pid < 0) failed = true;
+			workers[i] = pid;
+		}
+		for (unsigned i = 0; i < processes; ++i) {
+			if (workers[i] <= 0) continue;
+			int status;
+			if (waitpid(workers[i], &status, 0) != workers[i] || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				failed = true;
+				continue;
+			}
+			progress.finished[i] = true;
+			progress.stats[i] = reports[i];
+			progress.stats[i].resumed = false;
+		}
+		munmap(shared, processes * sizeof(shard_stats));
+		replace_file(checkpoint_path, progress.serialize());
+		if (failed) throw "Shard worker failed, run again to resume from checkpoint";
+
+		auto merge_start = std::chrono::steady_clock::now();
+		int fd = open(output.c_str(), O_WRONLY | O_CREAT, 0644);
+		if (fd < 0) throw "Cannot open merged output";
+		try {
+			/// drops whatever an interrupted merge appended after the last recorded shard
+			if (ftruncate(fd, progress.merged_bytes) != 0 || lseek(fd, progress.merged_bytes, SEEK_SET) < 0) throw "Cannot resume merged output";
+			for (unsigned i = progress.merged; i < processes; ++i) {
+				const size_t bytes = append_file(fd, shard_path(output, i));
+				if (fsync(fd) != 0) throw "Cannot flush merged output";
+				progress.merged = i + 1;
+				progress.merged_bytes += bytes;
+				replace_file(checkpoint_path, progress.serialize());
+				unlink(shard_path(output, i).c_str());
+			}
+		} catch (const char *) {
+			close(fd);
+			throw;
+		}
+		close(fd);
+		unlink(checkpoint_path.c_str());
+
+		sharded_stats stats = sharded_stats();
+		stats.shards = progress.stats;
+		for (auto && s: stats.shards) {
+			stats.records += s.records;
+			stats.failed += s.failed;
+		}
+		stats.merge_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - merge_start).count();
+		return stats;
+	}
+}
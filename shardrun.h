@@ -0,0 +1,42 @@
+#ifndef SHARDRUN
+#define SHARDRUN
+
+#include <batch.h>
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/**
+ * batch over several processes for inputs too large for one.
+ * Input file is mapped and cut into shards of consecutive records, every shard is processed by
+ * a forked worker process running run_batch over its part of the mapping and writing its own
+ * output file. Outputs are then appended to the output file in input order, so the result is the
+ * same as of run_batch over the whole input.
+ *
+ * Progress is kept in '<output>.checkpoint': finished shards and how many of them are already
+ * merged. Running again with the same input, output and number of processes after a crash or a
+ * failed worker reruns only unfinished shards and continues merging where it stopped. Input is
+ * recognized by its size, inode and modification time, a checkpoint of an edited input is ignored.
+ */
+namespace Shamir {
+	struct shard_stats {
+		size_t first_record, records, failed;
+		double seconds;
+		bool resumed; // finished by an earlier run, taken from checkpoint
+	};
+
+	struct sharded_stats {
+		std::vector<shard_stats> shards;
+		size_t records, failed;
+		double merge_seconds;
+	};
+
+	/// 'threads' threads in every worker process; the calling process must not run any threads yet, workers are forked
+	sharded_stats run_sharded_batch(const std::string & input, const std::string & output, unsigned processes, unsigned threads,
+			bool blocks, const std::string & separator, const record_handler & handler);
+	sharded_stats run_sharded_batch(const std::string & input, const std::string & output, unsigned processes, unsigned threads,
+			bool blocks, const std::string & separator, const group_handler & handler);
+}
+
+#endif
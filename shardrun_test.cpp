@@ -0,0 +1,163 @@
+#include <shardrun.h>
+#include <batch.h>
+#include <threadpool.h>
+#include <mnemonic.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+	const std::string mnemonic("legal winner thank year wave sausage worth useful legal winner thank yellow");
+	const std::string other("letter advice cage absurd amount doctor acoustic avoid letter advice cage above");
+
+	std::string distribute_record(const std::string & record) {
+		std::string output;
+		for (auto && line: Shamir::split_mnemonic(Shamir::split_words(record), 2, 3)) output += line + "\n";
+		return output;
+	}
+
+	std::string merge_record(const std::string & record) {
+		std::istringstream lines(record);
+		std::string line;
+		std::vector<std::vector<uint8_t>> shares;
+		while (shares.size() < 2 && std::getline(lines, line)) shares.push_back(Shamir::slip39_to_share(Shamir::split_words(line)));
+		return Shamir::merge_mnemonic(shares) + "\n";
+	}
+
+	/// record a worker dies on, as if it was killed in the middle of its shard
+	const std::string crash_record("crash\n");
+	bool crash(false);
+
+	std::string crashing_merge(const std::string & record) {
+		if (crash && record == crash_record) _exit(3);
+		if (record == crash_record) return "recovered\n";
+		return merge_record(record);
+	}
+
+	std::string read_file(const std::string & path) {
+		std::ifstream in(path, std::ios::binary);
+		std::ostringstream content;
+		content << in.rdbuf();
+		return content.str();
+	}
+
+	void write_file(const std::string & path, const std::string & content) {
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out << content;
+	}
+
+	/// output of a single process run over the same input
+	std::string single_process(const std::string & input, bool blocks, const std::string & separator, const Shamir::record_handler & handler) {
+		thread_pool pool(1);
+		std::istringstream in(input);
+		std::ostringstream out;
+		Shamir::run_batch(in, out, blocks, separator, handler, pool);
+		return out.str();
+	}
+}
+
+/// shards merged in input order give the same output as one process, error lines keep global numbering
+void test_deterministic(const std::string & dir) {
+	std::string mnemonics;
+	const size_t records = 101, bad = 77;
+	for (size_t i = 0; i < records; ++i) {
+		if (i == bad) mnemonics += "legal winner thank year wave sausage worth useful legal winner thank winner\n";
+		else mnemonics += ((i % 3) ? mnemonic : other) + "\n\n";
+	}
+	write_file(dir + "/mnemonics", mnemonics);
+	auto stats = Shamir::run_sharded_batch(dir + "/mnemonics", dir + "/shares", 4, 2, false, "\n", distribute_record);
+	assert(stats.records == records && stats.failed == 1);
+	assert(stats.shards.size() == 4);
+	for (size_t i = 1; i < stats.shards.size(); ++i) assert(stats.shards[i].first_record == stats.shards[i - 1].first_record + stats.shards[i - 1].records);
+	const std::string shares = read_file(dir + "/shares");
+	assert(shares.find("error: record " + std::to_string(bad + 1) + ": BIP39 checksum verification failed") != std::string::npos);
+
+	stats = Shamir::run_sharded_batch(dir + "/shares", dir + "/merged", 3, 1, true, "", merge_record);
+	assert(stats.records == records && stats.failed == 1);
+	assert(read_file(dir + "/merged") == single_process(shares, true, "", merge_record));
+	assert(access((dir + "/merged.checkpoint").c_str(), F_OK) != 0);
+	assert(access((dir + "/merged.shard1").c_str(), F_OK) != 0);
+	std::cout << "sharded batch matches single process: passed" << std::endl;
+}
+
+/// run after a crashed worker reruns only its shard
+void test_restart(const std::string & dir) {
+	std::string input;
+	auto lines = Shamir::split_mnemonic(Shamir::split_words(mnemonic), 2, 3);
+	for (size_t i = 0; i < 40; ++i) {
+		if (i == 35) input += crash_record + "\n";
+		else input += lines[i % 3] + "\n" + lines[(i + 1) % 3] + "\n\n";
+	}
+	write_file(dir + "/sets", input);
+	crash = true;
+	bool thrown(false);
+	try {
+		Shamir::run_sharded_batch(dir + "/sets", dir + "/restored", 4, 1, true, "", crashing_merge);
+	} catch (const char *) {
+		thrown = true;
+	}
+	assert(thrown);
+	assert(access((dir + "/restored.checkpoint").c_str(), F_OK) == 0);
+
+	crash = false;
+	auto stats = Shamir::run_sharded_batch(dir + "/sets", dir + "/restored", 4, 1, true, "", crashing_merge);
+	assert(stats.records == 40 && stats.failed == 0);
+	for (size_t i = 0; i < 3; ++i) assert(stats.shards[i].resumed);
+	assert(!stats.shards[3].resumed);
+	assert(read_file(dir + "/restored") == single_process(input, true, "", crashing_merge));
+	std::cout << "sharded batch resumes from checkpoint: passed" << std::endl;
+}
+
+/// input edited in place without changing its length is processed again, not taken from the checkpoint
+void test_changed_input(const std::string & dir) {
+	auto lines = Shamir::split_mnemonic(Shamir::split_words(mnemonic), 2, 3);
+	std::string input, edited;
+	for (size_t i = 0; i < 12; ++i) {
+		const std::string record = i == 10 ? crash_record + "\n" : lines[i % 3] + "\n" + lines[(i + 1) % 3] + "\n\n";
+		input += record;
+		edited += record;
+	}
+	/// first share of the second record misspelled, same length
+	const size_t typo = input.find("\n\n") + 2;
+	edited[typo] = edited[typo] == 'x' ? 'z' : 'x';
+	assert(input.size() == edited.size() && input != edited);
+	write_file(dir + "/edited", input);
+	crash = true;
+	bool thrown(false);
+	try {
+		Shamir::run_sharded_batch(dir + "/edited", dir + "/edited.out", 3, 1, true, "", crashing_merge);
+	} catch (const char *) {
+		thrown = true;
+	}
+	assert(thrown);
+	assert(access((dir + "/edited.out.checkpoint").c_str(), F_OK) == 0);
+
+	write_file(dir + "/edited", edited);
+	crash = false;
+	auto stats = Shamir::run_sharded_batch(dir + "/edited", dir + "/edited.out", 3, 1, true, "", crashing_merge);
+	for (auto && shard: stats.shards) assert(!shard.resumed);
+	assert(stats.failed == 1);
+	assert(read_file(dir + "/edited.out") == single_process(edited, true, "", crashing_merge));
+	std::cout << "sharded batch ignores checkpoint of edited input: passed" << std::endl;
+}
+
+int main() {
+	char dir[] = "/tmp/shardrun_test.XXXXXX";
+	if (mkdtemp(dir) == nullptr) return 1;
+	try {
+		test_deterministic(dir);
+		test_restart(dir);
+		test_changed_input(dir);
+	} catch (const char * s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	std::system(("rm -rf " + std::string(dir)).c_str());
+	return 0;
+}
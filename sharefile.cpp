@@ -0,0 +1,128 @@
+#include <sharefile.h>
+#include <shamirmulti.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <endian.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+	const char sharefile_magic[8] = {'S', 'S', 'S', 'S', 'H', 'A', 'R', 'E'};
+}
+
+mapped_file::mapped_file(const std::string & path) : m_data(nullptr), m_size(0), m_writable(false) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw "Cannot open file for reading";
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw "Cannot stat file";
+	}
+	m_size = st.st_size;
+	if (m_size > 0) {
+		void * p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+		if (p == MAP_FAILED) {
+			close(fd);
+			throw "Cannot map file for reading";
+		}
+		m_data = static_cast<uint8_t *>(p);
+		madvise(m_data, m_size, MADV_SEQUENTIAL);
+	}
+	close(fd); /// mapping keeps its own reference to the file
+}
+
+mapped_file::mapped_file(const std::string & path, size_t size) : m_data(nullptr), m_size(size), m_writable(true) {
+	int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) throw "Cannot open file for writing";
+	if (ftruncate(fd, m_size) != 0) {
+		close(fd);
+		throw "Cannot resize output file";
+	}
+	if (m_size > 0) {
+		void * p = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) {
+			close(fd);
+			throw "Cannot map file for writing";
+		}
+		m_data = static_cast<uint8_t *>(p);
+	}
+	close(fd);
+}
+
+mapped_file::~mapped_file() {
+	if (m_data != nullptr) munmap(m_data, m_size);
+}
+
+void mapped_file::sync() {
+	if (m_writable && m_data != nullptr && msync(m_data, m_size, MS_SYNC) != 0) throw "Cannot flush mapped file";
+}
+
+void sharefile_header::write(uint8_t * out) const {
+	uint16_t version = htole16(VERSION);
+	uint64_t secret = htole64(secret_length), packet = htole64(share_length);
+	std::memcpy(out, sharefile_magic, 8);
+	std::memcpy(out + 8, &version, 2);
+	out[10] = static_cast<uint8_t>(index);
+	out[11] = static_cast<uint8_t>(threshold);
+	std::memset(out + 12, 0, 4);
+	std::memcpy(out + 16, &secret, 8);
+	std::memcpy(out + 24, &packet, 8);
+}
+
+void sharefile_header::read(const uint8_t * in, size_t length) {
+	if (length < SIZE || std::memcmp(in, sharefile_magic, 8) != 0) throw "Not a share file";
+	uint16_t version;
+	std::memcpy(&version, in + 8, 2);
+	if (le16toh(version) != VERSION) throw "Unsupported share file version";
+	index = in[10];
+	threshold = in[11];
+	std::memcpy(&secret_length, in + 16, 8);
+	std::memcpy(&share_length, in + 24, 8);
+	secret_length = le64toh(secret_length);
+	share_length = le64toh(share_length);
+	if (share_length != Shamir::share_size(secret_length) || length - SIZE != share_length) throw "Share file is truncated or corrupted";
+}
+
+namespace Shamir {
+	size_t sharefile_size(size_t secret_length) {
+		return sharefile_header::SIZE + share_size(secret_length);
+	}
+
+	void distribute_to_files(const uint8_t * msg, size_t length, unsigned threshold, const std::vector<std::string> & paths) {
+		if (threshold == 0 || paths.size() < threshold) throw "share threshold must be equal or greater than total share count";
+		std::vector< std::unique_ptr<mapped_file> > files;
+		std::vector<uint8_t *> outputs;
+		sharefile_header header;
+		header.threshold = threshold;
+		header.secret_length = length;
+		header.share_length = share_size(length);
+		for (size_t i = 0; i < paths.size(); ++i) {
+			files.push_back(std::unique_ptr<mapped_file>(new mapped_file(paths[i], sharefile_size(length))));
+			header.index = i + 1;
+			header.write(files.back()->data());
+			outputs.push_back(files.back()->data() + sharefile_header::SIZE);
+		}
+		distribute(msg, length, threshold, outputs);
+		for (auto && f: files) f->sync();
+	}
+
+	std::vector<uint8_t> reconstruct_from_files(const std::vector<std::string> & paths) {
+		if (paths.empty()) throw "Not enough shares supplied";
+		std::vector< std::unique_ptr<mapped_file> > files;
+		std::vector<const uint8_t *> views;
+		sharefile_header header, first = sharefile_header();
+		for (auto && path: paths) {
+			files.push_back(std::unique_ptr<mapped_file>(new mapped_file(path)));
+			header.read(files.back()->data(), files.back()->size());
+			if (views.empty()) first = header;
+			else if (header.secret_length != first.secret_length) throw "Shares do not have same length";
+			views.push_back(files.back()->data() + sharefile_header::SIZE);
+		}
+		return reconstruct(views, first.share_length);
+	}
+} // Shamir namespace
@@ -0,0 +1,62 @@
+#ifndef SHAREFILE
+#define SHAREFILE
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * read-only or read-write memory mapping of a whole file.
+ * Read-only mapping maps existing file, read-write mapping creates
+ * (or truncates) the file, resizes it to 'size' bytes and maps it shared,
+ * so writes to data() end up in the file without any intermediate buffer.
+ */
+class mapped_file {
+	private:
+		uint8_t * m_data;
+		size_t m_size;
+		bool m_writable;
+	public:
+		mapped_file(const std::string & path);
+		mapped_file(const std::string & path, size_t size);
+		mapped_file(const mapped_file &) = delete;
+		mapped_file & operator = (const mapped_file &) = delete;
+		~mapped_file();
+		uint8_t * data() { return m_data; }
+		const uint8_t * data() const { return m_data; }
+		size_t size() const { return m_size; }
+		void sync(); // flushes written pages to the file
+};
+
+/**
+ * binary share file: fixed 32 byte header followed by one share packet
+ * exactly as produced by Shamir::distribute. Header fields are little endian:
+ *
+ *   offset  size  field
+ *        0     8  magic "SSSSHARE"
+ *        8     2  format version, currently 1
+ *       10     1  share index
+ *       11     1  reconstruction threshold
+ *       12     4  reserved, zero
+ *       16     8  secret length in bytes
+ *       24     8  share packet length in bytes
+ */
+struct sharefile_header {
+	static const size_t SIZE = 32;
+	static const uint16_t VERSION = 1;
+	uint16_t index, threshold;
+	uint64_t secret_length, share_length;
+	void write(uint8_t * out) const;
+	void read(const uint8_t * in, size_t length); // validates magic, version and lengths
+};
+
+namespace Shamir {
+	size_t sharefile_size(size_t secret_length);
+	/// splits secret into paths.size() share files, shares are framed directly in the mapped files
+	void distribute_to_files(const uint8_t * msg, size_t length, unsigned threshold, const std::vector<std::string> & paths);
+	/// restores secret from share files, shares are parsed directly from the mapped pages
+	std::vector<uint8_t> reconstruct_from_files(const std::vector<std::string> & paths);
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include <sharefile.h>
+#include <shamirmulti.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+	std::vector<std::string> share_paths(const std::string & dir, int count) {
+		std::vector<std::string> paths;
+		for (int i = 1; i <= count; ++i) paths.push_back(dir + "/secret.share" + std::to_string(i));
+		return paths;
+	}
+}
+
+/// secret split into mapped files must be restorable from any 'threshold' of them
+void test_roundtrip(const std::string & dir) {
+	std::vector<uint8_t> secret(1 << 18);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 7 % 251);
+	auto paths = share_paths(dir, 5);
+	Shamir::distribute_to_files(secret.data(), secret.size(), 3, paths);
+
+	mapped_file first(paths[0]);
+	assert(first.size() == Shamir::sharefile_size(secret.size()));
+	sharefile_header header;
+	header.read(first.data(), first.size());
+	assert(header.index == 1 && header.threshold == 3);
+	assert(header.secret_length == secret.size());
+
+	std::vector<std::string> subset = {paths[4], paths[1], paths[2]};
+	assert(Shamir::reconstruct_from_files(subset) == secret);
+
+	/// mapped shares are the same shares as produced in memory
+	std::vector<std::vector<uint8_t>> in_memory;
+	for (auto && p: subset) {
+		mapped_file f(p);
+		in_memory.push_back(std::vector<uint8_t>(f.data() + sharefile_header::SIZE, f.data() + f.size()));
+	}
+	assert(Shamir::reconstruct(in_memory) == secret);
+	std::cout << "mapped share files roundtrip: passed" << std::endl;
+}
+
+void test_invalid(const std::string & dir) {
+	std::vector<uint8_t> secret(32, 0x5a);
+	auto paths = share_paths(dir, 2);
+	Shamir::distribute_to_files(secret.data(), secret.size(), 2, paths);
+	{
+		/// truncated share file must be refused before any share parsing
+		mapped_file f(paths[1]);
+		mapped_file g(dir + "/truncated", f.size() - 1);
+		std::memcpy(g.data(), f.data(), g.size());
+		g.sync();
+	}
+	try {
+		Shamir::reconstruct_from_files({paths[0], dir + "/truncated"});
+		assert(false);
+	} catch (const char * s) {
+		assert(std::string(s) == "Share file is truncated or corrupted");
+	}
+	{
+		/// flipped bit in share payload is caught by share checksum
+		mapped_file f(paths[1]);
+		mapped_file g(dir + "/corrupted", f.size());
+		std::memcpy(g.data(), f.data(), g.size());
+		g.data()[sharefile_header::SIZE + 7] ^= 0x10;
+		g.sync();
+	}
+	try {
+		Shamir::reconstruct_from_files({paths[0], dir + "/corrupted"});
+		assert(false);
+	} catch (const char * s) {
+		assert(std::string(s) == "checksum verification failed");
+	}
+	std::cout << "invalid share files rejected: passed" << std::endl;
+}
+
+int main() {
+	char dir_template[] = "/tmp/sharefile_test.XXXXXX";
+	const char * dir = mkdtemp(dir_template);
+	assert(dir != nullptr);
+	try {
+		test_roundtrip(dir);
+		test_invalid(dir);
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	std::system(("rm -rf " + std::string(dir)).c_str());
+	return 0;
+}
@@ -0,0 +1,421 @@
+#include <sharewriter.h>
+#include <sharefile.h>
+#include <shamirmulti.h>
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+share_writer::share_writer(const std::vector<std::string> & paths, uint64_t file_size, unsigned queue_depth, size_t chunk_size) :
+		m_chunk_size(chunk_size), m_staging(nullptr) {
+	if (paths.empty()) throw "No share files given";
+	if (queue_depth == 0 || chunk_size == 0) throw "Invalid share writer queue";
+	void * p;
+	if (posix_memalign(&p, 4096, queue_depth * chunk_size) != 0) throw "Cannot allocate share writer buffers";
+	m_staging = static_cast<uint8_t *>(p);
+	for (unsigned i = 0; i < queue_depth; ++i) {
+		m_buffers.push_back(m_staging + i * chunk_size);
+		m_free.push_back(i);
+	}
+	for (auto && path: paths) {
+		int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+		if (fd < 0 || ftruncate(fd, file_size) != 0) {
+			if (fd >= 0) close(fd);
+			for (auto i: m_fds) close(i);
+			std::free(m_staging);
+			throw "Cannot open file for writing";
+		}
+		m_fds.push_back(fd);
+	}
+}
+
+share_writer::~share_writer() {
+	for (auto i: m_fds) close(i);
+	std::free(m_staging);
+}
+
+void share_writer::write(unsigned stream, const uint8_t * data, size_t length, uint64_t offset) {
+	if (stream >= m_fds.size()) throw "Invalid share stream";
+	while (length > 0) {
+		unsigned buffer = acquire();
+		size_t chunk = std::min(length, m_chunk_size);
+		std::memcpy(m_buffers[buffer], data, chunk);
+		submit(buffer, stream, chunk, offset);
+		data += chunk;
+		offset += chunk;
+		length -= chunk;
+	}
+}
+
+namespace {
+	int io_uring_setup(unsigned entries, io_uring_params * p) {
+		return (int) syscall(__NR_io_uring_setup, entries, p);
+	}
+
+	int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+		return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+	}
+
+	int io_uring_register(int fd, unsigned opcode, const void * arg, unsigned nr_args) {
+		return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+	}
+
+	/**
+	 * io_uring backend: every staging buffer is registered with the kernel, so writes
+	 * are submitted as IORING_OP_WRITE_FIXED without per-request page pinning.
+	 * Submissions are batched and pushed to the kernel whenever we have to wait for a free buffer.
+	 * Kernels rejecting IORING_OP_WRITE_FIXED get IORING_OP_WRITE, kernels rejecting that too get blocking pwrite().
+	 */
+	class uring_share_writer: public share_writer {
+		private:
+			struct request {
+				unsigned stream;
+				size_t done, length;
+				uint64_t offset;
+				uint8_t opcode; // last submitted with, a rejected request steps down only from it
+			};
+			int m_ring;
+			bool m_fixed, m_pwrite;
+			void * m_sq_ring, * m_cq_ring;
+			size_t m_sq_ring_size, m_cq_ring_size, m_sqes_size;
+			io_uring_sqe * m_sqes;
+			unsigned * m_sq_head, * m_sq_tail, * m_sq_mask, * m_sq_array;
+			unsigned * m_cq_head, * m_cq_tail, * m_cq_mask;
+			io_uring_cqe * m_cqes;
+			unsigned m_unsubmitted, m_inflight, m_cq_entries;
+			std::vector<request> m_requests; // indexed by staging buffer, fsync requests use index past the buffers
+			const char * m_error;
+
+			/// blocking write of the rest of the request, for kernels without write opcodes
+			void write_directly(unsigned id) {
+				request & r = m_requests[id];
+				while (r.done < r.length) {
+					ssize_t ret = pwrite(m_fds[r.stream], m_buffers[id] + r.done, r.length - r.done, r.offset + r.done);
+					if (ret < 0 && errno == EINTR) continue;
+					if (ret <= 0) {
+						m_error = "Share write failed";
+						break;
+					}
+					r.done += ret;
+				}
+				m_free.push_back(id);
+			}
+
+			void queue(unsigned id) {
+				if (m_pwrite && id < m_buffers.size()) {
+					write_directly(id);
+					return;
+				}
+				request & r = m_requests[id];
+				unsigned tail = *m_sq_tail;
+				if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) > *m_sq_mask) {
+					enter(0);
+					tail = *m_sq_tail;
+				}
+				unsigned index = tail & *m_sq_mask;
+				io_uring_sqe * sqe = m_sqes + index;
+				std::memset(sqe, 0, sizeof(*sqe));
+				sqe->fd = m_fds[r.stream];
+				sqe->user_data = id;
+				if (id >= m_buffers.size()) {
+					sqe->opcode = IORING_OP_FSYNC;
+					sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+				} else {
+					sqe->opcode = r.opcode = m_fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+					sqe->addr = reinterpret_cast<uint64_t>(m_buffers[id] + r.done);
+					sqe->len = r.length - r.done;
+					sqe->off = r.offset + r.done;
+					sqe->buf_index = id;
+				}
+				m_sq_array[index] = index;
+				__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+				++m_unsubmitted;
+				++m_inflight;
+			}
+
+			/// submits queued requests and waits for at least 'min_complete' completions
+			void enter(unsigned min_complete) {
+				while (true) {
+					int ret = io_uring_enter(m_ring, m_unsubmitted, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+					if (ret >= 0) {
+						m_unsubmitted -= std::min<unsigned>(ret, m_unsubmitted);
+						if (m_unsubmitted == 0 || min_complete > 0) break;
+					} else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+						throw "io_uring submission failed";
+					}
+				}
+				reap();
+			}
+
+			void reap() {
+				unsigned head = *m_cq_head;
+				const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+				std::vector<unsigned> resubmit;
+				for (; head != tail; ++head) {
+					const io_uring_cqe & cqe = m_cqes[head & *m_cq_mask];
+					unsigned id = static_cast<unsigned>(cqe.user_data);
+					--m_inflight;
+					if ((cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP) && id < m_buffers.size()) {
+						/// opcode not supported, retried with the one below it: requests of the same batch
+						/// rejected as IORING_OP_WRITE_FIXED must still try IORING_OP_WRITE before pwrite()
+						if (m_requests[id].opcode == IORING_OP_WRITE_FIXED) m_fixed = false;
+						else m_pwrite = true;
+						resubmit.push_back(id);
+						continue;
+					}
+					if (cqe.res < 0) {
+						m_error = "Share write failed";
+						if (id < m_buffers.size()) m_free.push_back(id);
+						continue;
+					}
+					if (id >= m_buffers.size()) continue;
+					request & r = m_requests[id];
+					r.done += cqe.res;
+					if (cqe.res == 0 && r.done < r.length) {
+						m_error = "Share write failed";
+						m_free.push_back(id);
+					} else if (r.done < r.length) {
+						resubmit.push_back(id); /// short write, queue the rest
+					} else {
+						m_free.push_back(id);
+					}
+				}
+				__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+				for (auto id: resubmit) queue(id);
+			}
+
+		protected:
+			void submit(unsigned buffer, unsigned stream, size_t length, uint64_t offset) {
+				request & r = m_requests[buffer];
+				r.stream = stream;
+				r.done = 0;
+				r.length = length;
+				r.offset = offset;
+				queue(buffer);
+				if (m_unsubmitted >= 8) enter(0);
+			}
+
+			unsigned acquire() {
+				while (m_free.empty()) enter(1);
+				unsigned buffer = m_free.back();
+				m_free.pop_back();
+				return buffer;
+			}
+
+		public:
+			uring_share_writer(const std::vector<std::string> & paths, uint64_t file_size, unsigned queue_depth, size_t chunk_size) :
+					share_writer(paths, file_size, queue_depth, chunk_size), m_ring(-1), m_fixed(false), m_pwrite(false), m_sq_ring(MAP_FAILED), m_cq_ring(MAP_FAILED),
+					m_sqes(static_cast<io_uring_sqe *>(MAP_FAILED)), m_unsubmitted(0), m_inflight(0), m_requests(queue_depth + paths.size()), m_error(nullptr) {
+				io_uring_params params;
+				std::memset(&params, 0, sizeof(params));
+				m_ring = io_uring_setup(queue_depth, &params);
+				if (m_ring < 0) throw "io_uring is not available";
+				m_cq_entries = params.cq_entries;
+				m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+				m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+				m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+				if (params.features & IORING_FEAT_SINGLE_MMAP) m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+				m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+				if (m_sq_ring == MAP_FAILED) release("Cannot map io_uring");
+				if (params.features & IORING_FEAT_SINGLE_MMAP) m_cq_ring = m_sq_ring;
+				else m_cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+				if (m_cq_ring == MAP_FAILED) release("Cannot map io_uring");
+				void * sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+				if (sqes == MAP_FAILED) release("Cannot map io_uring");
+				m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+				uint8_t * sq = static_cast<uint8_t *>(m_sq_ring), * cq = static_cast<uint8_t *>(m_cq_ring);
+				m_sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+				m_sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+				m_sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+				m_sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+				m_cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+				m_cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+				m_cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+				m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+				/// registered buffers count against RLIMIT_MEMLOCK on older kernels, plain writes are used if registration is refused
+				std::vector<iovec> iov;
+				for (auto b: m_buffers) iov.push_back(iovec{b, m_chunk_size});
+				m_fixed = io_uring_register(m_ring, IORING_REGISTER_BUFFERS, iov.data(), iov.size()) == 0;
+			}
+
+			~uring_share_writer() {
+				try {
+					while (m_inflight > 0) enter(1);
+				} catch (const char *) {}
+				release(nullptr);
+			}
+
+			/// unmaps and closes the ring, throws 'error' unless it is null
+			void release(const char * error) {
+				if (m_sqes != MAP_FAILED) munmap(m_sqes, m_sqes_size);
+				if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring) munmap(m_cq_ring, m_cq_ring_size);
+				if (m_sq_ring != MAP_FAILED) munmap(m_sq_ring, m_sq_ring_size);
+				if (m_ring >= 0) close(m_ring);
+				m_sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+				m_sq_ring = m_cq_ring = MAP_FAILED;
+				m_ring = -1;
+				if (error != nullptr) throw error;
+			}
+
+			void finish() {
+				while (m_inflight > 0 || m_unsubmitted > 0) enter(1);
+				for (unsigned i = 0; i < m_fds.size(); ++i) {
+					while (m_inflight >= m_cq_entries) enter(1);
+					m_requests[m_buffers.size() + i].stream = i;
+					queue(m_buffers.size() + i);
+				}
+				while (m_inflight > 0 || m_unsubmitted > 0) enter(1);
+				if (m_error != nullptr) throw m_error;
+			}
+
+			const char * name() const { return m_pwrite ? "io_uring (pwrite fallback)" : m_fixed ? "io_uring (registered buffers)" : "io_uring"; }
+	};
+
+	/**
+	 * portable backend: pool of threads doing blocking pwrite() calls, so a stalled file
+	 * occupies one thread while the remaining ones keep writing other streams.
+	 */
+	class pwrite_share_writer: public share_writer {
+		private:
+			struct job {
+				unsigned buffer, stream; // buffer == m_buffers.size() requests fdatasync of the stream
+				size_t length;
+				uint64_t offset;
+			};
+			std::vector<std::thread> m_threads;
+			std::deque<job> m_jobs;
+			std::mutex m_mutex;
+			std::condition_variable m_job_ready, m_job_done;
+			unsigned m_inflight;
+			bool m_stop;
+			const char * m_error;
+
+			void worker() {
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (true) {
+					m_job_ready.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+					if (m_jobs.empty()) return;
+					job j = m_jobs.front();
+					m_jobs.pop_front();
+					lock.unlock();
+					const char * error = nullptr;
+					if (j.buffer == m_buffers.size()) {
+						if (fdatasync(m_fds[j.stream]) != 0) error = "Share write failed";
+					} else {
+						size_t done = 0;
+						while (done < j.length) {
+							ssize_t ret = pwrite(m_fds[j.stream], m_buffers[j.buffer] + done, j.length - done, j.offset + done);
+							if (ret < 0 && errno == EINTR) continue;
+							if (ret <= 0) {
+								error = "Share write failed";
+								break;
+							}
+							done += ret;
+						}
+					}
+					lock.lock();
+					if (error != nullptr) m_error = error;
+					if (j.buffer != m_buffers.size()) m_free.push_back(j.buffer);
+					--m_inflight;
+					m_job_done.notify_all();
+				}
+			}
+
+			void push(const job & j) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_jobs.push_back(j);
+				++m_inflight;
+				m_job_ready.notify_one();
+			}
+
+		protected:
+			void submit(unsigned buffer, unsigned stream, size_t length, uint64_t offset) {
+				push(job{buffer, stream, length, offset});
+			}
+
+			unsigned acquire() {
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_job_done.wait(lock, [this] { return !m_free.empty(); });
+				unsigned buffer = m_free.back();
+				m_free.pop_back();
+				return buffer;
+			}
+
+		public:
+			pwrite_share_writer(const std::vector<std::string> & paths, uint64_t file_size, unsigned queue_depth, size_t chunk_size) :
+					share_writer(paths, file_size, queue_depth, chunk_size), m_inflight(0), m_stop(false), m_error(nullptr) {
+				unsigned threads = std::min<unsigned>(std::min<unsigned>(paths.size(), queue_depth), 16);
+				for (unsigned i = 0; i < threads; ++i) m_threads.push_back(std::thread(&pwrite_share_writer::worker, this));
+			}
+
+			~pwrite_share_writer() {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_job_ready.notify_all();
+				for (auto && t: m_threads) t.join();
+			}
+
+			void finish() {
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_job_done.wait(lock, [this] { return m_inflight == 0; });
+				}
+				for (unsigned i = 0; i < m_fds.size(); ++i) push(job{(unsigned) m_buffers.size(), i, 0, 0});
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_job_done.wait(lock, [this] { return m_inflight == 0; });
+				if (m_error != nullptr) throw m_error;
+			}
+
+			const char * name() const { return "pwrite thread pool"; }
+	};
+} // anonymous namespace
+
+std::unique_ptr<share_writer> make_share_writer(const std::vector<std::string> & paths, uint64_t file_size,
+		share_writer_backend backend, unsigned queue_depth, size_t chunk_size) {
+	if (backend != share_writer_backend::pwrite) {
+		try {
+			return std::unique_ptr<share_writer>(new uring_share_writer(paths, file_size, queue_depth, chunk_size));
+		} catch (const char * s) {
+			if (backend == share_writer_backend::uring) std::cerr << s << ", shares are written by pwrite thread pool" << std::endl;
+		}
+	}
+	return std::unique_ptr<share_writer>(new pwrite_share_writer(paths, file_size, queue_depth, chunk_size));
+}
+
+namespace Shamir {
+	void distribute_to_files(const uint8_t * msg, size_t length, unsigned threshold, share_writer & out) {
+		sharefile_header header;
+		uint8_t raw_header[sharefile_header::SIZE];
+		header.threshold = threshold;
+		header.secret_length = length;
+		header.share_length = share_size(length);
+		for (unsigned i = 0; i < out.streams(); ++i) {
+			header.index = i + 1;
+			header.write(raw_header);
+			out.write(i, raw_header, sharefile_header::SIZE, 0);
+		}
+		distribute(msg, length, threshold, out.streams(), [&out] (unsigned index, const uint8_t * share, size_t share_length) {
+			out.write(index, share, share_length, sharefile_header::SIZE);
+		});
+		out.finish();
+	}
+} // Shamir namespace
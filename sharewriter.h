@@ -0,0 +1,51 @@
+#ifndef SHAREWRITER
+#define SHAREWRITER
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+enum class share_writer_backend { automatic, uring, pwrite };
+
+/**
+ * concurrent writer of n share files (streams).
+ * write() copies data into one of 'queue_depth' staging buffers of 'chunk_size' bytes
+ * and queues it without waiting for the device. Caller only blocks when every staging
+ * buffer is still in flight, so one slow file does not serialize writes to the others.
+ */
+class share_writer {
+	protected:
+		std::vector<int> m_fds;
+		std::vector<uint8_t *> m_buffers;
+		std::vector<unsigned> m_free; // indices of staging buffers not in flight
+		size_t m_chunk_size;
+		uint8_t * m_staging;
+		share_writer(const std::vector<std::string> & paths, uint64_t file_size, unsigned queue_depth, size_t chunk_size);
+		virtual void submit(unsigned buffer, unsigned stream, size_t length, uint64_t offset) = 0; // hands filled staging buffer over to backend
+		virtual unsigned acquire() = 0; // takes staging buffer out of m_free, waits for writes in flight if there is none
+	public:
+		share_writer(const share_writer &) = delete;
+		share_writer & operator = (const share_writer &) = delete;
+		virtual ~share_writer();
+		unsigned streams() const { return m_fds.size(); }
+		void write(unsigned stream, const uint8_t * data, size_t length, uint64_t offset); // data may be reused as soon as write returns
+		virtual void finish() = 0; // waits for all queued writes, flushes files to the device, throws if anything failed
+		virtual const char * name() const = 0;
+};
+
+/**
+ * creates (or truncates) one file of 'file_size' bytes for each path.
+ * io_uring backed writer with registered staging buffers is used when the kernel
+ * allows it, portable pwrite() thread pool otherwise (reported on stderr when io_uring was asked for).
+ */
+std::unique_ptr<share_writer> make_share_writer(const std::vector<std::string> & paths, uint64_t file_size,
+		share_writer_backend backend = share_writer_backend::automatic, unsigned queue_depth = 64, size_t chunk_size = 1 << 17);
+
+namespace Shamir {
+	/// splits secret into out.streams() share files in sharefile format, shares are queued for writing as soon as they are framed
+	void distribute_to_files(const uint8_t * msg, size_t length, unsigned threshold, share_writer & out);
+}
+
+#endif
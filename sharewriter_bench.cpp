@@ -0,0 +1,53 @@
+#include <sharewriter.h>
+#include <sharefile.h>
+#include <shamirmulti.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+/**
+ * measures how long it takes to split secret into share files with each output backend.
+ * Usage: sharewriter_bench <directory> [secret KiB] [share count]
+ * point directory at tmpfs (e.g. /dev/shm) and at local disk to compare.
+ */
+int main(int argc, const char * argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <directory> [secret KiB] [share count]" << std::endl;
+		return 1;
+	}
+	const std::string dir(argv[1]);
+	const size_t length = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024) << 10;
+	const unsigned count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 32;
+	std::vector<uint8_t> secret(length);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 29 % 256);
+	std::vector<std::string> paths;
+	for (unsigned i = 1; i <= count; ++i) paths.push_back(dir + "/bench.share" + std::to_string(i));
+
+	try {
+		for (int backend = 0; backend < 3; ++backend) {
+			auto start = std::chrono::steady_clock::now();
+			std::string name("mmap");
+			if (backend == 0) {
+				Shamir::distribute_to_files(secret.data(), secret.size(), 2, paths);
+			} else {
+				auto writer = make_share_writer(paths, Shamir::sharefile_size(length), backend == 1 ? share_writer_backend::uring : share_writer_backend::pwrite);
+				name = writer->name();
+				Shamir::distribute_to_files(secret.data(), secret.size(), 2, *writer);
+			}
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			double mib = (double) Shamir::sharefile_size(length) * count / (1 << 20);
+			std::cout << std::setw(32) << std::left << name << std::fixed << std::setprecision(3)
+				<< elapsed.count() << " s, " << mib / elapsed.count() << " MiB/s written" << std::endl;
+		}
+	} catch (const char * s) {
+		std::cerr << s << std::endl;
+		return 1;
+	}
+	for (auto && p: paths) std::remove(p.c_str());
+	return 0;
+}
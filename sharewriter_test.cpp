@@ -0,0 +1,73 @@
+#include <sharewriter.h>
+#include <sharefile.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+#include <cstddef>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+/// shares written through given backend must be valid share files restoring original secret
+std::string test_backend(const std::string & dir, share_writer_backend backend) {
+	std::vector<uint8_t> secret((1 << 16) + 123);
+	for (size_t i = 0; i < secret.size(); ++i) secret[i] = (uint8_t) (i * 13 % 256);
+	std::vector<std::string> paths;
+	for (int i = 1; i <= 7; ++i) paths.push_back(dir + "/secret.share" + std::to_string(i));
+
+	/// tiny queue and chunks, so writes wait for free buffers and every share is split into many requests
+	auto writer = make_share_writer(paths, Shamir::sharefile_size(secret.size()), backend, 4, 4096);
+	Shamir::distribute_to_files(secret.data(), secret.size(), 4, *writer);
+
+	std::vector<std::string> subset = {paths[6], paths[0], paths[3], paths[5]};
+	assert(Shamir::reconstruct_from_files(subset) == secret);
+	std::cout << writer->name() << " share writer: passed" << std::endl;
+	return writer->name();
+}
+
+/// -w uring on a kernel without io_uring: io_uring_setup() fails with ENOSYS in a child process, shares come from pwrite pool
+void test_uring_fallback(const std::string & dir) {
+	pid_t child = fork();
+	assert(child >= 0);
+	if (child == 0) {
+		sock_filter filter[] = {
+			BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+			BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_setup, 0, 1),
+			BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | ENOSYS),
+			BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW)
+		};
+		sock_fprog program = { sizeof(filter) / sizeof(filter[0]), filter };
+		if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0 || prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) != 0) _exit(2);
+		try {
+			_exit(test_backend(dir, share_writer_backend::uring) == "pwrite thread pool" ? 0 : 1);
+		} catch (const char *s) {
+			std::cout << s << std::endl;
+			_exit(1);
+		}
+	}
+	int status;
+	assert(waitpid(child, &status, 0) == child);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main() {
+	char dir_template[] = "/tmp/sharewriter_test.XXXXXX";
+	const char * dir = mkdtemp(dir_template);
+	assert(dir != nullptr);
+	try {
+		test_backend(dir, share_writer_backend::automatic);
+		test_backend(dir, share_writer_backend::pwrite);
+		test_uring_fallback(dir);
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	std::system(("rm -rf " + std::string(dir)).c_str());
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include <threadpool.h>
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+namespace {
+	/// pool the current thread works for and index of its deque, nullptr for threads outside of any pool
+	thread_local const thread_pool * current_pool = nullptr;
+	thread_local unsigned current_index = 0;
+}
+
+thread_pool::thread_pool(unsigned threads) : m_queued(0), m_steals(0), m_stop(false) {
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned i = 0; i < threads; ++i) m_queues.push_back(std::unique_ptr<task_queue>(new task_queue));
+	for (unsigned i = 1; i < threads; ++i) m_workers.push_back(std::thread(&thread_pool::worker, this, i));
+}
+
+thread_pool::~thread_pool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto && t: m_workers) t.join();
+}
+
+void thread_pool::notify(bool all) {
+	/// taking the lock orders this with the predicate check of a thread going to sleep
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (all) m_wake.notify_all();
+	else m_wake.notify_one();
+}
+
+void thread_pool::push(const task & t) {
+	task_queue & q = *m_queues[current_pool == this ? current_index : 0];
+	{
+		std::lock_guard<std::mutex> lock(q.mutex);
+		q.tasks.push_back(t);
+	}
+	++m_queued;
+	notify(false);
+}
+
+bool thread_pool::pop(task & t) {
+	if (m_queued == 0) return false;
+	const unsigned own = current_pool == this ? current_index : 0;
+	{
+		task_queue & q = *m_queues[own];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (!q.tasks.empty()) {
+			if (own == 0) {
+				t = q.tasks.front();
+				q.tasks.pop_front();
+			} else {
+				t = q.tasks.back();
+				q.tasks.pop_back();
+			}
+			--m_queued;
+			return true;
+		}
+	}
+	for (unsigned i = 1; i <= m_queues.size(); ++i) {
+		const unsigned victim = (own + i) % m_queues.size();
+		if (victim == own) continue;
+		task_queue & q = *m_queues[victim];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (q.tasks.empty()) continue;
+		t = q.tasks.front();
+		q.tasks.pop_front();
+		--m_queued;
+		if (victim != 0) ++m_steals;
+		return true;
+	}
+	return false;
+}
+
+void thread_pool::execute(task & t) {
+	try {
+		t.work();
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!t.owner->m_error) t.owner->m_error = std::current_exception();
+	}
+	group * owner = t.owner;
+	t.work = nullptr;
+	if (--owner->m_pending == 0) notify(true);
+}
+
+void thread_pool::worker(unsigned index) {
+	current_pool = this;
+	current_index = index;
+	task t;
+	while (true) {
+		if (pop(t)) {
+			execute(t);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+		if (m_stop && m_queued == 0) return;
+	}
+}
+
+void thread_pool::group::run(const std::function<void()> & work) {
+	++m_pending;
+	m_pool.push(task{work, this});
+}
+
+void thread_pool::group::wait() {
+	task t;
+	while (m_pending > 0) {
+		if (m_pool.pop(t)) {
+			m_pool.execute(t);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_pool.m_mutex);
+		m_pool.m_wake.wait(lock, [this] { return m_pending == 0 || m_pool.m_queued > 0; });
+	}
+	std::lock_guard<std::mutex> lock(m_pool.m_mutex);
+	if (m_error) {
+		std::exception_ptr error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+thread_pool::group::~group() {
+	try {
+		wait();
+	} catch (...) {}
+}
+
+void thread_pool::parallel_for(size_t begin, size_t end, size_t chunk, const std::function<void(size_t, size_t)> & body) {
+	if (begin >= end) return;
+	if (chunk == 0) chunk = 1;
+	const size_t chunks = (end - begin + chunk - 1) / chunk;
+	if (chunks == 1 || m_workers.empty()) {
+		for (size_t i = begin; i < end; i += chunk) body(i, std::min(end, i + chunk));
+		return;
+	}
+	/// every helper keeps taking next chunk, so uneven chunks balance themselves
+	std::shared_ptr< std::atomic<size_t> > next(new std::atomic<size_t>(0));
+	auto loop = [next, chunks, begin, end, chunk, &body] () {
+		for (size_t c = (*next)++; c < chunks; c = (*next)++) {
+			body(begin + c * chunk, std::min(end, begin + (c + 1) * chunk));
+		}
+	};
+	group helpers(*this);
+	const size_t count = std::min<size_t>(chunks, size()) - 1;
+	for (size_t i = 0; i < count; ++i) helpers.run(loop);
+	try {
+		loop();
+	} catch (...) {
+		*next = chunks; /// stop helpers from taking more work
+		try {
+			helpers.wait();
+		} catch (...) {}
+		throw;
+	}
+	helpers.wait();
+}
@@ -0,0 +1,71 @@
+#ifndef THREADPOOL
+#define THREADPOOL
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * fixed set of worker threads executing queued tasks, with work stealing.
+ * Every worker owns a deque: tasks it submits go to its back and are taken from there again (LIFO,
+ * recently split work is still in cache), idle workers steal from the front of other deques (FIFO,
+ * oldest and so biggest pieces of work). Tasks submitted by other threads go to a shared injection queue.
+ * Exceptions thrown by tasks are caught and rethrown by wait() or parallel_for().
+ */
+class thread_pool {
+	public:
+		/// set of tasks which can be waited for together
+		class group {
+			friend class thread_pool;
+			private:
+				thread_pool & m_pool;
+				std::atomic<size_t> m_pending;
+				std::exception_ptr m_error;
+			public:
+				group(thread_pool & pool) : m_pool(pool), m_pending(0) {}
+				group(const group &) = delete;
+				group & operator = (const group &) = delete;
+				~group();
+				void run(const std::function<void()> & task);
+				void wait(); // helps executing queued tasks, returns when all tasks of the group finished, rethrows first exception
+		};
+
+		explicit thread_pool(unsigned threads = 0); // 0 ... one thread per hardware thread; caller of wait() counts as one of them
+		thread_pool(const thread_pool &) = delete;
+		thread_pool & operator = (const thread_pool &) = delete;
+		~thread_pool();
+		unsigned size() const { return m_workers.size() + 1; }
+		/// calls body(chunk_begin, chunk_end) for consecutive ranges of at most 'chunk' elements covering [begin, end)
+		void parallel_for(size_t begin, size_t end, size_t chunk, const std::function<void(size_t, size_t)> & body);
+		/// number of tasks taken from another worker's deque so far
+		size_t steals() const { return m_steals; }
+	private:
+		struct task {
+			std::function<void()> work;
+			group * owner;
+		};
+		struct task_queue {
+			std::mutex mutex;
+			std::deque<task> tasks;
+		};
+		std::vector<std::thread> m_workers;
+		std::vector< std::unique_ptr<task_queue> > m_queues; // [0] injection queue, [i] deque of worker i
+		std::atomic<size_t> m_queued, m_steals;
+		std::mutex m_mutex; // only guards sleeping, queues have their own locks
+		std::condition_variable m_wake;
+		bool m_stop;
+		void worker(unsigned index);
+		void push(const task & t);
+		bool pop(task & t); // own deque, injection queue, then steal
+		void execute(task & t);
+		void notify(bool all);
+};
+
+#endif
@@ -0,0 +1,286 @@
+#include <vault.h>
+
+#include <vector>
+#include <string>
+#include <set>
+#include <map>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+	const char temp_prefix[] = ".tmp.";
+	const char manifest_name[] = "MANIFEST";
+
+	/// share names end up as file names, so they must not address anything outside of the vault
+	bool valid_name(const std::string & name) {
+		if (name.empty() || name[0] == '.' || name == manifest_name) return false;
+		/// MANIFEST records are whitespace separated, a name with a blank could never be read back
+		return std::none_of(name.begin(), name.end(), [] (char c) { return c == '/' || std::isspace(static_cast<unsigned char>(c)); });
+	}
+
+	double milliseconds(std::chrono::steady_clock::duration d) {
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+
+	struct manifest_record {
+		std::string name;
+		size_t length;
+		uint64_t generation;
+	};
+
+	/// records of MANIFEST in order, a torn last line (no newline) is not a record; 'complete' receives length of the whole lines
+	std::vector<manifest_record> read_manifest(const std::string & dir, size_t & complete) {
+		std::vector<manifest_record> records;
+		std::ifstream manifest(dir + "/" + manifest_name, std::ios::binary);
+		const std::string content((std::istreambuf_iterator<char>(manifest)), std::istreambuf_iterator<char>());
+		complete = 0;
+		for (size_t end; (end = content.find('\n', complete)) != std::string::npos; complete = end + 1) {
+			std::istringstream ss(content.substr(complete, end - complete));
+			manifest_record r;
+			if (ss >> r.name >> r.length >> r.generation) records.push_back(r);
+		}
+		return records;
+	}
+
+	/// splits ".tmp.<generation>.<name>", false for anything else
+	bool parse_temp(const std::string & file, uint64_t & generation, std::string & name) {
+		const size_t prefix = sizeof(temp_prefix) - 1;
+		if (file.compare(0, prefix, temp_prefix) != 0) return false;
+		const size_t dot = file.find('.', prefix);
+		if (dot == std::string::npos || dot == prefix || dot + 1 == file.size()) return false;
+		generation = 0;
+		for (size_t i = prefix; i < dot; ++i) {
+			if (file[i] < '0' || file[i] > '9') return false;
+			generation = generation * 10 + (file[i] - '0');
+		}
+		name = file.substr(dot + 1);
+		return true;
+	}
+
+	void write_all(int fd, const uint8_t * data, size_t length) {
+		while (length > 0) {
+			ssize_t ret = ::write(fd, data, length);
+			if (ret < 0 && errno == EINTR) continue;
+			if (ret <= 0) throw "Cannot write share to vault";
+			data += ret;
+			length -= ret;
+		}
+	}
+}
+
+share_vault::share_vault(const std::string & dir, size_t commit_size, std::chrono::milliseconds commit_interval) :
+		m_dir(dir), m_dirfd(-1), m_manifest(-1), m_commit_size(commit_size == 0 ? 1 : commit_size), m_commit_interval(commit_interval),
+		m_flush(false), m_committing(false), m_stop(false), m_next_generation(1), m_error(nullptr) {
+	mkdir(m_dir.c_str(), 0700);
+	m_dirfd = open(m_dir.c_str(), O_RDONLY | O_DIRECTORY);
+	if (m_dirfd < 0) throw "Cannot open vault directory";
+	try {
+		recover();
+	} catch (const char *) {
+		close(m_dirfd);
+		throw;
+	}
+	m_manifest = openat(m_dirfd, manifest_name, O_WRONLY | O_CREAT | O_APPEND, 0600);
+	if (m_manifest < 0) {
+		close(m_dirfd);
+		throw "Cannot open vault manifest";
+	}
+	m_committer = std::thread(&share_vault::committer, this);
+}
+
+share_vault::~share_vault() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	m_committer.join();
+	for (auto && p: m_pending) close(p.fd); /// only left over when last commit failed
+	close(m_manifest);
+	close(m_dirfd);
+}
+
+std::string share_vault::temp_path(const std::string & name, uint64_t generation) {
+	return temp_prefix + std::to_string(generation) + "." + name;
+}
+
+/// finishes renames of shares whose exact generation made it to MANIFEST, drops all other temporary files
+void share_vault::recover() {
+	std::map<uint64_t, manifest_record> committed;
+	size_t complete;
+	for (auto && r: read_manifest(m_dir, complete)) {
+		committed[r.generation] = r;
+		m_next_generation = std::max(m_next_generation, r.generation + 1);
+	}
+	DIR * d = opendir(m_dir.c_str());
+	if (d == nullptr) throw "Cannot open vault directory";
+	bool changed(false);
+	while (dirent * e = readdir(d)) {
+		std::string file(e->d_name), name;
+		if (file.compare(0, sizeof(temp_prefix) - 1, temp_prefix) != 0) continue;
+		uint64_t generation;
+		struct stat st;
+		bool durable = parse_temp(file, generation, name) && committed.count(generation) && committed[generation].name == name;
+		durable = durable && fstatat(m_dirfd, file.c_str(), &st, 0) == 0 && static_cast<size_t>(st.st_size) == committed[generation].length;
+		if (durable) renameat(m_dirfd, file.c_str(), m_dirfd, name.c_str());
+		else unlinkat(m_dirfd, file.c_str(), 0);
+		changed = true;
+	}
+	closedir(d);
+	if (changed && fsync(m_dirfd) != 0) throw "Cannot flush vault directory";
+	/// torn record is cut off, records appended later must start on a line of their own
+	struct stat st;
+	if (fstatat(m_dirfd, manifest_name, &st, 0) == 0 && static_cast<size_t>(st.st_size) > complete) {
+		int fd = openat(m_dirfd, manifest_name, O_WRONLY);
+		const bool cut = fd >= 0 && ftruncate(fd, complete) == 0 && fdatasync(fd) == 0;
+		if (fd >= 0) close(fd);
+		if (!cut) throw "Cannot repair vault manifest";
+	}
+}
+
+void share_vault::put(const std::string & name, const uint8_t * data, size_t length) {
+	if (!valid_name(name)) throw "Invalid share name";
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_error != nullptr) throw m_error;
+	if (m_pending_names.count(name)) {
+		/// same name twice in one batch would share the temporary file, commit the first one
+		m_flush = true;
+		m_wake.notify_all();
+		m_done.wait(lock, [this] { return m_pending.empty() || m_error != nullptr; });
+		if (m_error != nullptr) throw m_error;
+	}
+	/// back pressure, do not let writers run arbitrarily far ahead of the committer
+	m_done.wait(lock, [this] { return m_pending.size() < 2 * m_commit_size || m_error != nullptr; });
+	const uint64_t generation = m_next_generation++;
+	lock.unlock();
+
+	auto start = std::chrono::steady_clock::now();
+	const std::string temp(temp_path(name, generation));
+	int fd = openat(m_dirfd, temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) throw "Cannot create share file in vault";
+	try {
+		write_all(fd, data, length);
+	} catch (const char *) {
+		close(fd);
+		unlinkat(m_dirfd, temp.c_str(), 0);
+		throw;
+	}
+
+	lock.lock();
+	if (m_pending.empty()) m_first_pending = start;
+	m_pending.push_back(pending_share{name, generation, fd, length});
+	m_pending_names.insert(name);
+	if (m_pending.size() >= m_commit_size) m_wake.notify_all();
+}
+
+void share_vault::commit() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_flush = true;
+	m_wake.notify_all();
+	m_done.wait(lock, [this] { return (m_pending.empty() && !m_committing) || m_error != nullptr; });
+	if (m_error != nullptr) throw m_error;
+}
+
+std::vector<std::string> share_vault::list() const {
+	std::vector<std::string> output;
+	std::set<std::string> seen;
+	size_t complete;
+	for (auto && r: read_manifest(m_dir, complete)) {
+		if (seen.insert(r.name).second) output.push_back(r.name);
+	}
+	return output;
+}
+
+std::vector<vault_batch_stats> share_vault::batches() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_batches;
+}
+
+void share_vault::committer() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		if (m_pending.empty()) {
+			m_flush = false;
+			if (m_stop) return;
+			m_wake.wait(lock);
+			continue;
+		}
+		auto deadline = m_first_pending + m_commit_interval;
+		if (!m_flush && !m_stop && m_pending.size() < m_commit_size && std::chrono::steady_clock::now() < deadline) {
+			m_wake.wait_until(lock, deadline);
+			continue;
+		}
+		std::vector<pending_share> batch;
+		batch.swap(m_pending);
+		m_pending_names.clear();
+		auto first = m_first_pending;
+		m_committing = true;
+		lock.unlock();
+		const char * error = nullptr;
+		try {
+			commit_batch(batch, first);
+		} catch (const char * s) {
+			error = s;
+		}
+		lock.lock();
+		m_committing = false;
+		if (error != nullptr) m_error = error;
+		m_done.notify_all();
+		if (m_error != nullptr) {
+			m_pending.swap(batch); /// keep descriptors around for the destructor
+			return;
+		}
+	}
+}
+
+void share_vault::commit_batch(std::vector<pending_share> & batch, std::chrono::steady_clock::time_point first) {
+	vault_batch_stats stats;
+	stats.shares = batch.size();
+	stats.bytes = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	/// 1. share data, one flush of the whole filesystem instead of fsync per file
+	std::string records;
+	for (auto && p: batch) {
+		stats.bytes += p.length;
+		records += p.name + " " + std::to_string(p.length) + " " + std::to_string(p.generation) + "\n";
+	}
+#ifdef __linux__
+	bool synced = syncfs(m_dirfd) == 0;
+#else
+	bool synced = false;
+#endif
+	for (auto && p: batch) {
+		if (!synced && fdatasync(p.fd) != 0) throw "Cannot flush share file in vault";
+	}
+	/// 2. manifest, from now on the batch is committed
+	write_all(m_manifest, reinterpret_cast<const uint8_t *>(records.data()), records.size());
+	if (fdatasync(m_manifest) != 0) throw "Cannot flush vault manifest";
+	auto synced_at = std::chrono::steady_clock::now();
+
+	/// 3. publish final names
+	for (auto && p: batch) {
+		close(p.fd);
+		p.fd = -1;
+		if (renameat(m_dirfd, temp_path(p.name, p.generation).c_str(), m_dirfd, p.name.c_str()) != 0) throw "Cannot rename share file in vault";
+	}
+	if (fsync(m_dirfd) != 0) throw "Cannot flush vault directory";
+	auto done = std::chrono::steady_clock::now();
+	batch.clear();
+
+	stats.sync_ms = milliseconds(synced_at - start);
+	stats.rename_ms = milliseconds(done - synced_at);
+	stats.total_ms = milliseconds(done - first);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_batches.push_back(stats);
+}
@@ -0,0 +1,75 @@
+#ifndef VAULT
+#define VAULT
+
+#include <vector>
+#include <string>
+#include <set>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+/// timing of one group commit, durations in milliseconds
+struct vault_batch_stats {
+	size_t shares;
+	uint64_t bytes;
+	double sync_ms, rename_ms, total_ms; // total_ms counts from the first share of the batch being written
+};
+
+/**
+ * durable directory of small share files with group commit.
+ *
+ * put() writes share into hidden temporary file and returns without waiting for the device.
+ * Background committer makes pending shares durable in groups, once 'commit_size' shares
+ * are pending or 'commit_interval' passed since the first of them was written:
+ *   1. data of all pending files is flushed,
+ *   2. batch is appended to MANIFEST which is flushed,
+ *   3. temporary files are renamed to their final names and directory is flushed once.
+ * So every batch costs a constant number of flushes instead of write+fsync+rename per file.
+ * Every put gets a generation number, unique over the whole MANIFEST, which is part of the
+ * temporary file name and of the MANIFEST record. When the vault is opened again, a temporary
+ * file is renamed only if a complete MANIFEST record names its exact generation and length
+ * (batch was durable, renaming did not finish); other temporary files are removed, so a share
+ * stored again under a committed name never replaces it before its own record is durable.
+ */
+class share_vault {
+	private:
+		struct pending_share {
+			std::string name;
+			uint64_t generation;
+			int fd;
+			size_t length;
+		};
+		std::string m_dir;
+		int m_dirfd, m_manifest;
+		size_t m_commit_size;
+		std::chrono::milliseconds m_commit_interval;
+		std::vector<pending_share> m_pending;
+		std::set<std::string> m_pending_names;
+		std::chrono::steady_clock::time_point m_first_pending;
+		std::vector<vault_batch_stats> m_batches;
+		bool m_flush, m_committing, m_stop;
+		uint64_t m_next_generation;
+		const char * m_error;
+		std::mutex m_mutex;
+		std::condition_variable m_wake, m_done;
+		std::thread m_committer;
+
+		void recover();
+		void committer();
+		void commit_batch(std::vector<pending_share> & batch, std::chrono::steady_clock::time_point first);
+		static std::string temp_path(const std::string & name, uint64_t generation);
+	public:
+		share_vault(const std::string & dir, size_t commit_size = 256, std::chrono::milliseconds commit_interval = std::chrono::milliseconds(20));
+		share_vault(const share_vault &) = delete;
+		share_vault & operator = (const share_vault &) = delete;
+		~share_vault(); // commits whatever is pending
+		void put(const std::string & name, const uint8_t * data, size_t length); // name must not start with '.', nor contain '/' or whitespace
+		void commit(); // returns once every share put so far is durable, throws if any commit failed
+		std::vector<std::string> list() const; // names of committed shares, read from MANIFEST only
+		std::vector<vault_batch_stats> batches(); // stats of every group commit so far
+};
+
+#endif
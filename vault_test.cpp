@@ -0,0 +1,109 @@
+#include <vault.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cassert>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+	std::string read_file(const std::string & path) {
+		std::ifstream f(path);
+		std::stringstream ss;
+		ss << f.rdbuf();
+		return ss.str();
+	}
+}
+
+/// every share put is listed and readable after commit, fsyncs are grouped into batches
+void test_group_commit(const std::string & dir) {
+	share_vault vault(dir, 64, std::chrono::milliseconds(1000));
+	for (int i = 0; i < 1000; ++i) {
+		std::string share("share number " + std::to_string(i));
+		vault.put("wallet" + std::to_string(i / 5) + ".share" + std::to_string(i % 5 + 1), reinterpret_cast<const uint8_t *>(share.data()), share.size());
+	}
+	vault.commit();
+	auto names = vault.list();
+	assert(names.size() == 1000);
+	assert(read_file(dir + "/wallet17.share3") == "share number 87");
+	auto batches = vault.batches();
+	size_t shares(0);
+	for (auto && b: batches) {
+		assert(b.shares <= 128);
+		shares += b.shares;
+	}
+	assert(shares == 1000);
+	assert(batches.size() < 1000 / 8);
+	std::cout << "1000 shares committed in " << batches.size() << " batches: passed" << std::endl;
+}
+
+/// lonely share is committed by interval even without explicit commit
+void test_interval(const std::string & dir) {
+	share_vault vault(dir, 1000, std::chrono::milliseconds(5));
+	vault.put("lonely", reinterpret_cast<const uint8_t *>("x"), 1);
+	for (int i = 0; i < 200 && vault.batches().empty(); ++i) usleep(10000);
+	assert(vault.batches().size() == 1);
+	std::cout << "commit interval: passed" << std::endl;
+}
+
+/// temporary files of committed generations are published on reopen, others are dropped
+void test_recovery(const std::string & dir) {
+	{
+		mkdir(dir.c_str(), 0700);
+		std::ofstream(dir + "/.tmp.1.torn") << "not committed";
+		std::ofstream(dir + "/.tmp.2.committed") << "committed";
+		std::ofstream(dir + "/.tmp.torn") << "no generation";
+		std::ofstream(dir + "/MANIFEST", std::ios::app) << "committed 9 2\n";
+	}
+	{
+		share_vault vault(dir);
+		assert(access((dir + "/.tmp.1.torn").c_str(), F_OK) != 0);
+		assert(access((dir + "/.tmp.torn").c_str(), F_OK) != 0);
+		assert(access((dir + "/torn").c_str(), F_OK) != 0);
+		assert(read_file(dir + "/committed") == "committed");
+	}
+	/// committed name stored again, crashed before its record: an older record of the name or a torn one publishes nothing
+	{
+		std::ofstream(dir + "/.tmp.3.committed") << "unsynced";
+		std::ofstream(dir + "/.tmp.4.committed") << "torn";
+		std::ofstream(dir + "/MANIFEST", std::ios::app) << "committed 4 4";
+	}
+	share_vault vault(dir);
+	assert(read_file(dir + "/committed") == "committed");
+	assert(access((dir + "/.tmp.3.committed").c_str(), F_OK) != 0 && access((dir + "/.tmp.4.committed").c_str(), F_OK) != 0);
+	assert(vault.list() == std::vector<std::string>({"committed"}));
+	vault.put("committed", reinterpret_cast<const uint8_t *>("again"), 5);
+	vault.commit();
+	assert(read_file(dir + "/committed") == "again");
+	assert(read_file(dir + "/MANIFEST") == "committed 9 2\ncommitted 5 3\n");
+	for (const char * name: {"../escape", "a b", "a\tb"}) {
+		try {
+			vault.put(name, reinterpret_cast<const uint8_t *>("x"), 1);
+			assert(false);
+		} catch (const char * s) {
+			assert(std::string(s) == "Invalid share name");
+		}
+	}
+	std::cout << "vault recovery: passed" << std::endl;
+}
+
+int main() {
+	char dir_template[] = "/tmp/vault_test.XXXXXX";
+	const char * dir = mkdtemp(dir_template);
+	assert(dir != nullptr);
+	try {
+		test_group_commit(std::string(dir) + "/a");
+		test_interval(std::string(dir) + "/b");
+		test_recovery(std::string(dir) + "/c");
+	} catch (const char *s) {
+		std::cout << s << std::endl;
+		return 1;
+	}
+	std::system(("rm -rf " + std::string(dir)).c_str());
+	return 0;
+}
@@ -1,115 +1,1162 @@
 #include <wordlist.h>
 #include <sha256.h>
+#include <byteorder.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <string>
+#include <endian.h>
+
+#if defined(__x86_64__)
+#include <cpufeatures.h>
+#include <immintrin.h>
+#endif
+
+extern constexpr std::array<word_view, 1024> slip_words = {{
+		"academic", "acid",     "acoustic", "actor",    "actress", 
+		"adapt",    "adjust",   "admit",    "adult",    "advance", 
+		"advice",   "aerobic",  "afraid",   "again",    "agent",   
+		"agree",    "airport",  "aisle",    "alarm",    "album",   
+		"alcohol",  "alert",    "alien",    "alpha",    "already", 
+		"also",     "alter",    "always",   "amazing",  "amount",  
+		"amused",   "analyst",  "anchor",   "anger",    "angry",   
+		"animal",   "answer",   "antenna",  "antique",  "anxiety", 
+		"anything", "apart",    "april",    "arctic",   "arena",   
+		"argue",    "armed",    "armor",    "army",     "artefact",
+		"artist",   "artwork",  "aspect",   "atom",     "auction", 
+		"august",   "aunt",     "average",  "avocado",  "avoid",   
+		"awake",    "away",     "awesome",  "awful",    "awkward", 
+		"axis",     "bean",     "beauty",   "because",  "become",  
+		"bedroom",  "behave",   "believe",  "below",    "bench",   
+		"benefit",  "best",     "betray",   "between",  "beyond",  
+		"bicycle",  "bike",     "biology",  "bird",     "birth",   
+		"black",    "blame",    "blanket",  "bleak",    "blind",   
+		"blossom",  "boat",     "body",     "bomb",     "border",  
+		"bounce",   "bowl",     "bracket",  "brain",    "brand",   
+		"brave",    "bread",    "bridge",   "brief",    "broccoli",
+		"broken",   "brother",  "brown",    "brush",    "budget",  
+		"build",    "bulb",     "burden",   "burger",   "burn",    
+		"busy",     "buyer",    "cactus",   "camera",   "campaign",
+		"canal",    "canyon",   "capital",  "captain",  "carbon",  
+		"career",   "carpet",   "casino",   "castle",   "catalog", 
+		"catch",    "category", "cause",    "ceiling",  "cement",  
+		"census",   "chair",    "chaos",    "chat",     "cheap",   
+		"check",    "choice",   "chuckle",  "churn",    "circle",  
+		"city",     "civil",    "claim",    "clap",     "clarify", 
+		"clean",    "clerk",    "clever",   "click",    "client",  
+		"climb",    "clinic",   "clog",     "close",    "cloth",   
+		"clown",    "club",     "clump",    "cluster",  "coach",   
+		"coconut",  "code",     "coil",     "column",   "comfort", 
+		"comic",    "coral",    "corn",     "cost",     "country", 
+		"cousin",   "cover",    "coyote",   "cradle",   "craft",   
+		"crane",    "crater",   "crazy",    "credit",   "crew",    
+		"cricket",  "crime",    "crisp",    "critic",   "cross",   
+		"crouch",   "crowd",    "crucial",  "cruel",    "cruise",  
+		"crunch",   "crystal",  "cube",     "culture",  "cupboard",
+		"curious",  "curve",    "cycle",    "daily",    "damage",  
+		"dance",    "daughter", "death",    "debris",   "decade",  
+		"december", "decision", "decline",  "decorate", "decrease",
+		"degree",   "delay",    "deliver",  "denial",   "dentist", 
+		"deny",     "depart",   "depend",   "describe", "desert",  
+		"design",   "desk",     "despair",  "destroy",  "detail",  
+		"detect",   "device",   "devote",   "diamond",  "diary",   
+		"diesel",   "diet",     "dilemma",  "direct",   "disagree",
+		"dismiss",  "display",  "distance", "divert",   "divorce", 
+		"doctor",   "dolphin",  "domain",   "dose",     "double",  
+		"dozen",    "dragon",   "drama",    "drastic",  "dream",   
+		"dress",    "drift",    "drink",    "drum",     "duck",    
+		"dumb",     "dune",     "dwarf",    "dynamic",  "eager",   
+		"eagle",    "early",    "earn",     "earth",    "easy",    
+		"echo",     "ecology",  "edge",     "edit",     "educate", 
+		"elbow",    "elder",    "electric", "elegant",  "element", 
+		"elephant", "elevator", "elite",    "else",     "embrace", 
+		"emerge",   "employ",   "empty",    "endless",  "endorse", 
+		"enemy",    "energy",   "enforce",  "engage",   "enjoy",   
+		"enlist",   "enroll",   "entire",   "entry",    "envelope",
+		"episode",  "equal",    "erase",    "erode",    "erosion", 
+		"erupt",    "escape",   "estate",   "eternal",  "event",   
+		"evidence", "evil",     "evolve",   "exact",    "example", 
+		"excess",   "exchange", "exclude",  "excuse",   "execute", 
+		"exercise", "exhaust",  "exile",    "exist",    "exotic",  
+		"expand",   "expect",   "expire",   "explain",  "express", 
+		"extend",   "extra",    "eyebrow",  "face",     "facility",
+		"faculty",  "faint",    "faith",    "false",    "family",  
+		"famous",   "fancy",    "fantasy",  "fashion",  "fatal",   
+		"fatigue",  "favorite", "fiber",    "fiction",  "field",   
+		"file",     "filter",   "final",    "find",     "finish",  
+		"firm",     "fiscal",   "fish",     "fitness",  "flag",    
+		"flavor",   "flip",     "float",    "flower",   "fluid",   
+		"foam",     "focus",    "fold",     "force",    "forest",  
+		"forget",   "fork",     "fortune",  "forward",  "fragile", 
+		"frame",    "frequent", "fresh",    "friend",   "fringe",  
+		"frog",     "frozen",   "fruit",    "fuel",     "function",
+		"furnace",  "fury",     "gadget",   "galaxy",   "garden",  
+		"garlic",   "gasp",     "gate",     "gauge",    "general", 
+		"genius",   "genre",    "gentle",   "gesture",  "glad",    
+		"glance",   "glare",    "glide",    "glimpse",  "glue",    
+		"goal",     "golden",   "grape",    "grass",    "gravity", 
+		"great",    "grid",     "grocery",  "group",    "grow",    
+		"grunt",    "guard",    "guess",    "guilt",    "guitar",  
+		"half",     "hamster",  "hand",     "harbor",   "harvest", 
+		"hawk",     "hazard",   "head",     "heart",    "heavy",   
+		"hedgehog", "help",     "hero",     "hockey",   "holiday", 
+		"hospital", "hotel",    "hour",     "huge",     "human",   
+		"hundred",  "hurdle",   "hurt",     "husband",  "hybrid",  
+		"idea",     "identify", "idle",     "image",    "imitate", 
+		"impact",   "improve",  "impulse",  "inch",     "income",  
+		"increase", "index",    "industry", "infant",   "inflict", 
+		"inform",   "inhale",   "inherit",  "injury",   "inmate",  
+		"insane",   "insect",   "inside",   "install",  "intact",  
+		"invite",   "involve",  "island",   "isolate",  "item",    
+		"ivory",    "jacket",   "jaguar",   "jealous",  "jeans",   
+		"jewel",    "join",     "joke",     "judge",    "juice",   
+		"jump",     "jungle",   "junk",     "ketchup",  "kick",    
+		"kingdom",  "kitchen",  "kite",     "kiwi",     "knife",   
+		"lady",     "lamp",     "large",    "laugh",    "laundry", 
+		"lava",     "lawn",     "lawsuit",  "layer",    "leader",  
+		"leaf",     "league",   "leave",    "lecture",  "legal",   
+		"legend",   "leisure",  "lemon",    "length",   "lens",    
+		"level",    "liberty",  "library",  "license",  "lift",    
+		"likely",   "limit",    "line",     "living",   "lizard",  
+		"loan",     "lobster",  "local",    "lock",     "loud",    
+		"love",     "lucky",    "lunar",    "lunch",    "luxury",  
+		"lyrics",   "machine",  "magazine", "magnet",   "maid",    
+		"make",     "manage",   "mandate",  "mango",    "mansion", 
+		"manual",   "maple",    "marble",   "march",    "mask",    
+		"master",   "material", "matrix",   "maximum",  "meaning", 
+		"measure",  "media",    "melt",     "member",   "menu",    
+		"mercy",    "mesh",     "metal",    "method",   "midnight",
+		"minute",   "miracle",  "misery",   "mistake",  "mixed",   
+		"mixture",  "mobile",   "model",    "modify",   "moment",  
+		"more",     "morning",  "motor",    "mouse",    "movie",   
+		"much",     "mule",     "multiply", "muscle",   "museum",  
+		"music",    "must",     "myself",   "mystery",  "myth",    
+		"naive",    "name",     "napkin",   "neck",     "negative",
+		"neglect",  "neither",  "nephew",   "nerve",    "network", 
+		"news",     "nice",     "nuclear",  "number",   "obey",    
+		"object",   "oblige",   "obscure",  "obtain",   "ocean",   
+		"october",  "odor",     "often",    "olive",    "olympic", 
+		"orange",   "orbit",    "ordinary", "organ",    "orient",  
+		"ostrich",  "other",    "oven",     "owner",    "oyster",  
+		"package",  "pact",     "painting", "pair",     "palace",  
+		"panda",    "panic",    "panther",  "paper",    "parade",  
+		"parent",   "park",     "party",    "path",     "patrol",  
+		"pave",     "payment",  "peace",    "peanut",   "peasant", 
+		"pelican",  "penalty",  "pencil",   "perfect",  "period",  
+		"permit",   "photo",    "phrase",   "physical", "piano",   
+		"picnic",   "picture",  "piece",    "pilot",    "pink",    
+		"pipe",     "pistol",   "pitch",    "planet",   "plastic", 
+		"plate",    "play",     "please",   "pledge",   "pluck",   
+		"plug",     "plunge",   "practice", "predict",  "prepare", 
+		"present",  "pretty",   "primary",  "priority", "prison",  
+		"private",  "prize",    "problem",  "produce",  "profit",  
+		"program",  "promote",  "prosper",  "proud",    "public",  
+		"pulse",    "pumpkin",  "pupil",    "purchase", "purpose", 
+		"push",     "pyramid",  "quantum",  "quarter",  "question",
+		"quick",    "quiz",     "quote",    "rack",     "radar",   
+		"radio",    "raise",    "ranch",    "rapid",    "rare",    
+		"raven",    "razor",    "ready",    "real",     "rebel",   
+		"recall",   "receive",  "recipe",   "recycle",  "regret",  
+		"regular",  "reject",   "relax",    "rely",     "remind",  
+		"remove",   "render",   "repair",   "repeat",   "replace", 
+		"rescue",   "resemble", "resist",   "response", "retreat", 
+		"reunion",  "review",   "reward",   "rhythm",   "rich",    
+		"rifle",    "ring",     "risk",     "rival",    "river",   
+		"road",     "robot",    "robust",   "rocket",   "romance", 
+		"rotate",   "rough",    "royal",    "rude",     "runway",  
+		"rural",    "sadness",  "salad",    "salon",    "salt",    
+		"satisfy",  "satoshi",  "sauce",    "sausage",  "scale",   
+		"scan",     "scatter",  "scene",    "school",   "science", 
+		"scissors", "scorpion", "scout",    "scrap",    "screen",  
+		"script",   "scrub",    "search",   "seat",     "second",  
+		"secret",   "security", "segment",  "select",   "senior",  
+		"sense",    "sentence", "service",  "seven",    "shadow",  
+		"shaft",    "share",    "shed",     "sheriff",  "shock",   
+		"shoe",     "short",    "shoulder", "shrimp",   "sibling", 
+		"siege",    "silent",   "silver",   "similar",  "simple",  
+		"siren",    "sister",   "size",     "skate",    "sketch",  
+		"skin",     "skirt",    "skull",    "slender",  "slice",   
+		"slogan",   "slow",     "slush",    "small",    "smart",   
+		"smile",    "smoke",    "snake",    "social",   "soda",    
+		"soft",     "soldier",  "solve",    "someone",  "soul",    
+		"sound",    "source",   "spawn",    "special",  "spell",   
+		"spend",    "sphere",   "spider",   "spike",    "spirit",  
+		"split",    "spray",    "spread",   "spring",   "squeeze", 
+		"stadium",  "staff",    "stage",    "stamp",    "stand",   
+		"station",  "stay",     "steak",    "step",     "stereo",  
+		"stick",    "still",    "sting",    "stomach",  "stove",   
+		"strike",   "strong",   "style",    "sugar",    "suit",    
+		"sunset",   "super",    "surface",  "survey",   "swallow", 
+		"swap",     "swear",    "swift",    "swim",     "switch",  
+		"sword",    "symbol",   "symptom",  "system",   "tackle",  
+		"tail",     "talent",   "target",   "taxi",     "teach",   
+		"team",     "tenant",   "text",     "thank",    "theater", 
+		"theme",    "theory",   "throw",    "thunder",  "ticket",  
+		"tilt",     "timber",   "time",     "tiny",     "tired",   
+		"title",    "toast",    "today",    "together", "toilet",  
+		"token",    "tomato",   "torch",    "tornado",  "tortoise",
+		"total",    "tourist",  "tower",    "town",     "trade",   
+		"traffic",  "transfer", "trash",    "travel",   "tray",    
+		"trend",    "trial",    "trick",    "trim",     "trouble", 
+		"true",     "trumpet",  "trust",    "twelve",   "twenty",  
+		"twice",    "twin",     "twist",    "type",     "typical", 
+		"ugly",     "umbrella", "unaware",  "uncle",    "uncover", 
+		"under",    "unfair",   "unfold",   "unhappy",  "unique",  
+		"universe", "unknown",  "until",    "upgrade",  "upset",   
+		"urge",     "usage",    "used",     "useless",  "usual",   
+		"vacant",   "vacuum",   "vague",    "valid",    "valve",   
+		"vanish",   "vast",     "vault",    "velvet",   "vendor",  
+		"venture",  "verify",   "very",     "veteran",  "vibrant", 
+		"vicious",  "victory",  "video",    "view",     "vintage", 
+		"violin",   "virus",    "visa",     "visit",    "vital",   
+		"vivid",    "voice",    "volcano",  "volume",   "vote",    
+		"voyage",   "wage",     "wagon",    "wait",     "walnut",  
+		"warfare",  "warm",     "warning",  "wash",     "waste",   
+		"water",    "wealth",   "weapon",   "weather",  "weird",   
+		"welcome",  "western",  "whale",    "wheat",    "when",    
+		"where",    "width",    "wild",     "window",   "winter",  
+		"wire",     "wisdom",   "wolf",     "woman",    "world",   
+		"worth",    "wrap",     "wreck",    "wrestle",  "wrist",   
+		"write",    "yard",     "young",    "zebra"
+	}};
+
+extern constexpr std::array<word_view, 2048> bip_words = {{
+		"abandon",  "ability",  "able",     "about",    "above",   
+		"absent",   "absorb",   "abstract", "absurd",   "abuse",   
+		"access",   "accident", "account",  "accuse",   "achieve", 
+		"acid",     "acoustic", "acquire",  "across",   "act",     
+		"action",   "actor",    "actress",  "actual",   "adapt",   
+		"add",      "addict",   "address",  "adjust",   "admit",   
+		"adult",    "advance",  "advice",   "aerobic",  "affair",  
+		"afford",   "afraid",   "again",    "age",      "agent",   
+		"agree",    "ahead",    "aim",      "air",      "airport", 
+		"aisle",    "alarm",    "album",    "alcohol",  "alert",   
+		"alien",    "all",      "alley",    "allow",    "almost",  
+		"alone",    "alpha",    "already",  "also",     "alter",   
+		"always",   "amateur",  "amazing",  "among",    "amount",  
+		"amused",   "analyst",  "anchor",   "ancient",  "anger",   
+		"angle",    "angry",    "animal",   "ankle",    "announce",
+		"annual",   "another",  "answer",   "antenna",  "antique", 
+		"anxiety",  "any",      "apart",    "apology",  "appear",  
+		"apple",    "approve",  "april",    "arch",     "arctic",  
+		"area",     "arena",    "argue",    "arm",      "armed",   
+		"armor",    "army",     "around",   "arrange",  "arrest",  
+		"arrive",   "arrow",    "art",      "artefact", "artist",  
+		"artwork",  "ask",      "aspect",   "assault",  "asset",   
+		"assist",   "assume",   "asthma",   "athlete",  "atom",    
+		"attack",   "attend",   "attitude", "attract",  "auction", 
+		"audit",    "august",   "aunt",     "author",   "auto",    
+		"autumn",   "average",  "avocado",  "avoid",    "awake",   
+		"aware",    "away",     "awesome",  "awful",    "awkward", 
+		"axis",     "baby",     "bachelor", "bacon",    "badge",   
+		"bag",      "balance",  "balcony",  "ball",     "bamboo",  
+		"banana",   "banner",   "bar",      "barely",   "bargain", 
+		"barrel",   "base",     "basic",    "basket",   "battle",  
+		"beach",    "bean",     "beauty",   "because",  "become",  
+		"beef",     "before",   "begin",    "behave",   "behind",  
+		"believe",  "below",    "belt",     "bench",    "benefit", 
+		"best",     "betray",   "better",   "between",  "beyond",  
+		"bicycle",  "bid",      "bike",     "bind",     "biology", 
+		"bird",     "birth",    "bitter",   "black",    "blade",   
+		"blame",    "blanket",  "blast",    "bleak",    "bless",   
+		"blind",    "blood",    "blossom",  "blouse",   "blue",    
+		"blur",     "blush",    "board",    "boat",     "body",    
+		"boil",     "bomb",     "bone",     "bonus",    "book",    
+		"boost",    "border",   "boring",   "borrow",   "boss",    
+		"bottom",   "bounce",   "box",      "boy",      "bracket", 
+		"brain",    "brand",    "brass",    "brave",    "bread",   
+		"breeze",   "brick",    "bridge",   "brief",    "bright",  
+		"bring",    "brisk",    "broccoli", "broken",   "bronze",  
+		"broom",    "brother",  "brown",    "brush",    "bubble",  
+		"buddy",    "budget",   "buffalo",  "build",    "bulb",    
+		"bulk",     "bullet",   "bundle",   "bunker",   "burden",  
+		"burger",   "burst",    "bus",      "business", "busy",    
+		"butter",   "buyer",    "buzz",     "cabbage",  "cabin",   
+		"cable",    "cactus",   "cage",     "cake",     "call",    
+		"calm",     "camera",   "camp",     "can",      "canal",   
+		"cancel",   "candy",    "cannon",   "canoe",    "canvas",  
+		"canyon",   "capable",  "capital",  "captain",  "car",     
+		"carbon",   "card",     "cargo",    "carpet",   "carry",   
+		"cart",     "case",     "cash",     "casino",   "castle",  
+		"casual",   "cat",      "catalog",  "catch",    "category",
+		"cattle",   "caught",   "cause",    "caution",  "cave",    
+		"ceiling",  "celery",   "cement",   "census",   "century", 
+		"cereal",   "certain",  "chair",    "chalk",    "champion",
+		"change",   "chaos",    "chapter",  "charge",   "chase",   
+		"chat",     "cheap",    "check",    "cheese",   "chef",    
+		"cherry",   "chest",    "chicken",  "chief",    "child",   
+		"chimney",  "choice",   "choose",   "chronic",  "chuckle", 
+		"chunk",    "churn",    "cigar",    "cinnamon", "circle",  
+		"citizen",  "city",     "civil",    "claim",    "clap",    
+		"clarify",  "claw",     "clay",     "clean",    "clerk",   
+		"clever",   "click",    "client",   "cliff",    "climb",   
+		"clinic",   "clip",     "clock",    "clog",     "close",   
+		"cloth",    "cloud",    "clown",    "club",     "clump",   
+		"cluster",  "clutch",   "coach",    "coast",    "coconut", 
+		"code",     "coffee",   "coil",     "coin",     "collect", 
+		"color",    "column",   "combine",  "come",     "comfort", 
+		"comic",    "common",   "company",  "concert",  "conduct", 
+		"confirm",  "congress", "connect",  "consider", "control", 
+		"convince", "cook",     "cool",     "copper",   "copy",    
+		"coral",    "core",     "corn",     "correct",  "cost",    
+		"cotton",   "couch",    "country",  "couple",   "course",  
+		"cousin",   "cover",    "coyote",   "crack",    "cradle",  
+		"craft",    "cram",     "crane",    "crash",    "crater",  
+		"crawl",    "crazy",    "cream",    "credit",   "creek",   
+		"crew",     "cricket",  "crime",    "crisp",    "critic",  
+		"crop",     "cross",    "crouch",   "crowd",    "crucial", 
+		"cruel",    "cruise",   "crumble",  "crunch",   "crush",   
+		"cry",      "crystal",  "cube",     "culture",  "cup",     
+		"cupboard", "curious",  "current",  "curtain",  "curve",   
+		"cushion",  "custom",   "cute",     "cycle",    "dad",     
+		"damage",   "damp",     "dance",    "danger",   "daring",  
+		"dash",     "daughter", "dawn",     "day",      "deal",    
+		"debate",   "debris",   "decade",   "december", "decide",  
+		"decline",  "decorate", "decrease", "deer",     "defense", 
+		"define",   "defy",     "degree",   "delay",    "deliver", 
+		"demand",   "demise",   "denial",   "dentist",  "deny",    
+		"depart",   "depend",   "deposit",  "depth",    "deputy",  
+		"derive",   "describe", "desert",   "design",   "desk",    
+		"despair",  "destroy",  "detail",   "detect",   "develop", 
+		"device",   "devote",   "diagram",  "dial",     "diamond", 
+		"diary",    "dice",     "diesel",   "diet",     "differ",  
+		"digital",  "dignity",  "dilemma",  "dinner",   "dinosaur",
+		"direct",   "dirt",     "disagree", "discover", "disease", 
+		"dish",     "dismiss",  "disorder", "display",  "distance",
+		"divert",   "divide",   "divorce",  "dizzy",    "doctor",  
+		"document", "dog",      "doll",     "dolphin",  "domain",  
+		"donate",   "donkey",   "donor",    "door",     "dose",    
+		"double",   "dove",     "draft",    "dragon",   "drama",   
+		"drastic",  "draw",     "dream",    "dress",    "drift",   
+		"drill",    "drink",    "drip",     "drive",    "drop",    
+		"drum",     "dry",      "duck",     "dumb",     "dune",    
+		"during",   "dust",     "dutch",    "duty",     "dwarf",   
+		"dynamic",  "eager",    "eagle",    "early",    "earn",    
+		"earth",    "easily",   "east",     "easy",     "echo",    
+		"ecology",  "economy",  "edge",     "edit",     "educate", 
+		"effort",   "egg",      "eight",    "either",   "elbow",   
+		"elder",    "electric", "elegant",  "element",  "elephant",
+		"elevator", "elite",    "else",     "embark",   "embody",  
+		"embrace",  "emerge",   "emotion",  "employ",   "empower", 
+		"empty",    "enable",   "enact",    "end",      "endless", 
+		"endorse",  "enemy",    "energy",   "enforce",  "engage",  
+		"engine",   "enhance",  "enjoy",    "enlist",   "enough",  
+		"enrich",   "enroll",   "ensure",   "enter",    "entire",  
+		"entry",    "envelope", "episode",  "equal",    "equip",   
+		"era",      "erase",    "erode",    "erosion",  "error",   
+		"erupt",    "escape",   "essay",    "essence",  "estate",  
+		"eternal",  "ethics",   "evidence", "evil",     "evoke",   
+		"evolve",   "exact",    "example",  "excess",   "exchange",
+		"excite",   "exclude",  "excuse",   "execute",  "exercise",
+		"exhaust",  "exhibit",  "exile",    "exist",    "exit",    
+		"exotic",   "expand",   "expect",   "expire",   "explain", 
+		"expose",   "express",  "extend",   "extra",    "eye",     
+		"eyebrow",  "fabric",   "face",     "faculty",  "fade",    
+		"faint",    "faith",    "fall",     "false",    "fame",    
+		"family",   "famous",   "fan",      "fancy",    "fantasy", 
+		"farm",     "fashion",  "fat",      "fatal",    "father",  
+		"fatigue",  "fault",    "favorite", "feature",  "february",
+		"federal",  "fee",      "feed",     "feel",     "female",  
+		"fence",    "festival", "fetch",    "fever",    "few",     
+		"fiber",    "fiction",  "field",    "figure",   "file",    
+		"film",     "filter",   "final",    "find",     "fine",    
+		"finger",   "finish",   "fire",     "firm",     "first",   
+		"fiscal",   "fish",     "fit",      "fitness",  "fix",     
+		"flag",     "flame",    "flash",    "flat",     "flavor",  
+		"flee",     "flight",   "flip",     "float",    "flock",   
+		"floor",    "flower",   "fluid",    "flush",    "fly",     
+		"foam",     "focus",    "fog",      "foil",     "fold",    
+		"follow",   "food",     "foot",     "force",    "forest",  
+		"forget",   "fork",     "fortune",  "forum",    "forward", 
+		"fossil",   "foster",   "found",    "fox",      "fragile", 
+		"frame",    "frequent", "fresh",    "friend",   "fringe",  
+		"frog",     "front",    "frost",    "frown",    "frozen",  
+		"fruit",    "fuel",     "fun",      "funny",    "furnace", 
+		"fury",     "future",   "gadget",   "gain",     "galaxy",  
+		"gallery",  "game",     "gap",      "garage",   "garbage", 
+		"garden",   "garlic",   "garment",  "gas",      "gasp",    
+		"gate",     "gather",   "gauge",    "gaze",     "general", 
+		"genius",   "genre",    "gentle",   "genuine",  "gesture", 
+		"ghost",    "giant",    "gift",     "giggle",   "ginger",  
+		"giraffe",  "girl",     "give",     "glad",     "glance",  
+		"glare",    "glass",    "glide",    "glimpse",  "globe",   
+		"gloom",    "glory",    "glove",    "glow",     "glue",    
+		"goat",     "goddess",  "gold",     "good",     "goose",   
+		"gorilla",  "gospel",   "gossip",   "govern",   "gown",    
+		"grab",     "grace",    "grain",    "grant",    "grape",   
+		"grass",    "gravity",  "great",    "green",    "grid",    
+		"grief",    "grit",     "grocery",  "group",    "grow",    
+		"grunt",    "guard",    "guess",    "guide",    "guilt",   
+		"guitar",   "gun",      "gym",      "habit",    "hair",    
+		"half",     "hammer",   "hamster",  "hand",     "happy",   
+		"harbor",   "hard",     "harsh",    "harvest",  "hat",     
+		"have",     "hawk",     "hazard",   "head",     "health",  
+		"heart",    "heavy",    "hedgehog", "height",   "hello",   
+		"helmet",   "help",     "hen",      "hero",     "hidden",  
+		"high",     "hill",     "hint",     "hip",      "hire",    
+		"history",  "hobby",    "hockey",   "hold",     "hole",    
+		"holiday",  "hollow",   "home",     "honey",    "hood",    
+		"hope",     "horn",     "horror",   "horse",    "hospital",
+		"host",     "hotel",    "hour",     "hover",    "hub",     
+		"huge",     "human",    "humble",   "humor",    "hundred", 
+		"hungry",   "hunt",     "hurdle",   "hurry",    "hurt",    
+		"husband",  "hybrid",   "ice",      "icon",     "idea",    
+		"identify", "idle",     "ignore",   "ill",      "illegal", 
+		"illness",  "image",    "imitate",  "immense",  "immune",  
+		"impact",   "impose",   "improve",  "impulse",  "inch",    
+		"include",  "income",   "increase", "index",    "indicate",
+		"indoor",   "industry", "infant",   "inflict",  "inform",  
+		"inhale",   "inherit",  "initial",  "inject",   "injury",  
+		"inmate",   "inner",    "innocent", "input",    "inquiry", 
+		"insane",   "insect",   "inside",   "inspire",  "install", 
+		"intact",   "interest", "into",     "invest",   "invite",  
+		"involve",  "iron",     "island",   "isolate",  "issue",   
+		"item",     "ivory",    "jacket",   "jaguar",   "jar",     
+		"jazz",     "jealous",  "jeans",    "jelly",    "jewel",   
+		"job",      "join",     "joke",     "journey",  "joy",     
+		"judge",    "juice",    "jump",     "jungle",   "junior",  
+		"junk",     "just",     "kangaroo", "keen",     "keep",    
+		"ketchup",  "key",      "kick",     "kid",      "kidney",  
+		"kind",     "kingdom",  "kiss",     "kit",      "kitchen", 
+		"kite",     "kitten",   "kiwi",     "knee",     "knife",   
+		"knock",    "know",     "lab",      "label",    "labor",   
+		"ladder",   "lady",     "lake",     "lamp",     "language",
+		"laptop",   "large",    "later",    "latin",    "laugh",   
+		"laundry",  "lava",     "law",      "lawn",     "lawsuit", 
+		"layer",    "lazy",     "leader",   "leaf",     "learn",   
+		"leave",    "lecture",  "left",     "leg",      "legal",   
+		"legend",   "leisure",  "lemon",    "lend",     "length",  
+		"lens",     "leopard",  "lesson",   "letter",   "level",   
+		"liar",     "liberty",  "library",  "license",  "life",    
+		"lift",     "light",    "like",     "limb",     "limit",   
+		"link",     "lion",     "liquid",   "list",     "little",  
+		"live",     "lizard",   "load",     "loan",     "lobster", 
+		"local",    "lock",     "logic",    "lonely",   "long",    
+		"loop",     "lottery",  "loud",     "lounge",   "love",    
+		"loyal",    "lucky",    "luggage",  "lumber",   "lunar",   
+		"lunch",    "luxury",   "lyrics",   "machine",  "mad",     
+		"magic",    "magnet",   "maid",     "mail",     "main",    
+		"major",    "make",     "mammal",   "man",      "manage",  
+		"mandate",  "mango",    "mansion",  "manual",   "maple",   
+		"marble",   "march",    "margin",   "marine",   "market",  
+		"marriage", "mask",     "mass",     "master",   "match",   
+		"material", "math",     "matrix",   "matter",   "maximum", 
+		"maze",     "meadow",   "mean",     "measure",  "meat",    
+		"mechanic", "medal",    "media",    "melody",   "melt",    
+		"member",   "memory",   "mention",  "menu",     "mercy",   
+		"merge",    "merit",    "merry",    "mesh",     "message", 
+		"metal",    "method",   "middle",   "midnight", "milk",    
+		"million",  "mimic",    "mind",     "minimum",  "minor",   
+		"minute",   "miracle",  "mirror",   "misery",   "miss",    
+		"mistake",  "mix",      "mixed",    "mixture",  "mobile",  
+		"model",    "modify",   "mom",      "moment",   "monitor", 
+		"monkey",   "monster",  "month",    "moon",     "moral",   
+		"more",     "morning",  "mosquito", "mother",   "motion",  
+		"motor",    "mountain", "mouse",    "move",     "movie",   
+		"much",     "muffin",   "mule",     "multiply", "muscle",  
+		"museum",   "mushroom", "music",    "must",     "mutual",  
+		"myself",   "mystery",  "myth",     "naive",    "name",    
+		"napkin",   "narrow",   "nasty",    "nation",   "nature",  
+		"near",     "neck",     "need",     "negative", "neglect", 
+		"neither",  "nephew",   "nerve",    "nest",     "net",     
+		"network",  "neutral",  "never",    "news",     "next",    
+		"nice",     "night",    "noble",    "noise",    "nominee", 
+		"noodle",   "normal",   "north",    "nose",     "notable", 
+		"note",     "nothing",  "notice",   "novel",    "now",     
+		"nuclear",  "number",   "nurse",    "nut",      "oak",     
+		"obey",     "object",   "oblige",   "obscure",  "observe", 
+		"obtain",   "obvious",  "occur",    "ocean",    "october", 
+		"odor",     "off",      "offer",    "office",   "often",   
+		"oil",      "okay",     "old",      "olive",    "olympic", 
+		"omit",     "once",     "one",      "onion",    "online",  
+		"only",     "open",     "opera",    "opinion",  "oppose",  
+		"option",   "orange",   "orbit",    "orchard",  "order",   
+		"ordinary", "organ",    "orient",   "original", "orphan",  
+		"ostrich",  "other",    "outdoor",  "outer",    "output",  
+		"outside",  "oval",     "oven",     "over",     "own",     
+		"owner",    "oxygen",   "oyster",   "ozone",    "pact",    
+		"paddle",   "page",     "pair",     "palace",   "palm",    
+		"panda",    "panel",    "panic",    "panther",  "paper",   
+		"parade",   "parent",   "park",     "parrot",   "party",   
+		"pass",     "patch",    "path",     "patient",  "patrol",  
+		"pattern",  "pause",    "pave",     "payment",  "peace",   
+		"peanut",   "pear",     "peasant",  "pelican",  "pen",     
+		"penalty",  "pencil",   "people",   "pepper",   "perfect", 
+		"permit",   "person",   "pet",      "phone",    "photo",   
+		"phrase",   "physical", "piano",    "picnic",   "picture", 
+		"piece",    "pig",      "pigeon",   "pill",     "pilot",   
+		"pink",     "pioneer",  "pipe",     "pistol",   "pitch",   
+		"pizza",    "place",    "planet",   "plastic",  "plate",   
+		"play",     "please",   "pledge",   "pluck",    "plug",    
+		"plunge",   "poem",     "poet",     "point",    "polar",   
+		"pole",     "police",   "pond",     "pony",     "pool",    
+		"popular",  "portion",  "position", "possible", "post",    
+		"potato",   "pottery",  "poverty",  "powder",   "power",   
+		"practice", "praise",   "predict",  "prefer",   "prepare", 
+		"present",  "pretty",   "prevent",  "price",    "pride",   
+		"primary",  "print",    "priority", "prison",   "private", 
+		"prize",    "problem",  "process",  "produce",  "profit",  
+		"program",  "project",  "promote",  "proof",    "property",
+		"prosper",  "protect",  "proud",    "provide",  "public",  
+		"pudding",  "pull",     "pulp",     "pulse",    "pumpkin", 
+		"punch",    "pupil",    "puppy",    "purchase", "purity",  
+		"purpose",  "purse",    "push",     "put",      "puzzle",  
+		"pyramid",  "quality",  "quantum",  "quarter",  "question",
+		"quick",    "quit",     "quiz",     "quote",    "rabbit",  
+		"raccoon",  "race",     "rack",     "radar",    "radio",   
+		"rail",     "rain",     "raise",    "rally",    "ramp",    
+		"ranch",    "random",   "range",    "rapid",    "rare",    
+		"rate",     "rather",   "raven",    "raw",      "razor",   
+		"ready",    "real",     "reason",   "rebel",    "rebuild", 
+		"recall",   "receive",  "recipe",   "record",   "recycle", 
+		"reduce",   "reflect",  "reform",   "refuse",   "region",  
+		"regret",   "regular",  "reject",   "relax",    "release", 
+		"relief",   "rely",     "remain",   "remember", "remind",  
+		"remove",   "render",   "renew",    "rent",     "reopen",  
+		"repair",   "repeat",   "replace",  "report",   "require", 
+		"rescue",   "resemble", "resist",   "resource", "response",
+		"result",   "retire",   "retreat",  "return",   "reunion", 
+		"reveal",   "review",   "reward",   "rhythm",   "rib",     
+		"ribbon",   "rice",     "rich",     "ride",     "ridge",   
+		"rifle",    "right",    "rigid",    "ring",     "riot",    
+		"ripple",   "risk",     "ritual",   "rival",    "river",   
+		"road",     "roast",    "robot",    "robust",   "rocket",  
+		"romance",  "roof",     "rookie",   "room",     "rose",    
+		"rotate",   "rough",    "round",    "route",    "royal",   
+		"rubber",   "rude",     "rug",      "rule",     "run",     
+		"runway",   "rural",    "sad",      "saddle",   "sadness", 
+		"safe",     "sail",     "salad",    "salmon",   "salon",   
+		"salt",     "salute",   "same",     "sample",   "sand",    
+		"satisfy",  "satoshi",  "sauce",    "sausage",  "save",    
+		"say",      "scale",    "scan",     "scare",    "scatter", 
+		"scene",    "scheme",   "school",   "science",  "scissors",
+		"scorpion", "scout",    "scrap",    "screen",   "script",  
+		"scrub",    "sea",      "search",   "season",   "seat",    
+		"second",   "secret",   "section",  "security", "seed",    
+		"seek",     "segment",  "select",   "sell",     "seminar", 
+		"senior",   "sense",    "sentence", "series",   "service", 
+		"session",  "settle",   "setup",    "seven",    "shadow",  
+		"shaft",    "shallow",  "share",    "shed",     "shell",   
+		"sheriff",  "shield",   "shift",    "shine",    "ship",    
+		"shiver",   "shock",    "shoe",     "shoot",    "shop",    
+		"short",    "shoulder", "shove",    "shrimp",   "shrug",   
+		"shuffle",  "shy",      "sibling",  "sick",     "side",    
+		"siege",    "sight",    "sign",     "silent",   "silk",    
+		"silly",    "silver",   "similar",  "simple",   "since",   
+		"sing",     "siren",    "sister",   "situate",  "six",     
+		"size",     "skate",    "sketch",   "ski",      "skill",   
+		"skin",     "skirt",    "skull",    "slab",     "slam",    
+		"sleep",    "slender",  "slice",    "slide",    "slight",  
+		"slim",     "slogan",   "slot",     "slow",     "slush",   
+		"small",    "smart",    "smile",    "smoke",    "smooth",  
+		"snack",    "snake",    "snap",     "sniff",    "snow",    
+		"soap",     "soccer",   "social",   "sock",     "soda",    
+		"soft",     "solar",    "soldier",  "solid",    "solution",
+		"solve",    "someone",  "song",     "soon",     "sorry",   
+		"sort",     "soul",     "sound",    "soup",     "source",  
+		"south",    "space",    "spare",    "spatial",  "spawn",   
+		"speak",    "special",  "speed",    "spell",    "spend",   
+		"sphere",   "spice",    "spider",   "spike",    "spin",    
+		"spirit",   "split",    "spoil",    "sponsor",  "spoon",   
+		"sport",    "spot",     "spray",    "spread",   "spring",  
+		"spy",      "square",   "squeeze",  "squirrel", "stable",  
+		"stadium",  "staff",    "stage",    "stairs",   "stamp",   
+		"stand",    "start",    "state",    "stay",     "steak",   
+		"steel",    "stem",     "step",     "stereo",   "stick",   
+		"still",    "sting",    "stock",    "stomach",  "stone",   
+		"stool",    "story",    "stove",    "strategy", "street",  
+		"strike",   "strong",   "struggle", "student",  "stuff",   
+		"stumble",  "style",    "subject",  "submit",   "subway",  
+		"success",  "such",     "sudden",   "suffer",   "sugar",   
+		"suggest",  "suit",     "summer",   "sun",      "sunny",   
+		"sunset",   "super",    "supply",   "supreme",  "sure",    
+		"surface",  "surge",    "surprise", "surround", "survey",  
+		"suspect",  "sustain",  "swallow",  "swamp",    "swap",    
+		"swarm",    "swear",    "sweet",    "swift",    "swim",    
+		"swing",    "switch",   "sword",    "symbol",   "symptom", 
+		"syrup",    "system",   "table",    "tackle",   "tag",     
+		"tail",     "talent",   "talk",     "tank",     "tape",    
+		"target",   "task",     "taste",    "tattoo",   "taxi",    
+		"teach",    "team",     "tell",     "ten",      "tenant",  
+		"tennis",   "tent",     "term",     "test",     "text",    
+		"thank",    "that",     "theme",    "then",     "theory",  
+		"there",    "they",     "thing",    "this",     "thought", 
+		"three",    "thrive",   "throw",    "thumb",    "thunder", 
+		"ticket",   "tide",     "tiger",    "tilt",     "timber",  
+		"time",     "tiny",     "tip",      "tired",    "tissue",  
+		"title",    "toast",    "tobacco",  "today",    "toddler", 
+		"toe",      "together", "toilet",   "token",    "tomato",  
+		"tomorrow", "tone",     "tongue",   "tonight",  "tool",    
+		"tooth",    "top",      "topic",    "topple",   "torch",   
+		"tornado",  "tortoise", "toss",     "total",    "tourist", 
+		"toward",   "tower",    "town",     "toy",      "track",   
+		"trade",    "traffic",  "tragic",   "train",    "transfer",
+		"trap",     "trash",    "travel",   "tray",     "treat",   
+		"tree",     "trend",    "trial",    "tribe",    "trick",   
+		"trigger",  "trim",     "trip",     "trophy",   "trouble", 
+		"truck",    "true",     "truly",    "trumpet",  "trust",   
+		"truth",    "try",      "tube",     "tuition",  "tumble",  
+		"tuna",     "tunnel",   "turkey",   "turn",     "turtle",  
+		"twelve",   "twenty",   "twice",    "twin",     "twist",   
+		"two",      "type",     "typical",  "ugly",     "umbrella",
+		"unable",   "unaware",  "uncle",    "uncover",  "under",   
+		"undo",     "unfair",   "unfold",   "unhappy",  "uniform", 
+		"unique",   "unit",     "universe", "unknown",  "unlock",  
+		"until",    "unusual",  "unveil",   "update",   "upgrade", 
+		"uphold",   "upon",     "upper",    "upset",    "urban",   
+		"urge",     "usage",    "use",      "used",     "useful",  
+		"useless",  "usual",    "utility",  "vacant",   "vacuum",  
+		"vague",    "valid",    "valley",   "valve",    "van",     
+		"vanish",   "vapor",    "various",  "vast",     "vault",   
+		"vehicle",  "velvet",   "vendor",   "venture",  "venue",   
+		"verb",     "verify",   "version",  "very",     "vessel",  
+		"veteran",  "viable",   "vibrant",  "vicious",  "victory", 
+		"video",    "view",     "village",  "vintage",  "violin",  
+		"virtual",  "virus",    "visa",     "visit",    "visual",  
+		"vital",    "vivid",    "vocal",    "voice",    "void",    
+		"volcano",  "volume",   "vote",     "voyage",   "wage",    
+		"wagon",    "wait",     "walk",     "wall",     "walnut",  
+		"want",     "warfare",  "warm",     "warrior",  "wash",    
+		"wasp",     "waste",    "water",    "wave",     "way",     
+		"wealth",   "weapon",   "wear",     "weasel",   "weather", 
+		"web",      "wedding",  "weekend",  "weird",    "welcome", 
+		"west",     "wet",      "whale",    "what",     "wheat",   
+		"wheel",    "when",     "where",    "whip",     "whisper", 
+		"wide",     "width",    "wife",     "wild",     "will",    
+		"win",      "window",   "wine",     "wing",     "wink",    
+		"winner",   "winter",   "wire",     "wisdom",   "wise",    
+		"wish",     "witness",  "wolf",     "woman",    "wonder",  
+		"wood",     "wool",     "word",     "work",     "world",   
+		"worry",    "worth",    "wrap",     "wreck",    "wrestle", 
+		"wrist",    "write",    "wrong",    "yard",     "year",    
+		"yellow",   "you",      "young",    "youth",    "zebra",   
+		"zero",     "zone",     "zoo"
+	}};
 
 namespace Shamir {
+	namespace {
+		/// bytes of the seed the BIP39 checksum covers, the rest are checksum bits
+		size_t bip39_data_length(const std::vector<uint8_t> & it) {
+			return (it.size() * 8 / 33) * 4;
+		}
+
+		void append_hash(std::vector<uint8_t> & it, const uint8_t * hash) {
+			int seedchunks = it.size() / 4;
+			for (auto i=0; i < seedchunks/8; ++i) it.push_back(hash[i]);
+			if (seedchunks % 8 != 0) it.push_back(hash[seedchunks/8] & (0xff << (8 - seedchunks % 8)));
+		}
+
+		status check_hash(std::vector<uint8_t> & it, uint8_t * hash) {
+			auto databitlen = it.size() * 8;
+			databitlen -= databitlen % 33;
+			if (databitlen % 8 != 0) {  // zero-pad last block (byte) of the data
+				it.back() &= (0xff << (8 - (databitlen % 8)));
+			}
+			auto checksumsize = databitlen - (databitlen/33)*32;
+			if (checksumsize % 8 != 0) hash[checksumsize / 8] &= (0xff << (8 - (checksumsize % 8)));
+			for (auto i=0u; i < checksumsize/8 + (checksumsize % 8 ==0? 0 : 1); ++i) { // TODO: clean this thing
+				if (it[(databitlen/33)*4 + i] != hash[i]) return status::bip39_checksum;
+			}
+			it.resize((databitlen/33)*4);
+			return status::ok;
+		}
+
+		/// hashes 'lengths[i]' first bytes of every seed side by side
+		std::vector<uint8_t> hash_seeds(const std::vector<std::vector<uint8_t>> & seeds, const std::vector<size_t> & lengths) {
+			std::vector<const unsigned char *> data;
+			for (auto && s: seeds) data.push_back(s.data());
+			std::vector<uint8_t> hashes(32 * seeds.size());
+			SHA256Batch(data.data(), lengths.data(), seeds.size(), hashes.data());
+			return hashes;
+		}
+	}
+
 	std::vector<uint8_t> & append_bip39_checksum(std::vector<uint8_t> & it) {
 		CSHA256 h;
 		uint8_t hash[32];
 		h.Write(it.data(), it.size());
 		h.Finalize(hash);
-		int seedchunks = it.size() / 4;
-		for (auto i=0; i < seedchunks/8; ++i) it.push_back(hash[i]);
-		if (seedchunks % 8 != 0) it.push_back(hash[seedchunks/8] & (0xff << (8 - seedchunks % 8)));
+		append_hash(it, hash);
 		return it;
 	}
 
-	std::vector<uint8_t> & check_bip39_checksum(std::vector<uint8_t> & it) {
-		auto databitlen = it.size() * 8;
-		databitlen -= databitlen % 33;
-		if (databitlen % 8 != 0) {  // zero-pad last block (byte) of the data
-			it.back() &= (0xff << (8 - (databitlen % 8)));
-		}
-		auto checksumsize = databitlen - (databitlen/33)*32;
+	status try_check_bip39_checksum(std::vector<uint8_t> & it) {
 		CSHA256 h;
 		uint8_t hash[32];
-		h.Write(it.data(), (databitlen/33)*4);
+		h.Write(it.data(), bip39_data_length(it));
 		h.Finalize(hash);
-		if (checksumsize % 8 != 0) hash[checksumsize / 8] &= (0xff << (8 - (checksumsize % 8)));
-		for (auto i=0u; i < checksumsize/8 + (checksumsize % 8 ==0? 0 : 1); ++i) { // TODO: clean this thing
-			if (it[(databitlen/33)*4 + i] != hash[i]) throw "BIP39 checksum verification failed";
-		}
-		it.resize((databitlen/33)*4);
+		return check_hash(it, hash);
+	}
+
+	void append_bip39_checksums(std::vector<std::vector<uint8_t>> & seeds) {
+		std::vector<size_t> lengths;
+		for (auto && s: seeds) lengths.push_back(s.size());
+		const std::vector<uint8_t> hashes = hash_seeds(seeds, lengths);
+		for (size_t i = 0; i < seeds.size(); ++i) append_hash(seeds[i], hashes.data() + 32 * i);
+	}
+
+	void try_check_bip39_checksums(std::vector<std::vector<uint8_t>> & seeds, std::vector<status> & statuses) {
+		std::vector<size_t> lengths;
+		for (auto && s: seeds) lengths.push_back(bip39_data_length(s));
+		std::vector<uint8_t> hashes = hash_seeds(seeds, lengths);
+		statuses.resize(seeds.size());
+		for (size_t i = 0; i < seeds.size(); ++i) statuses[i] = check_hash(seeds[i], hashes.data() + 32 * i);
+	}
+
+	std::vector<uint8_t> & check_bip39_checksum(std::vector<uint8_t> & it) {
+		check(try_check_bip39_checksum(it));
 		return it;
 	}
 
+	namespace {
+		/// bit accumulator for any p, also finishes what the specialized converters left
+		void generic_to_bytes(const int * values, size_t count, int p, uint8_t * out) {
+			const uint64_t mask = (uint64_t(1) << p) - 1;
+			uint64_t bits(0);
+			int held(0);
+			for (size_t i = 0; i < count; ++i) {
+				bits = bits << p | (static_cast<uint64_t>(values[i]) & mask);
+				held += p;
+				while (held >= 8) {
+					held -= 8;
+					*out++ = static_cast<uint8_t>(bits >> held);
+				}
+			}
+			if (held > 0) *out = static_cast<uint8_t>(bits << (8 - held));
+		}
+
+		void generic_to_power2(const uint8_t * data, size_t length, int p, int * out) {
+			const uint64_t mask = (uint64_t(1) << p) - 1;
+			uint64_t bits(0);
+			int held(0);
+			for (size_t i = 0; i < length; ++i) {
+				bits = bits << 8 | data[i];
+				held += 8;
+				if (held >= p) {
+					held -= p;
+					*out++ = static_cast<int>((bits >> held) & mask);
+				}
+			}
+			if (held > 0) *out = static_cast<int>((bits << (p - held)) & mask);
+		}
+
+#if defined(__x86_64__)
+		/**
+		 * p = 10 and p = 11 move four words at a time between 16 bit lanes of a register and a 40 or 44 bit
+		 * big-endian field: pdep spreads the field into the lanes, pext gathers the lanes into the field.
+		 * They return how much input they converted, the rest is left to the generic loop.
+		 */
+		const bool have_bmi2 = cpu_features::have_bmi2();
+
+		inline uint64_t lanes_of(const int * values) {
+			return static_cast<uint64_t>(static_cast<uint16_t>(values[0])) << 48 | static_cast<uint64_t>(static_cast<uint16_t>(values[1])) << 32
+				| static_cast<uint64_t>(static_cast<uint16_t>(values[2])) << 16 | static_cast<uint16_t>(values[3]);
+		}
+
+		inline void store_lanes(uint64_t lanes, int * values) {
+			values[0] = static_cast<int>(lanes >> 48);
+			values[1] = static_cast<int>((lanes >> 32) & 0xffff);
+			values[2] = static_cast<int>((lanes >> 16) & 0xffff);
+			values[3] = static_cast<int>(lanes & 0xffff);
+		}
+
+		/// 4 words of 10 bits are 5 bytes, 8 words of 11 bits are 11 bytes
+		__attribute__((target("bmi2"))) size_t bmi2_to_bytes(const int * values, size_t count, int p, uint8_t * out) {
+			const uint64_t mask = p == 10 ? 0x03ff03ff03ff03ffull : 0x07ff07ff07ff07ffull;
+			const size_t words = p == 10 ? 4 : 8, bytes = p == 10 ? 5 : 11;
+			size_t i = 0;
+			uint8_t group[16];
+			for (; i + words <= count; i += words, out += bytes) {
+				uint64_t high = _pext_u64(lanes_of(values + i), mask) << (64 - 4 * p);
+				uint64_t low = 0;
+				if (p == 11) {
+					const uint64_t second = _pext_u64(lanes_of(values + i + 4), mask);
+					high |= second >> (4 * p - 20);
+					low = second << (64 - (4 * p - 20));
+				}
+				high = htobe64(high);
+				low = htobe64(low);
+				std::memcpy(group, &high, 8);
+				std::memcpy(group + 8, &low, 8);
+				std::memcpy(out, group, bytes);
+			}
+			return i;
+		}
+
+		__attribute__((target("bmi2"))) size_t bmi2_to_power2(const uint8_t * data, size_t length, int p, int * out) {
+			const uint64_t mask = p == 10 ? 0x03ff03ff03ff03ffull : 0x07ff07ff07ff07ffull;
+			const size_t words = p == 10 ? 4 : 8, bytes = p == 10 ? 5 : 11;
+			/// eight bytes are loaded at every 44 bit field, the second one of p = 11 starts at byte 5
+			const size_t reach = p == 10 ? 8 : 13;
+			size_t i = 0;
+			for (; i + reach <= length; i += bytes, out += words) {
+				store_lanes(_pdep_u64(load64be(data + i) >> (64 - 4 * p), mask), out);
+				if (p == 11) store_lanes(_pdep_u64((load64be(data + i + 5) << 4) >> 20, mask), out + 4);
+			}
+			return i;
+		}
+#endif
+	}
+
+	void power2_to_bytes(const int * values, size_t count, int p, uint8_t * out) {
+		if ( p < 9 || p > 24 ) throw "base 2-power must be between 9 and 24";
+		size_t done = 0;
+#if defined(__x86_64__)
+		if (have_bmi2 && (p == 10 || p == 11)) done = bmi2_to_bytes(values, count, p, out);
+#endif
+		generic_to_bytes(values + done, count - done, p, out + done * p / 8);
+	}
+
+	void bytes_to_power2(const uint8_t * data, size_t length, int p, int * out) {
+		if ( p < 9 || p > 24 ) throw "base 2-power must be between 9 and 24";
+		size_t done = 0;
+#if defined(__x86_64__)
+		if (have_bmi2 && (p == 10 || p == 11)) done = bmi2_to_power2(data, length, p, out);
+#endif
+		generic_to_power2(data + done, length - done, p, out + done * 8 / p);
+	}
+
 	/** Converts vector of integers representing number base 2^p to a byte-vector
 	  * with complexity O( vector.size() )
 	  * power of 2 in a base must be 9 to 24
 	  */
 	std::vector<uint8_t> power2ToHex(const std::vector<int> & it, int p) {
 		if ( p < 9 || p > 24 ) throw "base 2-power must be between 9 and 24";
-		std::vector<uint8_t> output;
-		size_t appended(0);
-		for (auto &x: it) {
-			int lastleft = (8 - appended % 8) % 8;
-			int toappend = p;
-			if (lastleft != 0) {
-				output.back() |= static_cast<uint8_t>(x >> (p - lastleft));
-				toappend -= lastleft;
-				appended += lastleft;
-			}
-			while (toappend >= 8) {
-				output.push_back(static_cast<uint8_t>(x >> (toappend - 8)));
-				toappend -= 8;
-				appended += 8;
-			}
-			if (toappend != 0) {
-				output.push_back(static_cast<uint8_t>(x << (8 - toappend)));
-				appended += toappend;
-			}
-		}
+		std::vector<uint8_t> output(power2_bytes(it.size(), p));
+		power2_to_bytes(it.data(), it.size(), p, output.data());
 		return output;
 	}
-	
+
 	/** Converts vector of bytes into array of integers representing number base 2^p
 	 * with complexity O( vector.size() )
 	 * power of 2 in a base must be 9 to 24
 	 */
 	std::vector<int> hexToPower2(const std::vector<uint8_t> & data, int p) {
 		if ( p < 9 || p > 24 ) throw "base 2-power must be between 9 and 24";
-		std::vector<int> output;
-		uint32_t bitholder(0);
-		int bitsread(0);
-		for (auto & x: data) {
-			int willread = (((p - bitsread) > 8) ? 8 : (p - bitsread));
-			bitholder <<= willread;
-			bitholder |= (x >> (8 - willread));
-			bitsread += willread;
-			if (bitsread == p) {
-				output.push_back(bitholder);
-				bitholder = x & (0xff >> (willread));
-				bitsread = 8 - willread;
+		std::vector<int> output(power2_words(data.size(), p));
+		bytes_to_power2(data.data(), data.size(), p, output.data());
+		return output;
+	}
+
+	namespace {
+		/// first four letters a-z as 1-26 in 5 bits each, shorter words padded with zeros; 0 for anything no dictionary word looks like
+		inline uint32_t prefix_key(const char * word, size_t length) {
+			uint32_t key(0);
+			for (size_t i = 0; i < 4; ++i) {
+				uint32_t letter(0);
+				if (i < length) {
+					letter = static_cast<uint32_t>(static_cast<unsigned char>(word[i])) - 'a' + 1;
+					if (letter < 1 || letter > 26) return 0;
+				}
+				key = key << 5 | letter;
 			}
+			return key;
 		}
-		int last = bitholder << (p - bitsread);
-		output.push_back(last);
-		return output;
+
+		/**
+		 * word to position by the first four letters, unique in both SLIP39 and BIP39 lists: open addressing table
+		 * of twice the dictionary size, an entry holds the 20 bit letters key above position + 1. Built on first use
+		 * with the multiplier that gives the shortest probe sequences, most words are found by one hash, one load
+		 * and one compare of the whole word.
+		 */
+		template <size_t N>
+		class prefix_index {
+			private:
+				static const size_t slots = 2 * N;
+				const std::array<word_view, N> & m_dictionary;
+				std::array<uint32_t, slots> m_slots;
+				uint32_t m_multiplier;
+				unsigned m_shift, m_longest;
+
+				size_t home(uint32_t key, uint32_t multiplier) const {
+					return (key * multiplier) >> m_shift;
+				}
+
+				/// longest distance of an entry from its home slot
+				unsigned place(uint32_t multiplier, std::array<uint32_t, slots> & table) const {
+					table.fill(0);
+					unsigned longest(0);
+					for (size_t i = 0; i < N; ++i) {
+						const uint32_t key = prefix_key(m_dictionary[i].data(), m_dictionary[i].size());
+						unsigned distance(0);
+						size_t slot = home(key, multiplier);
+						while (table[slot] != 0) {
+							if (table[slot] >> 12 == key) throw "word list prefixes are not unique";
+							slot = (slot + 1) % slots;
+							++distance;
+						}
+						table[slot] = key << 12 | static_cast<uint32_t>(i + 1);
+						longest = std::max(longest, distance);
+					}
+					return longest;
+				}
+			public:
+				explicit prefix_index(const std::array<word_view, N> & dictionary) : m_dictionary(dictionary), m_shift(32) {
+					for (size_t s = slots; s > 1; s >>= 1) --m_shift;
+					static const uint32_t multipliers[] = {0x9e3779b1, 0x85ebca6b, 0xc2b2ae35, 0x27d4eb2f, 0x165667b1, 0xcc9e2d51, 0x1b873593, 0xe6546b64};
+					std::array<uint32_t, slots> table;
+					m_longest = ~0u;
+					for (uint32_t multiplier: multipliers) {
+						const unsigned longest = place(multiplier, table);
+						if (longest >= m_longest) continue;
+						m_longest = longest;
+						m_multiplier = multiplier;
+						m_slots = table;
+					}
+				}
+
+				int find(const char * word, size_t length) const {
+					const uint32_t key = prefix_key(word, length);
+					if (key == 0) return -1;
+					size_t slot = home(key, m_multiplier);
+					for (unsigned distance = 0; distance <= m_longest; ++distance, slot = (slot + 1) % slots) {
+						const uint32_t entry = m_slots[slot];
+						if (entry == 0) return -1;
+						if (entry >> 12 != key) continue;
+						const int index = static_cast<int>(entry & 0xfff) - 1;
+						return m_dictionary[index].compare(word, length) == 0 ? index : -1;
+					}
+					return -1;
+				}
+		};
+
+		template <typename Index>
+		status words_to_num(Index index, const std::vector<std::string> & in, std::vector<int> & output, status unknown) {
+			output.clear();
+			output.reserve(in.size());
+			for (auto & ii: in) {
+				const int position = index(ii.data(), ii.size());
+				if (position < 0) return unknown;
+				output.push_back(position);
+			}
+			return status::ok;
+		}
+	}
+
+	int slip39_index(const char * word, size_t length) {
+		static const prefix_index<1024> index(slip_words);
+		return index.find(word, length);
+	}
+
+	int bip39_index(const char * word, size_t length) {
+		static const prefix_index<2048> index(bip_words);
+		return index.find(word, length);
+	}
+
+	namespace {
+		/**
+		 * trie over a sorted word list: words below a node are the range [first, last) of the list, children of a node
+		 * are stored side by side and found by popcount of its 26 bit letter mask, so a prefix is walked in O(length).
+		 * Branches holding a single word end there, the rest of the prefix is compared with that word.
+		 */
+		template <size_t N>
+		class word_trie {
+			private:
+				struct node {
+					uint32_t letters, children;
+					uint16_t first, last;
+				};
+				const std::array<word_view, N> & m_dictionary;
+				std::vector<node> m_nodes;
+
+				void build(size_t index, size_t first, size_t last, size_t depth) {
+					m_nodes[index].first = static_cast<uint16_t>(first);
+					m_nodes[index].last = static_cast<uint16_t>(last);
+					m_nodes[index].letters = 0;
+					m_nodes[index].children = 0;
+					if (last - first == 1) return;
+					size_t i = first;
+					while (i < last && m_dictionary[i].size() == depth) ++i; /// word equal to the prefix sorts first
+					std::vector<std::pair<size_t, size_t>> groups;
+					uint32_t letters(0);
+					while (i < last) {
+						const char letter = m_dictionary[i].data()[depth];
+						size_t j = i;
+						while (j < last && m_dictionary[j].data()[depth] == letter) ++j;
+						groups.push_back(std::make_pair(i, j));
+						letters |= 1u << (letter - 'a');
+						i = j;
+					}
+					const size_t children = m_nodes.size();
+					m_nodes.resize(children + groups.size());
+					m_nodes[index].letters = letters;
+					m_nodes[index].children = static_cast<uint32_t>(children);
+					for (size_t g = 0; g < groups.size(); ++g) build(children + g, groups[g].first, groups[g].second, depth + 1);
+				}
+			public:
+				explicit word_trie(const std::array<word_view, N> & dictionary) : m_dictionary(dictionary), m_nodes(1) {
+					build(0, 0, N, 0);
+				}
+
+				std::pair<int, int> range(const char * prefix, size_t length) const {
+					const node * n = &m_nodes[0];
+					for (size_t depth = 0; depth < length; ++depth) {
+						if (n->last - n->first == 1) {
+							const word_view & word = m_dictionary[n->first];
+							if (word.size() < length || std::memcmp(word.data() + depth, prefix + depth, length - depth) != 0) break;
+							return std::make_pair(static_cast<int>(n->first), static_cast<int>(n->last));
+						}
+						const unsigned letter = static_cast<unsigned>(static_cast<unsigned char>(prefix[depth])) - 'a';
+						if (letter >= 26 || !((n->letters >> letter) & 1)) break;
+						n = &m_nodes[n->children + __builtin_popcount(n->letters & ((1u << letter) - 1))];
+						if (depth + 1 == length) return std::make_pair(static_cast<int>(n->first), static_cast<int>(n->last));
+					}
+					if (length == 0) return std::make_pair(0, static_cast<int>(N));
+					return std::make_pair(0, 0);
+				}
+		};
+
+		const word_trie<1024> & slip_trie() {
+			static const word_trie<1024> trie(slip_words);
+			return trie;
+		}
+
+		const word_trie<2048> & bip_trie() {
+			static const word_trie<2048> trie(bip_words);
+			return trie;
+		}
+	}
+
+	std::pair<int, int> prefix_range(word_list list, const char * prefix, size_t length) {
+		return list == word_list::slip39 ? slip_trie().range(prefix, length) : bip_trie().range(prefix, length);
+	}
+
+	int resolve_word(word_list list, const std::string & abbreviation) {
+		const std::pair<int, int> range = prefix_range(list, abbreviation.data(), abbreviation.size());
+		if (range.first == range.second || abbreviation.empty()) return -1;
+		const word_view & first = list == word_list::slip39 ? slip_words[range.first] : bip_words[range.first];
+		if (first.size() == abbreviation.size() || range.second - range.first == 1) return range.first;
+		return -1;
+	}
+
+	std::vector<std::string> complete_word(word_list list, const std::string & prefix, size_t limit) {
+		const std::pair<int, int> range = prefix_range(list, prefix.data(), prefix.size());
+		std::vector<std::string> words;
+		for (int i = range.first; i < range.second && words.size() < limit; ++i) {
+			words.push_back((list == word_list::slip39 ? slip_words[i] : bip_words[i]).str());
+		}
+		return words;
+	}
+
+	namespace {
+		const size_t longest_word = 8; /// in both lists
+
+		/// Levenshtein distance, 'b' is at most 'longest_word' letters
+		unsigned edit_distance(const char * a, size_t a_length, const char * b, size_t b_length) {
+			unsigned row[longest_word + 1];
+			for (size_t j = 0; j <= b_length; ++j) row[j] = static_cast<unsigned>(j);
+			for (size_t i = 1; i <= a_length; ++i) {
+				unsigned diagonal = row[0];
+				row[0] = static_cast<unsigned>(i);
+				for (size_t j = 1; j <= b_length; ++j) {
+					const unsigned above = row[j];
+					row[j] = std::min(std::min(above, row[j - 1]) + 1, diagonal + (a[i - 1] != b[j - 1]));
+					diagonal = above;
+				}
+			}
+			return row[b_length];
+		}
+
+		/**
+		 * BK-tree: child k of a node holds the words at distance k from the word of the node. By the triangle
+		 * inequality words within 'distance' of a query at distance d from the node are only in children d - distance .. d + distance.
+		 * Words are inserted in a scattered order, sorted insertion would make the tree deep and narrow.
+		 */
+		template <size_t N>
+		class bk_tree {
+			private:
+				struct node {
+					uint16_t word;
+					uint16_t children[longest_word + 1]; /// 0 is no child, the root is nobody's child
+				};
+				const std::array<word_view, N> & m_dictionary;
+				std::vector<node> m_nodes;
+
+				unsigned distance(size_t node, const char * word, size_t length) const {
+					const word_view & w = m_dictionary[m_nodes[node].word];
+					return edit_distance(word, length, w.data(), w.size());
+				}
+			public:
+				explicit bk_tree(const std::array<word_view, N> & dictionary) : m_dictionary(dictionary) {
+					m_nodes.reserve(N);
+					for (size_t i = 0; i < N; ++i) {
+						node n = node();
+						n.word = static_cast<uint16_t>(i * 619 % N);
+						m_nodes.push_back(n);
+						if (i == 0) continue;
+						const word_view & w = m_dictionary[n.word];
+						size_t parent = 0;
+						for (;;) {
+							const unsigned d = distance(parent, w.data(), w.size());
+							if (m_nodes[parent].children[d] == 0) {
+								m_nodes[parent].children[d] = static_cast<uint16_t>(i);
+								break;
+							}
+							parent = m_nodes[parent].children[d];
+						}
+					}
+				}
+
+				std::vector<int> find(const std::string & word, unsigned limit) const {
+					std::vector<std::pair<unsigned, int>> found;
+					/// every word is further than that
+					if (word.size() > longest_word + limit) return std::vector<int>();
+					std::vector<size_t> pending(1, 0);
+					while (!pending.empty()) {
+						const size_t n = pending.back();
+						pending.pop_back();
+						const unsigned d = distance(n, word.data(), word.size());
+						if (d <= limit) found.push_back(std::make_pair(d, static_cast<int>(m_nodes[n].word)));
+						const unsigned low = d > limit ? d - limit : 0, high = std::min<unsigned>(d + limit, longest_word);
+						for (unsigned k = low; k <= high; ++k) {
+							if (m_nodes[n].children[k] != 0) pending.push_back(m_nodes[n].children[k]);
+						}
+					}
+					std::sort(found.begin(), found.end());
+					std::vector<int> words;
+					words.reserve(found.size());
+					for (auto && f: found) words.push_back(f.second);
+					return words;
+				}
+		};
+	}
+
+	std::vector<int> similar_words(word_list list, const std::string & word, unsigned distance) {
+		if (list == word_list::slip39) {
+			static const bk_tree<1024> tree(slip_words);
+			return tree.find(word, distance);
+		}
+		static const bk_tree<2048> tree(bip_words);
+		return tree.find(word, distance);
+	}
+
+	int slip39_index(const std::string & word) {
+		return slip39_index(word.data(), word.size());
+	}
+
+	int bip39_index(const std::string & word) {
+		return bip39_index(word.data(), word.size());
+	}
+
+	status try_slip39ToNum(const std::vector<std::string> & in, std::vector<int> & output) {
+		return words_to_num(static_cast<int (*)(const char *, size_t)>(slip39_index), in, output, status::unknown_slip39_word);
+	}
+
+	status try_bip39ToNum(const std::vector<std::string> & in, std::vector<int> & output) {
+		return words_to_num(static_cast<int (*)(const char *, size_t)>(bip39_index), in, output, status::unknown_bip39_word);
 	}
 
 	std::vector<int> slip39ToNum(const std::vector<std::string> & in) {
 		std::vector<int> output;
-		output.reserve(in.size());
-		for (auto & ii: in) {
-			auto element = std::lower_bound(slip_words.data(), slip_words.data() + slip_words.size(), ii);
-			if (*element != ii) throw "Given word not in SLIP39 dictionary\n";
-			output.push_back(static_cast<int>(element - slip_words.data()));
-		}
+		check(try_slip39ToNum(in, output));
 		return output;
 	}
 
 	std::vector<int> bip39ToNum(const std::vector<std::string> & in) {
 		std::vector<int> output;
-		output.reserve(in.size());
-		for (auto & ii: in) {
-			auto element = std::lower_bound(bip_words.data(), bip_words.data() + bip_words.size(), ii);
-			if (*element != ii) throw "Given word not in BIP39 dictionary\n";
-			output.push_back(static_cast<int>(element - bip_words.data()));
-		}
+		check(try_bip39ToNum(in, output));
 		return output;
 	}
 	
@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <cassert>
 #include <algorithm>
+#include <cstring>
 
 template <size_t SIZE1, size_t SIZE2>
 void test_mnemonic_creation(const std::array<uint8_t, SIZE1> & raw_enthropy, const std::array<const std::string, SIZE2> & mnemonic) {
@@ -189,8 +190,180 @@ void slip39_tests() {
 
 }
 
+/// lookups without exceptions, including words sorting after the last dictionary entry
+void lookup_tests() {
+	assert(Shamir::bip39_index("abandon") == 0);
+	assert(Shamir::bip39_index("zoo") == 2047);
+	assert(Shamir::bip39_index("zzz") == -1);
+	assert(Shamir::slip39_index("academic") == 0);
+	assert(Shamir::slip39_index("zebra") == 1023);
+	assert(Shamir::slip39_index("abandon") == -1);
+	std::vector<int> nums;
+	assert(Shamir::try_bip39ToNum({"legal", "winner", "zzz"}, nums) == Shamir::status::unknown_bip39_word);
+	assert(Shamir::try_slip39ToNum({"academic", "zebra"}, nums) == Shamir::status::ok && nums == std::vector<int>({0, 1023}));
+	std::vector<uint8_t> seed = Shamir::power2ToHex(Shamir::bip39ToNum({"legal", "winner", "thank", "year", "wave", "sausage", "worth", "useful", "legal", "winner", "thank", "winner"}), 11);
+	assert(Shamir::try_check_bip39_checksum(seed) == Shamir::status::bip39_checksum);
+	std::cout << "non-throwing word lookups: passed" << std::endl;
+}
+
+/// hashed lookup finds every word and rejects near misses sharing its first four letters
+template <size_t N>
+void hashed_lookup_tests(const std::array<word_view, N> & dictionary, int (*index)(const std::string &)) {
+	for (size_t i = 0; i < N; ++i) {
+		const std::string word = dictionary[i].str();
+		assert(index(word) == static_cast<int>(i));
+		assert(index(word + "s") == -1 || dictionary[index(word + "s")] == word + "s");
+		assert(index(word.substr(0, word.size() - 1)) == -1 || dictionary[index(word.substr(0, word.size() - 1))] == word.substr(0, word.size() - 1));
+		std::string upper(word);
+		upper[0] = static_cast<char>(upper[0] - 'a' + 'A');
+		assert(index(upper) == -1);
+	}
+	assert(index("") == -1 && index(" ") == -1 && index(std::string("ab\0c", 4)) == -1);
+}
+
+void hashed_lookups() {
+	hashed_lookup_tests(bip_words, Shamir::bip39_index);
+	hashed_lookup_tests(slip_words, Shamir::slip39_index);
+	std::cout << "hashed word lookups: passed" << std::endl;
+}
+
+/// trie ranges match a scan of the dictionary for every prefix of every word and for near misses
+template <size_t N>
+void prefix_tests(Shamir::word_list list, const std::array<word_view, N> & dictionary) {
+	for (size_t i = 0; i < N; ++i) {
+		const std::string word = dictionary[i].str();
+		for (size_t length = 1; length <= word.size() + 1; ++length) {
+			const std::string prefix = length <= word.size() ? word.substr(0, length) : word + "z";
+			int first(-1), last(-1);
+			for (size_t j = 0; j < N; ++j) {
+				if (dictionary[j].size() >= prefix.size() && std::memcmp(dictionary[j].data(), prefix.data(), prefix.size()) == 0) {
+					if (first < 0) first = static_cast<int>(j);
+					last = static_cast<int>(j) + 1;
+				}
+			}
+			const auto range = Shamir::prefix_range(list, prefix.data(), prefix.size());
+			if (first < 0) assert(range.first == range.second);
+			else assert(range.first == first && range.second == last);
+			const int resolved = Shamir::resolve_word(list, prefix);
+			if (prefix == word) assert(resolved == static_cast<int>(i));
+			else if (first >= 0 && last - first == 1) assert(resolved == first);
+			else if (first < 0 || dictionary[first] != prefix) assert(resolved == -1);
+		}
+		/// first four letters name exactly word i, unless they spell a dictionary word themselves
+		const std::string abbreviation = word.substr(0, 4);
+		int spelled(-1);
+		for (size_t j = 0; j < N; ++j) if (dictionary[j] == abbreviation) spelled = static_cast<int>(j);
+		assert(Shamir::resolve_word(list, abbreviation) == (spelled >= 0 ? spelled : static_cast<int>(i)));
+	}
+	assert(Shamir::prefix_range(list, "", 0) == std::make_pair(0, static_cast<int>(N)));
+	assert(Shamir::resolve_word(list, "") == -1 && Shamir::resolve_word(list, "A") == -1);
+}
+
+void prefix_lookups() {
+	prefix_tests(Shamir::word_list::bip39, bip_words);
+	prefix_tests(Shamir::word_list::slip39, slip_words);
+	assert(Shamir::resolve_word(Shamir::word_list::bip39, "aban") == 0);
+	assert(Shamir::resolve_word(Shamir::word_list::bip39, "act") == Shamir::bip39_index("act"));
+	assert(Shamir::resolve_word(Shamir::word_list::bip39, "ac") == -1);
+	assert(Shamir::complete_word(Shamir::word_list::bip39, "zo") == std::vector<std::string>({"zone", "zoo"}));
+	assert(Shamir::complete_word(Shamir::word_list::bip39, "a", 3) == std::vector<std::string>({"abandon", "ability", "able"}));
+	assert(Shamir::complete_word(Shamir::word_list::slip39, "qx").empty());
+	std::cout << "abbreviated words and completions: passed" << std::endl;
+}
+
+size_t levenshtein(const std::string & a, const std::string & b) {
+	std::vector<std::vector<size_t>> d(a.size() + 1, std::vector<size_t>(b.size() + 1));
+	for (size_t i = 0; i <= a.size(); ++i) d[i][0] = i;
+	for (size_t j = 0; j <= b.size(); ++j) d[0][j] = j;
+	for (size_t i = 1; i <= a.size(); ++i) {
+		for (size_t j = 1; j <= b.size(); ++j) d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+	}
+	return d[a.size()][b.size()];
+}
+
+/// BK-tree finds exactly the words a scan of the dictionary finds, nearest first
+template <size_t N>
+void similar_tests(Shamir::word_list list, const std::array<word_view, N> & dictionary) {
+	const std::vector<std::string> queries = {dictionary[0].str(), dictionary[N / 3].str() + "x", "xyzzy", "", "mnemonicword",
+		dictionary[N - 1].str().substr(1), dictionary[N / 2].str().substr(0, 2) + dictionary[N / 2].str().substr(3)};
+	for (auto && query: queries) {
+		for (unsigned distance = 0; distance <= 3; ++distance) {
+			std::vector<std::pair<size_t, int>> expected;
+			for (size_t i = 0; i < N; ++i) {
+				const size_t d = levenshtein(query, dictionary[i].str());
+				if (d <= distance) expected.push_back(std::make_pair(d, static_cast<int>(i)));
+			}
+			std::sort(expected.begin(), expected.end());
+			std::vector<int> indices;
+			for (auto && e: expected) indices.push_back(e.second);
+			assert(Shamir::similar_words(list, query, distance) == indices);
+		}
+	}
+}
+
+void similar_lookups() {
+	similar_tests(Shamir::word_list::bip39, bip_words);
+	similar_tests(Shamir::word_list::slip39, slip_words);
+	assert(Shamir::similar_words(Shamir::word_list::slip39, "acadmic", 1) == std::vector<int>({Shamir::slip39_index("academic")}));
+	std::cout << "words within edit distance: passed" << std::endl;
+}
+
+/// converters agree bit by bit with reading the bit string directly, for every base and lengths around the 5 and 11 byte groups
+void conversion_tests() {
+	std::vector<uint8_t> bytes(40);
+	for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<uint8_t>(i * 151 + 7);
+	for (int p = 9; p <= 24; ++p) {
+		for (size_t length = 0; length <= bytes.size(); ++length) {
+			const std::vector<uint8_t> data(bytes.begin(), bytes.begin() + length);
+			const auto words = Shamir::hexToPower2(data, p);
+			assert(words.size() == (length * 8 + p - 1) / p);
+			for (size_t bit = 0; bit < words.size() * p; ++bit) {
+				const int expected = bit < length * 8 ? (data[bit / 8] >> (7 - bit % 8)) & 1 : 0;
+				assert(((words[bit / p] >> (p - 1 - bit % p)) & 1) == expected);
+			}
+			const auto restored = Shamir::power2ToHex(words, p);
+			assert(restored.size() >= length && std::equal(data.begin(), data.end(), restored.begin()));
+			for (size_t i = length; i < restored.size(); ++i) assert(restored[i] == 0);
+		}
+	}
+	std::cout << "base 2^p conversions: passed" << std::endl;
+}
+
+/// checksums hashed side by side agree with the ones hashed one seed at a time, for every seed length
+void batch_checksum_tests() {
+	std::vector<std::vector<uint8_t>> seeds;
+	for (size_t length = 16; length <= 32; length += 4) {
+		for (int k = 0; k < 3; ++k) {
+			std::vector<uint8_t> seed(length);
+			for (size_t i = 0; i < length; ++i) seed[i] = static_cast<uint8_t>(i * 31 + length * 7 + k);
+			seeds.push_back(seed);
+		}
+	}
+	auto batch = seeds;
+	Shamir::append_bip39_checksums(batch);
+	for (size_t i = 0; i < seeds.size(); ++i) {
+		auto single = seeds[i];
+		assert(batch[i] == Shamir::append_bip39_checksum(single));
+	}
+	batch[4].back() ^= 0x80;
+	std::vector<Shamir::status> statuses;
+	Shamir::try_check_bip39_checksums(batch, statuses);
+	assert(statuses.size() == seeds.size());
+	for (size_t i = 0; i < seeds.size(); ++i) {
+		if (i == 4) assert(statuses[i] == Shamir::status::bip39_checksum);
+		else assert(statuses[i] == Shamir::status::ok && batch[i] == seeds[i]);
+	}
+	std::cout << "batched BIP39 checksums: passed" << std::endl;
+}
+
 int main() {
 	bip39_tests();
 	slip39_tests();
+	lookup_tests();
+	hashed_lookups();
+	prefix_lookups();
+	similar_lookups();
+	conversion_tests();
+	batch_checksum_tests();
 	return 0;
 }